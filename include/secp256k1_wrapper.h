@@ -14,6 +14,7 @@
 #define SECP256K1_WRAPPER_H
 
 #include <stdlib.h>
+#include <stdint.h>
 
 #define SECP256K1_WRAPPER_VERSION_MAJOR 1
 #define SECP256K1_WRAPPER_VERSION_MINOR 3
@@ -110,6 +111,1272 @@ int secp256k1_wrapper_generate_keys(unsigned char* privkey_out, unsigned char* p
  */
 int secp256k1_wrapper_derive_pubkey(const unsigned char* privkey, unsigned char* pubkey_out,int compressed);
 
+/* ---- Batch API ---- */
+
+/** Any failure fails the whole batch and wipes every private key. */
+#define SECP256K1_WRAPPER_BATCH_ALL_OR_NOTHING 0
+/** Failures are reported per item in `results`; other items still succeed. */
+#define SECP256K1_WRAPPER_BATCH_PER_ITEM       1
+
+/**
+ * @brief Generates `n` key pairs into contiguous arrays.
+ *
+ * Equivalent to calling secp256k1_wrapper_generate_keys() `n` times, but the
+ * whole batch borrows one context and the entropy for all private keys is
+ * drawn with a single secp256k1_wrapper_fill_random() call of n * 32 bytes.
+ * Out-of-range keys (probability about 2^-128 each) are redrawn.
+ *
+ * @param[out] privkeys_out n * 32 bytes; key i is at offset i * 32.
+ * @param[out] pubkeys_out  n * 33 bytes (compressed) or n * 65 bytes
+ *                          (uncompressed); key i is at offset i * 33 or i * 65.
+ * @param[in]  n            Number of key pairs. 0 is a no-op.
+ * @param[in]  compressed   1 for compressed, 0 for uncompressed public keys.
+ * @param[in]  flags        SECP256K1_WRAPPER_BATCH_ALL_OR_NOTHING or
+ *                          SECP256K1_WRAPPER_BATCH_PER_ITEM.
+ * @param[out] results      Per-item mode: n ints receiving each item's code,
+ *                          as returned by secp256k1_wrapper_generate_keys().
+ *                          Ignored, and may be NULL, in all-or-nothing mode.
+ *
+ * @return int Returns 0 if every pair was generated, or a negative value:
+ *             - -1: Invalid input (null buffers, invalid compressed value or
+ *                   flags, null results in per-item mode, n too large).
+ *             - -2: Context creation or randomization failed.
+ *             - -3: Random number generation failed.
+ *             - -5: Public key creation or serialization failed.
+ *             In per-item mode the first failing item's code is returned.
+ *
+ * @note In all-or-nothing mode all private keys are wiped on failure. In
+ *       per-item mode the private key of each failed item is wiped.
+ */
+int secp256k1_wrapper_generate_keys_batch(unsigned char* privkeys_out, unsigned char* pubkeys_out, size_t n,
+                                          int compressed, int flags, int* results);
+
+/**
+ * @brief Derives the public keys of `n` private keys into a contiguous array.
+ *
+ * Equivalent to calling secp256k1_wrapper_derive_pubkey() for each key with
+ * one borrowed context for the whole batch. An invalid private key does not
+ * stop the batch: its slot is zeroed, its code recorded, and the remaining
+ * keys are still derived.
+ *
+ * @param[in]  privkeys    n * 32 bytes; key i is at offset i * 32.
+ * @param[out] pubkeys_out n * 33 bytes (compressed) or n * 65 bytes
+ *                         (uncompressed); key i is at offset i * 33 or i * 65.
+ * @param[in]  n           Number of keys. 0 is a no-op.
+ * @param[in]  compressed  1 for compressed, 0 for uncompressed public keys.
+ * @param[out] results     n ints receiving each key's code: 0 on success,
+ *                         -5 for an invalid private key or a failed
+ *                         serialization, -2 if context re-randomization failed.
+ *
+ * @return int Returns 0 if every key was derived, or a negative value:
+ *             - -1: Invalid input (null buffers, invalid compressed value,
+ *                   n too large). `results` is not written.
+ *             - -2: Context creation or randomization failed.
+ *             - -5: At least one key failed; see `results`.
+ */
+int secp256k1_wrapper_derive_pubkey_batch(const unsigned char* privkeys, unsigned char* pubkeys_out, size_t n,
+                                          int compressed, int* results);
+
+/* ---- Strided and scatter-gather batches ---- */
+
+/**
+ * @brief secp256k1_wrapper_generate_keys_batch() writing into records.
+ *
+ * Key i is written to privkeys_out + i * privkey_stride and
+ * pubkeys_out + i * pubkey_stride, so a batch can fill an array of the
+ * caller's own structures in place. A stride of 0 means packed (32 bytes for
+ * private keys, the public key size for public keys). The private keys' entropy
+ * is drawn in 2 KiB pieces and copied into place; nothing else is buffered.
+ *
+ * @param[out] privkeys_out   First private key.
+ * @param[in]  privkey_stride Bytes between private keys: 0 or at least 32.
+ * @param[out] pubkeys_out    First public key.
+ * @param[in]  pubkey_stride  Bytes between public keys: 0 or at least 33
+ *                            (compressed) or 65 (uncompressed).
+ *
+ * Other parameters, the return value and the wiping rules are those of
+ * secp256k1_wrapper_generate_keys_batch(); a stride shorter than its key or
+ * one that overflows the address range over `n` items is -1. `results` is a
+ * plain array of n ints. Private and public key slots must not overlap.
+ */
+int secp256k1_wrapper_generate_keys_strided(unsigned char* privkeys_out, size_t privkey_stride,
+                                            unsigned char* pubkeys_out, size_t pubkey_stride, size_t n,
+                                            int compressed, int flags, int* results);
+
+/**
+ * @brief secp256k1_wrapper_generate_keys_batch() writing through pointers.
+ *
+ * Key pair i is written to privkeys_out[i] (32 bytes) and pubkeys_out[i]
+ * (33 or 65 bytes). A null array or a null entry is -1. Otherwise as
+ * secp256k1_wrapper_generate_keys_strided().
+ */
+int secp256k1_wrapper_generate_keys_scatter(unsigned char* const* privkeys_out, unsigned char* const* pubkeys_out,
+                                            size_t n, int compressed, int flags, int* results);
+
+/**
+ * @brief secp256k1_wrapper_derive_pubkey_batch() over records.
+ *
+ * Key i is read from privkeys + i * privkey_stride and its public key written
+ * to pubkeys_out + i * pubkey_stride. Strides follow the rules of
+ * secp256k1_wrapper_generate_keys_strided(); everything else is as
+ * secp256k1_wrapper_derive_pubkey_batch().
+ */
+int secp256k1_wrapper_derive_pubkey_strided(const unsigned char* privkeys, size_t privkey_stride,
+                                            unsigned char* pubkeys_out, size_t pubkey_stride, size_t n,
+                                            int compressed, int* results);
+
+/**
+ * @brief secp256k1_wrapper_derive_pubkey_batch() through pointers.
+ *
+ * Reads privkeys[i] and writes pubkeys_out[i]. A null array or a null entry
+ * is -1; everything else is as secp256k1_wrapper_derive_pubkey_batch().
+ */
+int secp256k1_wrapper_derive_pubkey_scatter(const unsigned char* const* privkeys, unsigned char* const* pubkeys_out,
+                                            size_t n, int compressed, int* results);
+
+/* ---- Sequential key ranges ---- */
+
+/**
+ * @brief Derives the public keys of `n` consecutive private keys.
+ *
+ * Writes the public keys of privkey, privkey + 1, ..., privkey + n - 1
+ * (256-bit big-endian scalars) to a contiguous array. Only the first key
+ * costs a scalar multiplication; each following key is one point addition
+ * of the generator in Jacobian coordinates, and each block of points is
+ * converted to affine form with a single shared field inversion. In
+ * parallel mode each chunk starts with its own multiplication.
+ *
+ * Meant for public or deterministic key sets (test fixtures, sub-key
+ * ranges, searches); consecutive private keys are trivially related.
+ *
+ * @param[in]  privkey     32-byte first private key.
+ * @param[in]  n           Number of keys. 0 is a no-op.
+ * @param[out] pubkeys_out n * 33 bytes (compressed) or n * 65 bytes
+ *                         (uncompressed); key i is at offset i * 33 or i * 65.
+ * @param[in]  compressed  1 for compressed, 0 for uncompressed public keys.
+ *
+ * @return int Returns 0 on success, or a negative value on error:
+ *             - -1: Invalid input (null buffers, invalid compressed value,
+ *                   n too large, or privkey + n - 1 reaches the group order).
+ *             - -2: Context creation or randomization failed.
+ *             - -5: Invalid first private key, or a public key operation
+ *                   failed. pubkeys_out is zeroed.
+ */
+int secp256k1_wrapper_derive_pubkey_range(const unsigned char* privkey, size_t n, unsigned char* pubkeys_out,
+                                          int compressed);
+
+/* ---- ECDSA signing ---- */
+
+/** 64-byte compact signature, r || s. */
+#define SECP256K1_WRAPPER_SIG_COMPACT 0
+/** DER-encoded signature, at most 72 bytes. */
+#define SECP256K1_WRAPPER_SIG_DER     1
+
+#define SECP256K1_WRAPPER_SIG_COMPACT_SIZE 64
+#define SECP256K1_WRAPPER_SIG_DER_MAX_SIZE 72
+
+/**
+ * @brief Signs a 32-byte message hash with ECDSA.
+ *
+ * The nonce is derived per RFC 6979 with 32 bytes of extra entropy drawn
+ * from secp256k1_wrapper_fill_random() (and so from the selected random
+ * source), on a randomized context. Signatures are lower-S normalized.
+ *
+ * @param[in]     privkey 32-byte private key.
+ * @param[in]     hash32  32-byte message hash.
+ * @param[out]    sig_out Signature buffer.
+ * @param[in,out] sig_len In: size of sig_out, at least
+ *                        SECP256K1_WRAPPER_SIG_COMPACT_SIZE or
+ *                        SECP256K1_WRAPPER_SIG_DER_MAX_SIZE for `format`.
+ *                        Out: length of the signature written.
+ * @param[in]     format  SECP256K1_WRAPPER_SIG_COMPACT or
+ *                        SECP256K1_WRAPPER_SIG_DER.
+ *
+ * @return int Returns 0 on success, or a negative value on error:
+ *             - -1: Invalid input (null buffers, invalid format, sig_out
+ *                   too small).
+ *             - -2: Context creation or randomization failed.
+ *             - -3: Random number generation failed.
+ *             - -4: Signing or signature serialization failed.
+ *             - -5: Invalid private key.
+ *
+ * @note On failure, the contents of sig_out and *sig_len are undefined.
+ */
+int secp256k1_wrapper_sign(const unsigned char* privkey, const unsigned char* hash32, unsigned char* sig_out,
+                           size_t* sig_len, int format);
+
+/**
+ * @brief Signs `n` (private key, hash) pairs.
+ *
+ * Equivalent to calling secp256k1_wrapper_sign() for each pair, with one
+ * borrowed context for the whole batch and the nonce entropy of up to 64
+ * signatures drawn per RNG request. A failing item does not stop the batch.
+ *
+ * @param[in]  privkeys n * 32 bytes; key i is at offset i * 32.
+ * @param[in]  hashes   n * 32 bytes; hash i is at offset i * 32.
+ * @param[in]  n        Number of signatures. 0 is a no-op.
+ * @param[out] sigs_out n * 64 bytes (compact) or n * 72 bytes (DER);
+ *                      signature i is at offset i * 64 or i * 72.
+ * @param[out] sig_lens n lengths of the signatures written, 0 for failed
+ *                      items. Required for DER; may be NULL for compact.
+ * @param[in]  format   SECP256K1_WRAPPER_SIG_COMPACT or
+ *                      SECP256K1_WRAPPER_SIG_DER.
+ * @param[out] results  n ints receiving each item's code, as returned by
+ *                      secp256k1_wrapper_sign(). Failed slots are zeroed.
+ *
+ * @return int Returns 0 if every item was signed, or the first failing
+ *             item's code; -1 for invalid input (null buffers, invalid
+ *             format, null sig_lens with DER, n too large), in which case
+ *             nothing is written.
+ */
+int secp256k1_wrapper_sign_batch(const unsigned char* privkeys, const unsigned char* hashes, size_t n,
+                                 unsigned char* sigs_out, size_t* sig_lens, int format, int* results);
+
+/* ---- ECDSA verification ---- */
+
+/** One signature to check in secp256k1_wrapper_verify_batch(). */
+typedef struct secp256k1_wrapper_verify_item {
+    const unsigned char* pubkey;   /**< Serialized public key, 33 or 65 bytes. */
+    size_t pubkey_len;
+    const unsigned char* hash32;   /**< 32-byte message hash. */
+    const unsigned char* sig;      /**< Signature in the batch's format. */
+    size_t sig_len;                /**< 64 for compact, the DER length otherwise. */
+} secp256k1_wrapper_verify_item;
+
+/** Check every item and report each in the bitmap. */
+#define SECP256K1_WRAPPER_VERIFY_ALL        0
+/** Answer "all valid?": stop at the first invalid item. */
+#define SECP256K1_WRAPPER_VERIFY_EARLY_EXIT 1
+
+/**
+ * @brief Verifies an ECDSA signature over a 32-byte message hash.
+ *
+ * Runs on libsecp256k1's static context; verification touches no secrets,
+ * so no context is created or randomized. Only lower-S signatures are
+ * accepted, as libsecp256k1 produces them.
+ *
+ * @param[in] pubkey     Serialized public key (33 or 65 bytes).
+ * @param[in] pubkey_len Length of pubkey.
+ * @param[in] hash32     32-byte message hash.
+ * @param[in] sig        Signature, compact (64 bytes) or DER.
+ * @param[in] sig_len    Length of sig.
+ * @param[in] format     SECP256K1_WRAPPER_SIG_COMPACT or
+ *                       SECP256K1_WRAPPER_SIG_DER.
+ *
+ * @return int Returns 0 if the signature is valid, or a negative value:
+ *             - -1: Invalid input (null buffers or invalid format).
+ *             - -4: Invalid or unparsable signature.
+ *             - -5: Unparsable public key.
+ */
+int secp256k1_wrapper_verify(const unsigned char* pubkey, size_t pubkey_len, const unsigned char* hash32,
+                             const unsigned char* sig, size_t sig_len, int format);
+
+/**
+ * @brief Verifies `n` signatures, on the worker pool in parallel mode.
+ *
+ * Each item is checked as by secp256k1_wrapper_verify(). Bit i of the bitmap
+ * (byte i / 8, bit i % 8, least significant first) is set if item i is
+ * valid. In early-exit mode workers stop at the first invalid item they see
+ * or hear of; items not checked keep a clear bit, so the bitmap then only
+ * lists confirmed-valid items.
+ *
+ * @param[in]  items        n items. Items with null buffers are invalid.
+ * @param[in]  n            Number of items. 0 is a no-op.
+ * @param[in]  format       Signature format of every item.
+ * @param[in]  mode         SECP256K1_WRAPPER_VERIFY_ALL or
+ *                          SECP256K1_WRAPPER_VERIFY_EARLY_EXIT.
+ * @param[out] valid_bitmap (n + 7) / 8 bytes. Required in
+ *                          SECP256K1_WRAPPER_VERIFY_ALL mode; may be NULL
+ *                          in early-exit mode.
+ *
+ * @return int Returns 0 if every item is valid, or a negative value:
+ *             - -1: Invalid input (null items, invalid format or mode,
+ *                   null bitmap in SECP256K1_WRAPPER_VERIFY_ALL mode).
+ *             - -4: At least one item is invalid.
+ */
+int secp256k1_wrapper_verify_batch(const secp256k1_wrapper_verify_item* items, size_t n, int format, int mode,
+                                   unsigned char* valid_bitmap);
+
+/* ---- BIP340 Schnorr signatures ---- */
+
+#define SECP256K1_WRAPPER_XONLY_PUBKEY_SIZE 32
+#define SECP256K1_WRAPPER_SCHNORR_SIG_SIZE  64
+
+/**
+ * @brief Opaque handle to a key pair for Schnorr signing.
+ *
+ * Holds the private key with its precomputed public key, so signing with
+ * a handle skips the point multiplication that derives the public key.
+ * Handles are immutable; one handle may be used from any number of threads
+ * at once.
+ */
+typedef struct secp256k1_wrapper_keypair secp256k1_wrapper_keypair;
+
+/** One signature to check in secp256k1_wrapper_schnorr_verify_batch(). */
+typedef struct secp256k1_wrapper_schnorr_item {
+    const unsigned char* xonly_pubkey;  /**< 32-byte x-only public key. */
+    const unsigned char* msg32;         /**< 32-byte message. */
+    const unsigned char* sig64;         /**< 64-byte signature. */
+} secp256k1_wrapper_schnorr_item;
+
+/**
+ * @brief Creates a key pair handle from a private key.
+ *
+ * @param[in]  privkey     32-byte private key.
+ * @param[out] keypair_out Receives the handle, or NULL on error. Free it
+ *                         with secp256k1_wrapper_keypair_destroy().
+ *
+ * @return int Returns 0 on success, or a negative value on error:
+ *             - -1: Invalid input (null buffers).
+ *             - -2: Allocation or context creation failed.
+ *             - -3: Random number generation failed.
+ *             - -5: Invalid private key.
+ */
+int secp256k1_wrapper_keypair_create(const unsigned char* privkey, secp256k1_wrapper_keypair** keypair_out);
+
+/**
+ * @brief Exports the x-only public key of a key pair.
+ *
+ * @param[in]  keypair   Key pair handle.
+ * @param[out] xonly_out 32-byte x-only public key, as used by BIP340.
+ * @param[out] parity    Receives 1 if the full public key has an odd y
+ *                       coordinate, 0 otherwise. May be NULL.
+ *
+ * @return int Returns 0 on success, or a negative value on error:
+ *             - -1: Invalid input (null buffers).
+ *             - -5: Public key serialization failed.
+ */
+int secp256k1_wrapper_keypair_xonly_pubkey(const secp256k1_wrapper_keypair* keypair, unsigned char* xonly_out,
+                                           int* parity);
+
+/**
+ * @brief Wipes and frees a key pair handle. Accepts NULL.
+ */
+void secp256k1_wrapper_keypair_destroy(secp256k1_wrapper_keypair* keypair);
+
+/**
+ * @brief Signs a 32-byte message with BIP340 Schnorr.
+ *
+ * Each signature uses 32 bytes of auxiliary randomness from the selected
+ * random source, and signing runs on a reused randomized context.
+ *
+ * @param[in]  keypair   Key pair handle.
+ * @param[in]  msg32     32-byte message, normally a tagged hash.
+ * @param[out] sig64_out 64-byte signature.
+ *
+ * @return int Returns 0 on success, or a negative value on error:
+ *             - -1: Invalid input (null buffers).
+ *             - -2: Context creation or randomization failed.
+ *             - -3: Random number generation failed.
+ *             - -4: Signing failed.
+ */
+int secp256k1_wrapper_schnorr_sign(const secp256k1_wrapper_keypair* keypair, const unsigned char* msg32,
+                                   unsigned char* sig64_out);
+
+/**
+ * @brief Signs `n` messages, on the worker pool in parallel mode.
+ *
+ * Item i signs message i with key pair i; the same handle may appear any
+ * number of times. Failed items get a zeroed signature.
+ *
+ * @param[in]  keypairs n key pair handles. A null handle fails its item
+ *                      with -1.
+ * @param[in]  msgs     n consecutive 32-byte messages.
+ * @param[in]  n        Number of messages. 0 is a no-op.
+ * @param[out] sigs_out n consecutive 64-byte signatures.
+ * @param[out] results  n per-item codes, as for
+ *                      secp256k1_wrapper_schnorr_sign().
+ *
+ * @return int Returns 0 if every item was signed, -1 for invalid
+ *             arguments, or the code of the lowest-indexed failed item.
+ */
+int secp256k1_wrapper_schnorr_sign_batch(const secp256k1_wrapper_keypair* const* keypairs,
+                                         const unsigned char* msgs, size_t n, unsigned char* sigs_out,
+                                         int* results);
+
+/**
+ * @brief Verifies a BIP340 Schnorr signature over a 32-byte message.
+ *
+ * Runs on libsecp256k1's static context.
+ *
+ * @param[in] xonly_pubkey 32-byte x-only public key.
+ * @param[in] msg32        32-byte message.
+ * @param[in] sig64        64-byte signature.
+ *
+ * @return int Returns 0 if the signature is valid, or a negative value:
+ *             - -1: Invalid input (null buffers).
+ *             - -4: Invalid signature.
+ *             - -5: Unparsable public key.
+ */
+int secp256k1_wrapper_schnorr_verify(const unsigned char* xonly_pubkey, const unsigned char* msg32,
+                                     const unsigned char* sig64);
+
+/**
+ * @brief Verifies `n` Schnorr signatures, on the worker pool in parallel
+ * mode.
+ *
+ * Behaves as secp256k1_wrapper_verify_batch(): bit i of the bitmap is set
+ * if item i is valid, and early-exit mode stops at the first invalid item.
+ *
+ * @param[in]  items        n items. Items with null buffers are invalid.
+ * @param[in]  n            Number of items. 0 is a no-op.
+ * @param[in]  mode         SECP256K1_WRAPPER_VERIFY_ALL or
+ *                          SECP256K1_WRAPPER_VERIFY_EARLY_EXIT.
+ * @param[out] valid_bitmap (n + 7) / 8 bytes. Required in
+ *                          SECP256K1_WRAPPER_VERIFY_ALL mode; may be NULL
+ *                          in early-exit mode.
+ *
+ * @return int Returns 0 if every item is valid, or a negative value:
+ *             - -1: Invalid input (null items, invalid mode, null bitmap
+ *                   in SECP256K1_WRAPPER_VERIFY_ALL mode).
+ *             - -4: At least one item is invalid.
+ */
+int secp256k1_wrapper_schnorr_verify_batch(const secp256k1_wrapper_schnorr_item* items, size_t n, int mode,
+                                           unsigned char* valid_bitmap);
+
+/* ---- Parallel batches ---- */
+
+/** Items per chunk when secp256k1_wrapper_set_parallel() is given 0. */
+#define SECP256K1_WRAPPER_PARALLEL_CHUNK_DEFAULT 256u
+
+/**
+ * @brief Runs the batch functions on a pool of worker threads.
+ *
+ * With `threads` greater than 1, batches larger than one chunk passed to the
+ * batch key generation, derivation, range, signing and verification
+ * functions (ECDSA and Schnorr) run on a work-stealing pool. The
+ * batch is split in halves down to `chunk_size` items; each worker keeps the
+ * halves it splits off on its own deque, and idle workers steal the largest
+ * pending ones, so a stalled worker holds up at most one chunk. The call
+ * returns once every item is done. Each worker owns a randomized context
+ * for its whole lifetime. Every item is written to its own slot, so output
+ * order is the same as in a serial run, and the returned code is that of
+ * the lowest-indexed failing item.
+ *
+ * Calling it again replaces the pool; `threads` of 0 or 1 stops the workers
+ * and returns to serial mode. Batches submitted from several threads share
+ * the workers and run concurrently.
+ *
+ * @param[in] threads    Number of worker threads, at most 1024. 0 or 1
+ *                       selects serial mode.
+ * @param[in] chunk_size Items per chunk. 0 selects
+ *                       SECP256K1_WRAPPER_PARALLEL_CHUNK_DEFAULT.
+ *
+ * @return int Returns 0 on success, or a negative value on error:
+ *             - -1: Invalid thread count.
+ *             - -2: Allocation, thread start, context creation or
+ *                   randomization failed. Serial mode is left in place.
+ *             - -3: Random number generation failed.
+ *
+ * @note Not thread-safe with respect to batch calls in flight. Worker
+ *       threads do not survive fork(): a child runs batches serially until
+ *       it calls this function again.
+ */
+int secp256k1_wrapper_set_parallel(size_t threads, size_t chunk_size);
+
+/**
+ * @brief Per-worker counters reported by secp256k1_wrapper_get_parallel_stats().
+ */
+typedef struct secp256k1_wrapper_worker_stats {
+    uint64_t tasks;   /**< Chunks this worker ran. */
+    uint64_t items;   /**< Items in those chunks. */
+    uint64_t steals;  /**< Ranges it stole from other workers. */
+} secp256k1_wrapper_worker_stats;
+
+/**
+ * @brief Pool-wide counters reported by secp256k1_wrapper_get_parallel_stats().
+ */
+typedef struct secp256k1_wrapper_parallel_stats {
+    size_t   threads;       /**< Number of workers (0 in serial mode). */
+    uint64_t jobs;          /**< Batches run on the pool. */
+    uint64_t tasks;         /**< Chunks run, summed over all workers. */
+    uint64_t items;         /**< Items processed, summed over all workers. */
+    uint64_t steals;        /**< Successful steals, summed over all workers. */
+    uint64_t steal_aborts;  /**< Steals that lost a race and were retried. */
+} secp256k1_wrapper_parallel_stats;
+
+/**
+ * @brief Reads the work-stealing pool's counters.
+ *
+ * Counters accumulate from the moment secp256k1_wrapper_set_parallel()
+ * created the pool. Uneven `items` across workers, or a high steal count,
+ * shows how much rebalancing the batches needed.
+ *
+ * @param[out] stats       Pool-wide totals; zeroed in serial mode. May be NULL.
+ * @param[out] workers     Per-worker counters, indexed by worker. May be NULL.
+ * @param[in]  max_workers Capacity of `workers`.
+ *
+ * @return size_t Number of `workers` entries written.
+ *
+ * @note The counters are read one by one while batches may be running, so
+ *       the totals are only approximately consistent with each other.
+ */
+size_t secp256k1_wrapper_get_parallel_stats(secp256k1_wrapper_parallel_stats* stats,
+                                            secp256k1_wrapper_worker_stats* workers, size_t max_workers);
+
+
+/* ---- Streaming key generation ---- */
+
+/**
+ * @brief Opaque generator yielding key pairs in caller-sized pieces.
+ *
+ * For very large or unbounded runs that should not allocate the whole batch
+ * up front. A generator keeps one randomized context and an 8 KiB entropy
+ * buffer across calls, so small pieces still share RNG requests and memory
+ * stays bounded.
+ *
+ * @note A generator must not be used by more than one thread at a time.
+ */
+typedef struct secp256k1_wrapper_keygen secp256k1_wrapper_keygen;
+
+/**
+ * @brief Creates a key pair generator.
+ *
+ * @param[in] compressed 1 for compressed public keys (33 bytes), 0 for
+ *                       uncompressed public keys (65 bytes).
+ *
+ * @return A new generator, or NULL if `compressed` is invalid or allocation,
+ *         random number generation or randomization failed. Release it with
+ *         secp256k1_wrapper_keygen_close().
+ */
+secp256k1_wrapper_keygen* secp256k1_wrapper_keygen_open(int compressed);
+
+/**
+ * @brief Generates the next `n` key pairs.
+ *
+ * Same output as secp256k1_wrapper_generate_keys_batch() in all-or-nothing
+ * mode: pair i occupies bytes [32*i, 32*i+32) of `privkeys_out` and
+ * [s*i, s*i+s) of `pubkeys_out`, where s is 33 or 65. Pieces of fewer than
+ * 256 pairs are cut from the generator's entropy buffer, larger ones draw
+ * their entropy in one request. Buffered entropy is wiped as it is used and
+ * discarded in a fork()ed child, so parent and child never yield the same
+ * keys.
+ *
+ * @param[in]  gen          Generator from secp256k1_wrapper_keygen_open().
+ * @param[out] privkeys_out Buffer of n * 32 bytes. Wiped on failure.
+ * @param[out] pubkeys_out  Buffer of n * 33 or n * 65 bytes.
+ * @param[in]  n            Number of key pairs. 0 is a successful no-op.
+ *
+ * @return int Returns 0 on success, or a negative value on error:
+ *             - -1: Invalid input (null arguments, n too large).
+ *             - -2: Context randomization failed.
+ *             - -3: Random number generation failed.
+ *             - -5: Public key creation or serialization failed.
+ */
+int secp256k1_wrapper_keygen_next(secp256k1_wrapper_keygen* gen, unsigned char* privkeys_out,
+                                  unsigned char* pubkeys_out, size_t n);
+
+/**
+ * @brief Wipes and frees a generator. Passing NULL is a no-op.
+ *
+ * @param[in] gen Generator from secp256k1_wrapper_keygen_open().
+ */
+void secp256k1_wrapper_keygen_close(secp256k1_wrapper_keygen* gen);
+
+
+/* ---- Resumable batch jobs ---- */
+
+/**
+ * @brief Opaque batch job run in steps on the caller's thread.
+ *
+ * For cooperative schedulers that can neither block on a large batch nor
+ * hand threads to the library. The job owns a randomized context; every
+ * step runs a bounded part of the batch and returns. The output, error
+ * codes and wiping rules are those of the matching batch call.
+ *
+ * @note A job must not be stepped by more than one thread at a time. The
+ *       buffers passed at creation must stay valid until the job is freed.
+ */
+typedef struct secp256k1_wrapper_job secp256k1_wrapper_job;
+
+/**
+ * @brief Creates a step-wise secp256k1_wrapper_generate_keys_batch().
+ *
+ * Takes the same arguments. In all-or-nothing mode a failure in any step
+ * ends the job and wipes every private key written so far.
+ *
+ * @return A new job, or NULL on invalid arguments or if allocation, random
+ *         number generation or randomization failed. Release it with
+ *         secp256k1_wrapper_job_free().
+ */
+secp256k1_wrapper_job* secp256k1_wrapper_job_generate_keys(unsigned char* privkeys_out, unsigned char* pubkeys_out,
+                                                           size_t n, int compressed, int flags, int* results);
+
+/**
+ * @brief Creates a step-wise secp256k1_wrapper_derive_pubkey_batch().
+ *
+ * Takes the same arguments; `results` is filled in as steps progress.
+ *
+ * @return A new job, or NULL on invalid arguments or if allocation, random
+ *         number generation or randomization failed. Release it with
+ *         secp256k1_wrapper_job_free().
+ */
+secp256k1_wrapper_job* secp256k1_wrapper_job_derive_pubkeys(const unsigned char* privkeys, unsigned char* pubkeys_out,
+                                                            size_t n, int compressed, int* results);
+
+/**
+ * @brief Runs the next part of a job.
+ *
+ * Processes items in slices of a few keys and returns once `max_items`
+ * items have been processed, `max_us` microseconds have elapsed (checked
+ * between slices, so a step may overrun by one slice), or the job is done.
+ * Each step makes progress by at least one item.
+ *
+ * @param[in,out] job       Job to advance.
+ * @param[in]     max_items Item budget, or 0 for no item limit.
+ * @param[in]     max_us    Time budget in microseconds, or 0 for no time limit.
+ *
+ * @return int 1 if the job is done, 0 if work remains, -1 if `job` is NULL.
+ */
+int secp256k1_wrapper_job_step(secp256k1_wrapper_job* job, size_t max_items, uint64_t max_us);
+
+/**
+ * @brief Reports a job's outcome and progress.
+ *
+ * @param[in]  job  Job to query.
+ * @param[out] done Receives the number of items processed so far. May be NULL.
+ *
+ * @return int 1 while the job is unfinished, otherwise the code the batch
+ *             call would have returned (0 or negative). -1 if `job` is NULL.
+ */
+int secp256k1_wrapper_job_result(const secp256k1_wrapper_job* job, size_t* done);
+
+/**
+ * @brief Frees a job, finished or not. Passing NULL is a no-op.
+ *
+ * Abandoning an unfinished job leaves the outputs partially written.
+ */
+void secp256k1_wrapper_job_free(secp256k1_wrapper_job* job);
+
+
+/* ---- Asynchronous requests ---- */
+
+/** Request kinds for secp256k1_wrapper_async_req::op. */
+#define SECP256K1_WRAPPER_ASYNC_GENERATE 0  /**< Generate n key pairs. */
+#define SECP256K1_WRAPPER_ASYNC_DERIVE   1  /**< Derive n public keys. */
+#define SECP256K1_WRAPPER_ASYNC_SIGN     2  /**< Sign n hashes with ECDSA. */
+#define SECP256K1_WRAPPER_ASYNC_VERIFY   3  /**< Verify n ECDSA signatures. */
+
+typedef struct secp256k1_wrapper_async_req secp256k1_wrapper_async_req;
+
+/** Completion callback, run on a service thread. */
+typedef void (*secp256k1_wrapper_async_cb)(secp256k1_wrapper_async_req* req);
+
+/**
+ * @brief An asynchronous request, owned by the caller.
+ *
+ * The caller zeroes the request, fills in the input fields its op uses and
+ * keeps the request and its buffers alive and untouched from
+ * secp256k1_wrapper_async_submit() until it completes: when its callback
+ * runs, or when secp256k1_wrapper_async_reap() returns it.
+ *
+ * GENERATE and DERIVE use `compressed`, `privkeys` and `pubkeys_out`. SIGN
+ * takes the arguments of secp256k1_wrapper_sign_batch() in `privkeys`,
+ * `results` and `args.sign`, VERIFY those of
+ * secp256k1_wrapper_verify_batch() in `args.verify`.
+ */
+struct secp256k1_wrapper_async_req {
+    int op;                               /**< One of SECP256K1_WRAPPER_ASYNC_*. */
+    int compressed;                       /**< 1 for 33-byte, 0 for 65-byte public keys. */
+    size_t n;                             /**< Number of keys or signatures, at least 1. */
+    unsigned char* privkeys;              /**< n * 32 bytes: written by GENERATE (wiped on
+                                               failure), read by DERIVE and SIGN. */
+    unsigned char* pubkeys_out;           /**< n * 33 or n * 65 bytes. */
+    int* results;                         /**< DERIVE and SIGN, optional: n per-item codes as
+                                               in the matching batch call. */
+    secp256k1_wrapper_async_cb callback;  /**< Completion callback, or NULL to reap. */
+    void* user_data;                      /**< Not used by the library. */
+    int result;                           /**< Set on completion: the code the matching
+                                               batch call would return. */
+    /** Arguments of the other ops. `reserved` fixes the size of the struct
+     *  as ops are added. */
+    union {
+        struct secp256k1_wrapper_async_sign_args {
+            const unsigned char* hashes;  /**< n * 32 bytes. */
+            unsigned char* sigs_out;      /**< n * 64 or n * 72 bytes. */
+            size_t* sig_lens;             /**< n lengths. Required for DER. */
+            int format;                   /**< SECP256K1_WRAPPER_SIG_*. */
+        } sign;
+        struct secp256k1_wrapper_async_verify_args {
+            const secp256k1_wrapper_verify_item* items;  /**< n items. */
+            int format;                   /**< SECP256K1_WRAPPER_SIG_*. */
+            int mode;                     /**< SECP256K1_WRAPPER_VERIFY_*. */
+            unsigned char* valid_bitmap;  /**< (n + 7) / 8 bytes. Required in
+                                               SECP256K1_WRAPPER_VERIFY_ALL mode. */
+        } verify;
+        void* reserved[8];
+    } args;
+};
+
+/**
+ * @brief Starts the asynchronous request service.
+ *
+ * `threads` service threads, each with its own randomized context, take
+ * requests from a lock-free multi-producer multi-consumer queue. They pop
+ * several requests at a time: small key generation requests popped together
+ * share one RNG request, and so does the nonce entropy of small sign
+ * requests. Sign requests run on the service thread's context; verify
+ * requests use the worker pool in parallel mode, like
+ * secp256k1_wrapper_verify_batch().
+ *
+ * @param[in] threads    Number of service threads, 1 to 1024.
+ * @param[in] queue_size Maximum number of outstanding requests, 1 to 2^20.
+ *                       Requests count until their callback has been called
+ *                       or they have been reaped.
+ *
+ * @return int Returns 0 on success, or a negative value on error:
+ *             - -1: Invalid arguments, or the service is already running.
+ *             - -2: Allocation, notification fd, thread start, context
+ *                   creation or randomization failed.
+ *             - -3: Random number generation failed.
+ */
+int secp256k1_wrapper_async_init(size_t threads, size_t queue_size);
+
+/**
+ * @brief Queues a request without blocking.
+ *
+ * When the request completes, its callback is called on a service thread.
+ * Without a callback it is put on the completion queue instead, and the
+ * notification fd becomes readable.
+ *
+ * @param[in,out] req Request to run, see secp256k1_wrapper_async_req.
+ *
+ * @return int Returns 0 if the request was queued, or a negative value:
+ *             - -1: Invalid request (unknown op, null buffers the op
+ *                   needs, n of 0 or too large, invalid compressed, format
+ *                   or mode value).
+ *             - -6: The service is not running, or this is a fork()ed
+ *                   child of the process that started it.
+ *             - -7: queue_size requests are already outstanding.
+ */
+int secp256k1_wrapper_async_submit(secp256k1_wrapper_async_req* req);
+
+/**
+ * @brief Collects completed requests that have no callback.
+ *
+ * Also resets the notification fd; it becomes readable again when more
+ * requests complete, or at once if `max` requests were returned and more
+ * may be waiting. Safe to call from any thread.
+ *
+ * @param[out] reqs_out Receives up to `max` completed requests.
+ * @param[in]  max      Capacity of `reqs_out`.
+ *
+ * @return size_t Number of requests returned.
+ */
+size_t secp256k1_wrapper_async_reap(secp256k1_wrapper_async_req** reqs_out, size_t max);
+
+/**
+ * @brief Returns the completion notification fd.
+ *
+ * A non-blocking descriptor (an eventfd on Linux, the read end of a pipe on
+ * other POSIX systems) to add to an epoll, kqueue or poll set. It becomes
+ * readable when requests without callback complete. Do not read or close
+ * it; secp256k1_wrapper_async_reap() resets it.
+ *
+ * @return int The fd, or -1 if the service is not running or on Windows.
+ */
+int secp256k1_wrapper_async_fd(void);
+
+/**
+ * @brief Runs the remaining queued requests and stops the service.
+ *
+ * Requests already completed but not reaped can no longer be reaped, so
+ * reap everything first. Must not be called concurrently with submit().
+ */
+void secp256k1_wrapper_async_shutdown(void);
+
+
+/* ---- Persistent context API ---- */
+
+/**
+ * @brief Opaque handle owning a reusable, randomized libsecp256k1 context.
+ *
+ * The one-shot functions above create and destroy a libsecp256k1 context on
+ * every call. A handle keeps that context alive so its setup cost (allocation
+ * and blinding) is paid once instead of per key.
+ *
+ * @note A handle must not be used by more than one thread at a time. Use one
+ *       handle per thread, or serialize access externally.
+ */
+typedef struct secp256k1_wrapper_ctx secp256k1_wrapper_ctx;
+
+/**
+ * @brief Creates a new context handle.
+ *
+ * The underlying context is randomized (blinded) before it is returned.
+ *
+ * @return A new handle, or NULL if allocation, random number generation or
+ *         randomization failed. Release it with secp256k1_wrapper_ctx_destroy().
+ */
+secp256k1_wrapper_ctx* secp256k1_wrapper_ctx_create(void);
+
+/**
+ * @brief Destroys a context handle. Passing NULL is a no-op.
+ *
+ * @param[in] ctx Handle returned by secp256k1_wrapper_ctx_create().
+ */
+void secp256k1_wrapper_ctx_destroy(secp256k1_wrapper_ctx* ctx);
+
+/**
+ * @brief Re-randomizes (re-blinds) the context held by a handle.
+ *
+ * Long-lived contexts should be re-randomized periodically to limit the
+ * amount of side-channel information gathered under a single blinding value.
+ *
+ * @param[in] ctx Handle returned by secp256k1_wrapper_ctx_create().
+ *
+ * @return int Returns 0 on success, or a negative value on error:
+ *             - -1: Invalid input (null handle).
+ *             - -2: Context randomization failed.
+ *             - -3: Random number generation failed.
+ */
+int secp256k1_wrapper_ctx_rerandomize(secp256k1_wrapper_ctx* ctx);
+
+/**
+ * @brief Same as secp256k1_wrapper_generate_keys(), using an existing handle.
+ *
+ * @param[in] ctx Handle returned by secp256k1_wrapper_ctx_create().
+ *
+ * @return int Same codes as secp256k1_wrapper_generate_keys(); a null
+ *             handle is reported as -1.
+ */
+int secp256k1_wrapper_generate_keys_ctx(secp256k1_wrapper_ctx* ctx, unsigned char* privkey_out, unsigned char* pubkey_out, int compressed);
+
+/**
+ * @brief Same as secp256k1_wrapper_derive_pubkey(), using an existing handle.
+ *
+ * @param[in] ctx Handle returned by secp256k1_wrapper_ctx_create().
+ *
+ * @return int Same codes as secp256k1_wrapper_derive_pubkey(); a null
+ *             handle is reported as -1.
+ */
+int secp256k1_wrapper_derive_pubkey_ctx(secp256k1_wrapper_ctx* ctx, const unsigned char* privkey, unsigned char* pubkey_out, int compressed);
+
+/**
+ * @brief Same as secp256k1_wrapper_sign(), using an existing handle.
+ *
+ * @param[in] ctx Handle returned by secp256k1_wrapper_ctx_create().
+ *
+ * @return int Same codes as secp256k1_wrapper_sign(); a null handle is
+ *             reported as -1.
+ */
+int secp256k1_wrapper_sign_ctx(secp256k1_wrapper_ctx* ctx, const unsigned char* privkey, const unsigned char* hash32,
+                               unsigned char* sig_out, size_t* sig_len, int format);
+
+/**
+ * @brief Same as secp256k1_wrapper_schnorr_sign(), using an existing handle.
+ *
+ * @param[in] ctx Handle returned by secp256k1_wrapper_ctx_create().
+ *
+ * @return int Same codes as secp256k1_wrapper_schnorr_sign(); a null
+ *             handle is reported as -1.
+ */
+int secp256k1_wrapper_schnorr_sign_ctx(secp256k1_wrapper_ctx* ctx, const secp256k1_wrapper_keypair* keypair,
+                                       const unsigned char* msg32, unsigned char* sig64_out);
+
+
+/* ---- Per-thread context cache ---- */
+
+/**
+ * @brief Enables or disables the per-thread context cache.
+ *
+ * When enabled, secp256k1_wrapper_generate_keys() and
+ * secp256k1_wrapper_derive_pubkey() reuse a context that is created and
+ * randomized lazily on first use in each thread, instead of creating one per
+ * call. The cached context is destroyed automatically when the thread exits.
+ *
+ * The default comes from the ENABLE_THREAD_CACHE build option (off unless set).
+ *
+ * @param[in] enable Non-zero to enable, zero to disable. Contexts already
+ *                   cached stay alive until their thread exits or calls
+ *                   secp256k1_wrapper_thread_cache_release().
+ */
+void secp256k1_wrapper_thread_cache_enable(int enable);
+
+/**
+ * @brief Reports whether the per-thread context cache is enabled.
+ *
+ * @return 1 if enabled, 0 otherwise.
+ */
+int secp256k1_wrapper_thread_cache_enabled(void);
+
+/**
+ * @brief Destroys the calling thread's cached context, if any.
+ *
+ * Useful for long-lived threads that are done with key operations. The next
+ * cached call in this thread creates a fresh context.
+ */
+void secp256k1_wrapper_thread_cache_release(void);
+
+
+/* ---- Shared context pool ---- */
+
+/**
+ * @brief Counters reported by secp256k1_wrapper_ctx_pool_stats().
+ */
+typedef struct secp256k1_wrapper_pool_stats {
+    size_t   size;        /**< Number of contexts in the pool (0 if not initialized). */
+    uint64_t hits;        /**< Acquisitions served from the pool. */
+    uint64_t misses;      /**< Acquisitions that found the pool empty. */
+    uint64_t contention;  /**< CAS retries on the pool's free list. */
+} secp256k1_wrapper_pool_stats;
+
+/**
+ * @brief Creates a bounded pool of pre-randomized contexts.
+ *
+ * Once initialized, secp256k1_wrapper_generate_keys() and
+ * secp256k1_wrapper_derive_pubkey() borrow a context from the pool through a
+ * lock-free free list and return it afterwards. When the pool is empty the
+ * call falls back to the per-thread cache (if enabled) or to a one-shot
+ * context, and the miss is counted.
+ *
+ * @param[in] size Number of contexts to create, at least 1.
+ *
+ * @return int Returns 0 on success, or a negative value on error:
+ *             - -1: Invalid size, or a pool is already initialized.
+ *             - -2: Allocation, context creation or randomization failed.
+ *             - -3: Random number generation failed.
+ *
+ * @note Not thread-safe with respect to secp256k1_wrapper_ctx_pool_shutdown().
+ *       Call both while no key operations are in flight.
+ */
+int secp256k1_wrapper_ctx_pool_init(size_t size);
+
+/**
+ * @brief Returns the memory needed by secp256k1_wrapper_ctx_pool_init_preallocated().
+ *
+ * @param[in] count Number of contexts the pool should hold.
+ *
+ * @return Size in bytes, including alignment slack, or 0 if count is 0 or
+ *         the size would overflow.
+ */
+size_t secp256k1_wrapper_ctx_pool_preallocated_size(size_t count);
+
+/**
+ * @brief Creates the context pool in caller-supplied or static memory.
+ *
+ * Same as secp256k1_wrapper_ctx_pool_init(), except that the pool, its free
+ * list and the libsecp256k1 contexts (via secp256k1_context_preallocated_create)
+ * are all placed in `mem`. As long as the pool has a free context,
+ * secp256k1_wrapper_generate_keys() and secp256k1_wrapper_derive_pubkey()
+ * perform no heap allocation. Size the pool for the maximum number of
+ * concurrent callers: a miss falls back to a heap-allocated context.
+ *
+ * @param[in] mem      Storage of at least
+ *                     secp256k1_wrapper_ctx_pool_preallocated_size(count) bytes,
+ *                     any alignment. It must stay valid until
+ *                     secp256k1_wrapper_ctx_pool_shutdown(). If NULL, a static
+ *                     arena of SECP256K1_WRAPPER_STATIC_ARENA_SIZE bytes
+ *                     (16 KiB unless overridden at build time) is used and
+ *                     mem_size is ignored.
+ * @param[in] mem_size Size of `mem` in bytes.
+ * @param[in] count    Number of contexts, at least 1.
+ *
+ * @return int Returns 0 on success, or a negative value on error:
+ *             - -1: Invalid count, memory too small, or a pool is already initialized.
+ *             - -2: Context creation or randomization failed.
+ *             - -3: Random number generation failed.
+ */
+int secp256k1_wrapper_ctx_pool_init_preallocated(void* mem, size_t mem_size, size_t count);
+
+/**
+ * @brief Destroys the context pool. No-op if no pool is initialized.
+ *
+ * @warning No key operation may be in flight while the pool is shut down.
+ */
+void secp256k1_wrapper_ctx_pool_shutdown(void);
+
+/**
+ * @brief Reads the pool counters.
+ *
+ * @param[out] stats Receives the counters; all zero if no pool is initialized.
+ */
+void secp256k1_wrapper_ctx_pool_stats(secp256k1_wrapper_pool_stats* stats);
+
+
+/* ---- Pre-generated key pool ---- */
+
+/**
+ * @brief Counters reported by secp256k1_wrapper_get_keypool_stats().
+ */
+typedef struct secp256k1_wrapper_keypool_stats {
+    size_t   capacity;         /**< Ring size (0 if not initialized). */
+    size_t   available;        /**< Key pairs ready right now. */
+    uint64_t hits;             /**< Takes served from the ring. */
+    uint64_t misses;           /**< Takes that generated inline. */
+    uint64_t refills;          /**< Completed refills, the initial fill included. */
+    uint64_t refill_failures;  /**< Refills abandoned on an RNG or context error. */
+    int      locked;           /**< 1 if the private keys are locked in RAM. */
+} secp256k1_wrapper_keypool_stats;
+
+/**
+ * @brief Starts a background thread that keeps a ring of ready key pairs.
+ *
+ * The ring is filled before this returns. Whenever a take leaves
+ * `low_water` or fewer pairs, the thread tops it up to `capacity` with batch
+ * generation on its own randomized context. Private keys are kept in a
+ * separate mapping that is locked into RAM where the OS permits (see
+ * `locked` in the stats; RLIMIT_MEMLOCK may prevent it) and left out of
+ * core dumps.
+ *
+ * @param[in] capacity   Number of key pairs in the ring, at least 1.
+ * @param[in] low_water  Refill threshold, below `capacity`.
+ * @param[in] compressed Non-zero for compressed public keys (33 bytes), zero
+ *                       for uncompressed public keys (65 bytes). Applies to
+ *                       every pair the pool hands out.
+ *
+ * @return int Returns 0 on success, or a negative value on error:
+ *             - -1: Invalid arguments, or a key pool is already running.
+ *             - -2: Allocation, thread start, context creation or
+ *                   randomization failed.
+ *             - -3: Random number generation failed.
+ *             - -5: Public key creation or serialization failed.
+ *
+ * @note Not thread-safe with respect to secp256k1_wrapper_keypool_shutdown().
+ */
+int secp256k1_wrapper_keypool_init(size_t capacity, size_t low_water, int compressed);
+
+/**
+ * @brief Hands out one pre-generated key pair.
+ *
+ * Copies the oldest ready pair out and wipes its slot. No key pair is ever
+ * returned twice. If the ring is empty the pair is generated inline with
+ * secp256k1_wrapper_generate_keys(), and the miss is counted. In a fork()ed
+ * child the ring is wiped and every take generates inline, so parent and
+ * child never share keys.
+ *
+ * @param[out] privkey_out 32-byte buffer for the private key.
+ * @param[out] pubkey_out  Buffer for the public key, 33 or 65 bytes as
+ *                         chosen by secp256k1_wrapper_keypool_init().
+ *
+ * @return int Returns 0 on success, or a negative value on error:
+ *             - -1: Invalid input (null buffers).
+ *             - -6: No key pool is running.
+ *             - otherwise, as secp256k1_wrapper_generate_keys() on a miss.
+ */
+int secp256k1_wrapper_keypool_take(unsigned char* privkey_out, unsigned char* pubkey_out);
+
+/**
+ * @brief Stops the refill thread and wipes and frees the ring.
+ *
+ * Must not be called while takes are in flight. Does nothing if no key pool
+ * is running.
+ */
+void secp256k1_wrapper_keypool_shutdown(void);
+
+/**
+ * @brief Reads the key pool counters.
+ *
+ * @param[out] stats Receives the counters; all zero if no key pool is running.
+ */
+void secp256k1_wrapper_get_keypool_stats(secp256k1_wrapper_keypool_stats* stats);
+
+
+/* ---- Signature cache ---- */
+
+/**
+ * @brief Counters reported by secp256k1_wrapper_get_sigcache_stats().
+ */
+typedef struct secp256k1_wrapper_sigcache_stats {
+    size_t   capacity;    /**< Entries the cache can hold (0 if not initialized). */
+    uint64_t hits;        /**< Verifications answered by the cache. */
+    uint64_t misses;      /**< Verifications that ran in full. */
+    uint64_t inserts;     /**< Valid signatures recorded. */
+    uint64_t evictions;   /**< Live entries dropped for lack of room. */
+    uint64_t generation;  /**< Current insert generation. */
+} secp256k1_wrapper_sigcache_stats;
+
+/**
+ * @brief Enables a cache of verified signatures.
+ *
+ * Once enabled, secp256k1_wrapper_verify() and
+ * secp256k1_wrapper_verify_batch() look every (public key, hash, signature)
+ * triple up first and skip verification on a hit; triples that verify are
+ * recorded. Entries are SHA-256 digests of the triple under a random salt,
+ * held in a fixed-size cuckoo set. Lookups take no lock. When the cache is
+ * full, entries from older insert generations are replaced first. Invalid
+ * signatures are never cached.
+ *
+ * @param[in] max_bytes Memory for the table; about 40 bytes per entry.
+ *
+ * @return int Returns 0 on success, or a negative value on error:
+ *             - -1: max_bytes too small, or a cache is already enabled.
+ *             - -2: Allocation failed.
+ *             - -3: Random number generation failed.
+ *
+ * @note Not thread-safe with respect to verification in flight or
+ *       secp256k1_wrapper_sigcache_shutdown(). A fork()ed child keeps using
+ *       the entries it inherited but records no new ones.
+ */
+int secp256k1_wrapper_sigcache_init(size_t max_bytes);
+
+/**
+ * @brief Disables and frees the signature cache.
+ *
+ * Must not be called while verifications are in flight. Does nothing if no
+ * cache is enabled.
+ */
+void secp256k1_wrapper_sigcache_shutdown(void);
+
+/**
+ * @brief Reads the signature cache counters.
+ *
+ * @param[out] stats Receives the counters; all zero if no cache is enabled.
+ */
+void secp256k1_wrapper_get_sigcache_stats(secp256k1_wrapper_sigcache_stats* stats);
+
+/* ---- Parsed public keys ---- */
+
+/**
+ * @brief Opaque handle to a parsed public key.
+ *
+ * Holds libsecp256k1's parsed form of the key, so verifying against it
+ * skips parsing and, for compressed keys, the decompression of y. Handles
+ * are reference counted and immutable; one handle may be used from any
+ * number of threads at once.
+ */
+typedef struct secp256k1_wrapper_pubkey secp256k1_wrapper_pubkey;
+
+/**
+ * @brief Counters reported by secp256k1_wrapper_get_pubkey_cache_stats().
+ */
+typedef struct secp256k1_wrapper_pubkey_cache_stats {
+    size_t   capacity;    /**< Keys the cache can hold (0 if not initialized). */
+    size_t   size;        /**< Keys currently cached. */
+    uint64_t hits;        /**< Parses answered by the cache. */
+    uint64_t misses;      /**< Parses that ran in full. */
+    uint64_t evictions;   /**< Least recently used keys dropped for room. */
+} secp256k1_wrapper_pubkey_cache_stats;
+
+/**
+ * @brief Parses a serialized public key into a handle.
+ *
+ * With the public key cache enabled, a key parsed before is handed out from
+ * the cache instead of being parsed again, and a new key is added to it.
+ *
+ * @param[in]  pubkey     Serialized public key (33 or 65 bytes).
+ * @param[in]  pubkey_len Length of pubkey.
+ * @param[out] handle_out Receives the handle, or NULL on error. Release it
+ *                        with secp256k1_wrapper_pubkey_release().
+ *
+ * @return int Returns 0 on success, or a negative value on error:
+ *             - -1: Invalid input (null buffers or invalid length).
+ *             - -2: Allocation failed.
+ *             - -5: Unparsable public key.
+ */
+int secp256k1_wrapper_pubkey_parse(const unsigned char* pubkey, size_t pubkey_len,
+                                   secp256k1_wrapper_pubkey** handle_out);
+
+/**
+ * @brief Releases a handle from secp256k1_wrapper_pubkey_parse().
+ *
+ * The key is freed once neither the cache nor any caller holds it.
+ * Accepts NULL.
+ */
+void secp256k1_wrapper_pubkey_release(secp256k1_wrapper_pubkey* handle);
+
+/**
+ * @brief Verifies an ECDSA signature against a parsed public key.
+ *
+ * Same as secp256k1_wrapper_verify(), minus the key parsing. The signature
+ * cache, if enabled, is consulted as usual.
+ *
+ * @param[in] pubkey  Handle from secp256k1_wrapper_pubkey_parse().
+ * @param[in] hash32  32-byte message hash.
+ * @param[in] sig     Signature, compact (64 bytes) or DER.
+ * @param[in] sig_len Length of sig.
+ * @param[in] format  SECP256K1_WRAPPER_SIG_COMPACT or
+ *                    SECP256K1_WRAPPER_SIG_DER.
+ *
+ * @return int Returns 0 if the signature is valid, or a negative value:
+ *             - -1: Invalid input (null buffers or invalid format).
+ *             - -4: Invalid or unparsable signature.
+ */
+int secp256k1_wrapper_verify_pubkey(const secp256k1_wrapper_pubkey* pubkey, const unsigned char* hash32,
+                                    const unsigned char* sig, size_t sig_len, int format);
+
+/**
+ * @brief Enables an LRU cache of parsed public keys.
+ *
+ * Once enabled, secp256k1_wrapper_pubkey_parse() hands out cached handles,
+ * and secp256k1_wrapper_verify() and secp256k1_wrapper_verify_batch() parse
+ * their keys through the cache. Entries are keyed by the serialized key, so
+ * the compressed and uncompressed forms of a key are cached separately.
+ * Unparsable keys are never cached.
+ *
+ * The cache is split into up to 16 independently locked shards by key
+ * hash, so concurrent verify workers seldom wait on each other. Each shard
+ * holds an equal share of the capacity and drops its own least recently
+ * used key to make room.
+ *
+ * @param[in] capacity Number of keys to keep.
+ *
+ * @return int Returns 0 on success, or a negative value on error:
+ *             - -1: capacity is 0 or too large, or a cache is already
+ *                   enabled.
+ *             - -2: Allocation failed.
+ *             - -3: Random number generation failed.
+ *
+ * @note Not thread-safe with respect to parses in flight or
+ *       secp256k1_wrapper_pubkey_cache_shutdown(). A fork()ed child parses
+ *       every key afresh.
+ */
+int secp256k1_wrapper_pubkey_cache_init(size_t capacity);
+
+/**
+ * @brief Disables and frees the public key cache.
+ *
+ * Handles still held by callers stay valid until released. Must not be
+ * called while parses are in flight. Does nothing if no cache is enabled.
+ */
+void secp256k1_wrapper_pubkey_cache_shutdown(void);
+
+/**
+ * @brief Reads the public key cache counters.
+ *
+ * @param[out] stats Receives the counters; all zero if no cache is enabled.
+ */
+void secp256k1_wrapper_get_pubkey_cache_stats(secp256k1_wrapper_pubkey_cache_stats* stats);
+
+
+/* ---- Re-randomization policy ---- */
+
+/** Never re-randomize long-lived contexts automatically (default). */
+#define SECP256K1_WRAPPER_RERANDOMIZE_NEVER      0
+/** Re-randomize a context after every N operations performed on it. */
+#define SECP256K1_WRAPPER_RERANDOMIZE_EVERY_N_OPS 1
+/** Re-randomize a context when T milliseconds passed since its last blinding. */
+#define SECP256K1_WRAPPER_RERANDOMIZE_EVERY_T_MS  2
+
+/** Largest EVERY_T_MS interval; longer ones would overflow in microseconds. */
+#define SECP256K1_WRAPPER_RERANDOMIZE_T_MS_MAX (UINT64_MAX / 1000u)
+
+/**
+ * @brief Sets the process-wide re-blinding policy for long-lived contexts.
+ *
+ * Applies to handles from secp256k1_wrapper_ctx_create(), to per-thread cached
+ * contexts and to pooled contexts. Every context is randomized when it is
+ * created; this policy controls how often that is repeated afterwards, trading
+ * side-channel hardening against throughput. The 32-byte seed is drawn from
+ * secp256k1_wrapper_fill_random().
+ *
+ * For example, EVERY_N_OPS with interval 1 re-blinds before every operation
+ * after the first, which matches the cost of a fresh context per call.
+ *
+ * @param[in] policy   One of the SECP256K1_WRAPPER_RERANDOMIZE_* values.
+ * @param[in] interval Operation count (EVERY_N_OPS) or milliseconds
+ *                     (EVERY_T_MS), must be non-zero. EVERY_T_MS
+ *                     intervals are at most
+ *                     SECP256K1_WRAPPER_RERANDOMIZE_T_MS_MAX. Ignored for
+ *                     NEVER.
+ *
+ * @return 0 on success, -1 on invalid policy or interval.
+ *
+ * @note If re-blinding fails, the operation that triggered it fails with -2
+ *       (randomization failed) or -3 (random number generation failed).
+ */
+int secp256k1_wrapper_set_rerandomize_policy(int policy, uint64_t interval);
+
 
 /**
  * @brief Fills a buffer with random bytes.
@@ -117,6 +1384,7 @@ int secp256k1_wrapper_derive_pubkey(const unsigned char* privkey, unsigned char*
  * This function generates random bytes and fills the provided buffer with them.
  * The method of generating random bytes depends on the operating system:
  * - On Windows, it uses the BCryptGenRandom function.
+ * - On Linux 6.11+, it uses the vDSO getrandom, which needs no system call.
  * - On Linux and FreeBSD, it uses the getrandom system call (with /dev/urandom fallback).
  * - On macOS, it uses CCRandomGenerateBytes (with getentropy fallback for ≤256 bytes).
  * - On OpenBSD, it uses the getentropy function (limited to 256 bytes).
@@ -127,7 +1395,16 @@ int secp256k1_wrapper_derive_pubkey(const unsigned char* privkey, unsigned char*
  * @return 1 if the buffer was successfully filled with random bytes, 0 otherwise.
  * 
  * @note 
- * - On Linux and FreeBSD, if `getrandom` fails with ENOSYS, falls back to /dev/urandom.
+ * - When the buffered source is selected with secp256k1_wrapper_set_rng(), small
+ *   requests are served from a per-thread buffer filled by the calls below.
+ *   With the ChaCha20 source, the buffer and large requests come from a
+ *   per-thread DRBG that is seeded from those calls instead.
+ * - On Linux, the vDSO symbol is looked up once per process. Each thread maps
+ *   its own small state for it on first use, which is unmapped at thread exit.
+ *   If the kernel does not export it, the getrandom system call is used.
+ * - On Linux and FreeBSD, if `getrandom` fails with ENOSYS, falls back to /dev/urandom,
+ *   read through one close-on-exec descriptor opened once per process. Short
+ *   reads and EINTR are retried, so any size can be requested in one call.
  * - On macOS, tries CCRandomGenerateBytes first, then getentropy for sizes ≤256 bytes.
  * - On OpenBSD, getentropy is limited to 256 bytes per call.
  * - On Windows, fails if the requested size is greater than `ULONG_MAX`.
@@ -135,4 +1412,53 @@ int secp256k1_wrapper_derive_pubkey(const unsigned char* privkey, unsigned char*
  */
 int secp256k1_wrapper_fill_random(unsigned char* data, size_t size);
 
+/* ---- Random source selection ---- */
+
+/** One operating system call per request (default). */
+#define SECP256K1_WRAPPER_RNG_SYSTEM   0
+/** Per-thread buffer refilled from the operating system in large reads. */
+#define SECP256K1_WRAPPER_RNG_BUFFERED 1
+/** Per-thread ChaCha20 DRBG seeded from the operating system. */
+#define SECP256K1_WRAPPER_RNG_CHACHA20 2
+
+#define SECP256K1_WRAPPER_RNG_BUFFER_MIN     4096u
+#define SECP256K1_WRAPPER_RNG_BUFFER_DEFAULT 16384u
+#define SECP256K1_WRAPPER_RNG_BUFFER_MAX     (1024u * 1024u)
+
+/**
+ * @brief Selects the source used by secp256k1_wrapper_fill_random().
+ *
+ * In buffered mode each thread keeps a buffer of `buffer_size` bytes filled
+ * with a single system call, and serves requests of up to a quarter of that
+ * size from it. Served bytes are wiped from the buffer immediately. Larger
+ * requests go straight to the operating system. A buffer filled before a
+ * fork() is discarded in the child, so parent and child never share bytes.
+ *
+ * The ChaCha20 source buffers the same way, but refills the buffer, and
+ * serves larger requests, from a per-thread fast-key-erasure ChaCha20 DRBG:
+ * every call expands the key into a keystream and replaces the key with the
+ * first 32 bytes of it, so earlier output cannot be recovered from the
+ * current state. The key is seeded from the operating system on first use,
+ * after a fork() and after every 1 MiB of output. The block function uses
+ * AVX2 when the CPU supports it.
+ *
+ * @param[in] source      SECP256K1_WRAPPER_RNG_SYSTEM, SECP256K1_WRAPPER_RNG_BUFFERED
+ *                        or SECP256K1_WRAPPER_RNG_CHACHA20.
+ * @param[in] buffer_size Per-thread buffer size in bytes, between
+ *                        SECP256K1_WRAPPER_RNG_BUFFER_MIN and
+ *                        SECP256K1_WRAPPER_RNG_BUFFER_MAX. 0 selects
+ *                        SECP256K1_WRAPPER_RNG_BUFFER_DEFAULT.
+ *
+ * @return 0 on success, -1 on invalid source or buffer size.
+ *
+ * @note Buffers are allocated lazily, once per thread, and freed when the
+ *       thread exits.
+ */
+int secp256k1_wrapper_set_rng(int source, size_t buffer_size);
+
+/**
+ * @brief Wipes and frees the calling thread's entropy buffer and DRBG state, if any.
+ */
+void secp256k1_wrapper_rng_thread_release(void);
+
 #endif // SECP256K1_WRAPPER_H
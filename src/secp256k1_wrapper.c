@@ -15,6 +15,7 @@
 #include "secp256k1_wrapper.h"
 #include "secp256k1.h"
 #include <string.h>
+#include <time.h>
 
 #if defined(__cplusplus)
 #error Trying to compile a C project with a C++ compiler.
@@ -23,144 +24,261 @@
 /* ---------- Platform headers ---------- */
 
 #if defined(_WIN32)
-  /*
-   * The defined WIN32_NO_STATUS macro disables return code definitions in
-   * windows.h, which avoids "macro redefinition" MSVC warnings in ntstatus.h.
-   */
-  #define WIN32_NO_STATUS
   #include <windows.h>
-  #undef WIN32_NO_STATUS
-  #include <ntstatus.h>
-  #include <bcrypt.h>
-  #include <limits.h>
-  #define HAVE_WIN_SECURE_ZERO 1
-#elif defined(__linux__) || defined(__FreeBSD__)
-  #include <sys/random.h>
-  #include <errno.h>
-  #include <fcntl.h>
-  #include <unistd.h>
-#elif defined(__APPLE__)
-  // CCRandomGenerateBytes (in libSystem)
-  #include <CommonCrypto/CommonRandom.h>   
-  #if defined(USE_SECURITY_RNG)
-    #include <Security/SecRandom.h>        
-  #endif
-  #include <sys/random.h>               
-  #include <unistd.h>
-#elif defined(__OpenBSD__) || defined(__FreeBSD__) || defined(__NetBSD__)
-  #include <sys/random.h>  
-  #include <unistd.h>
-  #include <stdlib.h>                     
+#elif defined(__linux__) || defined(__FreeBSD__) || defined(__APPLE__) || \
+      defined(__OpenBSD__) || defined(__NetBSD__)
+  #include <pthread.h>
 #else
   #error "Couldn't identify the OS"
 #endif
 
+#include "secp256k1_wrapper_internal.h"
 
-/* Secure memory zeroing that won't be optimized away */
-static void secure_memzero(void *p, size_t n) {
-#if defined(_WIN32)
-    SecureZeroMemory(p, n);
-#elif defined(__STDC_LIB_EXT1__)
-    (void)memset_s(p, n, 0, n);   // In case someone actually implemented section K
-#elif defined(__GNUC__) || defined(__clang__)
-
-    /* Let the compiler emit an efficient memset, then block DSE with a
-       compiler barrier that "uses" ptr and clobbers memory. 
-       This method is used in Linux kernel : `memzero_explicit()` see the `barrier_data`  
-       ```
-       static inline void memzero_explicit(void *s, size_t count){
-	        memset(s, 0, count);
-	        barrier_data(s);
-        }
-        ```*/
+/* Build-time default for the per-thread context cache (ENABLE_THREAD_CACHE) */
+#ifndef SECP256K1_WRAPPER_THREAD_CACHE_DEFAULT
+  #define SECP256K1_WRAPPER_THREAD_CACHE_DEFAULT 0
+#endif
 
-    memset(p, 0, n);
-    __asm__ __volatile__ ("" : : "r"(p) : "memory");
-#else
-    /* Fallback. cannot be optimized away, I hope */
-    typedef void *(*memset_fn)(void *, int, size_t);
-    volatile memset_fn vmemset = memset;
-    vmemset(p, 0, n);
 
+const char* secp256k1_wrapper_get_version(void) {
+    return STR(SECP256K1_WRAPPER_VERSION_MAJOR) "." STR(SECP256K1_WRAPPER_VERSION_MINOR) "." STR(SECP256K1_WRAPPER_VERSION_PATCH);
+}
+
+uint64_t wrapper_monotonic_us(void) {
+#if defined(_WIN32)
+    LARGE_INTEGER freq, now;
+    QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&now);
+    uint64_t f = (uint64_t)freq.QuadPart, t = (uint64_t)now.QuadPart;
+    return (t / f) * 1000000u + (t % f) * 1000000u / f;  // split to avoid overflow
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000u + (uint64_t)ts.tv_nsec / 1000u;
 #endif
 }
 
-const char* secp256k1_wrapper_get_version(void) {
-    return STR(SECP256K1_WRAPPER_VERSION_MAJOR) "." STR(SECP256K1_WRAPPER_VERSION_MINOR) "." STR(SECP256K1_WRAPPER_VERSION_PATCH);
+/* ---------- Fork safety ---------- */
+
+volatile uint32_t wrapper_fork_gen = 0;
+
+#if !defined(_WIN32)
+static pthread_once_t g_fork_once = PTHREAD_ONCE_INIT;
+
+/* Runs in the child only; keep it to plain stores */
+static void wrapper_atfork_child(void) {
+    wrapper_atomic_store_u32(&wrapper_fork_gen, wrapper_fork_gen + 1);
+    wrapper_ctx_pool_after_fork();
+    wrapper_keypool_after_fork();
 }
 
-// Function that generates and returns both private and public keys
-int secp256k1_wrapper_generate_keys(unsigned char* privkey_out, unsigned char* pubkey_out, int compressed) {
+static void wrapper_fork_register(void) {
+    (void)pthread_atfork(NULL, NULL, wrapper_atfork_child);
+}
+#endif
 
-    if (privkey_out == NULL || pubkey_out == NULL || (compressed != 0 && compressed != 1)) {
-        return -1; // Invalid input
-    }
+void wrapper_fork_guard(void) {
+#if !defined(_WIN32)
+    (void)pthread_once(&g_fork_once, wrapper_fork_register);
+#endif
+}
 
-    size_t pubkey_len = compressed ? PUBKEY_COMPRESSION_SIZE : PUBKEY_UNCOMPRESSION_SIZE;
-    int flags = compressed ? SECP256K1_EC_COMPRESSED : SECP256K1_EC_UNCOMPRESSED;
+/* ---------- Re-randomization policy ---------- */
 
+static volatile int g_rerandomize_policy = SECP256K1_WRAPPER_RERANDOMIZE_NEVER;
+static volatile uint64_t g_rerandomize_interval = 0;
 
-    secp256k1_context* ctx = secp256k1_context_create(SECP256K1_CONTEXT_SIGN);
-    if (!ctx) {
-        return -2; // Context creation failed
+int secp256k1_wrapper_set_rerandomize_policy(int policy, uint64_t interval) {
+    switch (policy) {
+    case SECP256K1_WRAPPER_RERANDOMIZE_NEVER:
+        interval = 0;
+        break;
+    case SECP256K1_WRAPPER_RERANDOMIZE_EVERY_N_OPS:
+        if (interval == 0) {
+            return -1; // Invalid input
+        }
+        break;
+    case SECP256K1_WRAPPER_RERANDOMIZE_EVERY_T_MS:
+        if (interval == 0 || interval > SECP256K1_WRAPPER_RERANDOMIZE_T_MS_MAX) {
+            return -1; // Invalid input; longer intervals overflow in microseconds
+        }
+        break;
+    default:
+        return -1; // Invalid input
     }
+    /* The pair is not updated atomically; a call racing with this one may
+     * see the new policy with the old interval once, which is harmless */
+    wrapper_atomic_store_u64(&g_rerandomize_interval, interval);
+    wrapper_atomic_store_int(&g_rerandomize_policy, policy);
+    return 0;
+}
 
+int wrapper_context_randomize(secp256k1_context* ctx) {
     unsigned char randomize[PRIVKEY_SIZE];
     if (!secp256k1_wrapper_fill_random(randomize, sizeof(randomize))) {
-        secp256k1_context_destroy(ctx);  // Clean up ctx before returning
         return -3; // Random number generation failed
     }
 
     /* Randomizing the context is recommended to protect against side-channel
      * leakage See `secp256k1_context_randomize` in secp256k1.h for more
      * information about it. This should never fail. */
-    if (secp256k1_context_randomize(ctx, randomize) == 0){
-        secure_memzero(randomize, sizeof(randomize)); 
-        secp256k1_context_destroy(ctx); 
-        return -2;// Context randomization failed
+    int ok = secp256k1_context_randomize(ctx, randomize);
+
+    // Clear randomization data after use
+    secure_memzero(randomize, sizeof(randomize));
+    return ok ? 0 : -2;
+}
+
+int wrapper_ctx_rerandomize(secp256k1_wrapper_ctx* wctx) {
+    int res = wrapper_context_randomize(wctx->ctx);
+    if (res == 0) {
+        wctx->ops_since_randomize = 0;
+        wctx->randomized_at_us = wrapper_monotonic_us();
+        wctx->fork_generation = wrapper_fork_generation();
+    }
+    return res;
+}
+
+int wrapper_ctx_begin_op(secp256k1_wrapper_ctx* wctx) {
+    int policy = wrapper_atomic_load_int(&g_rerandomize_policy);
+    int res = 0;
+
+    if (wctx->fork_generation != wrapper_fork_generation()) {
+        // Forked since the last blinding: never share it with the parent
+        res = wrapper_ctx_rerandomize(wctx);
+    } else if (policy == SECP256K1_WRAPPER_RERANDOMIZE_EVERY_N_OPS) {
+        if (wctx->ops_since_randomize >= wrapper_atomic_load_u64(&g_rerandomize_interval)) {
+            res = wrapper_ctx_rerandomize(wctx);
+        }
+    } else if (policy == SECP256K1_WRAPPER_RERANDOMIZE_EVERY_T_MS) {
+        uint64_t interval_us = wrapper_atomic_load_u64(&g_rerandomize_interval) * 1000u;
+        if (wrapper_monotonic_us() - wctx->randomized_at_us >= interval_us) {
+            res = wrapper_ctx_rerandomize(wctx);
+        }
+    }
+    wctx->ops_since_randomize++;
+    return res;
+}
+
+/* Common tail of the open functions: resets counters and blinds if asked */
+static int wrapper_ctx_setup(secp256k1_wrapper_ctx* wctx, int randomize) {
+    wrapper_fork_guard();
+    wctx->ops_since_randomize = 0;
+    wctx->randomized_at_us = wrapper_monotonic_us();
+    wctx->fork_generation = wrapper_fork_generation();
+    if (randomize) {
+        int res = wrapper_context_randomize(wctx->ctx);
+        if (res != 0) {
+            wrapper_ctx_close(wctx);
+            return res;
+        }
+    }
+    return 0;
+}
+
+int wrapper_ctx_open(secp256k1_wrapper_ctx* wctx, int randomize) {
+    wctx->preallocated = 0;
+    wctx->ctx = secp256k1_context_create(SECP256K1_CONTEXT_SIGN);
+    if (!wctx->ctx) {
+        return -2; // Context creation failed
+    }
+    return wrapper_ctx_setup(wctx, randomize);
+}
+
+int wrapper_ctx_open_preallocated(secp256k1_wrapper_ctx* wctx, void* mem, int randomize) {
+    wctx->preallocated = 1;
+    wctx->ctx = secp256k1_context_preallocated_create(mem, SECP256K1_CONTEXT_SIGN);
+    if (!wctx->ctx) {
+        return -2; // Context creation failed
+    }
+    return wrapper_ctx_setup(wctx, randomize);
+}
+
+void wrapper_ctx_close(secp256k1_wrapper_ctx* wctx) {
+    if (wctx->ctx) {
+        if (wctx->preallocated) {
+            secp256k1_context_preallocated_destroy(wctx->ctx);
+        } else {
+            secp256k1_context_destroy(wctx->ctx);
+        }
+        wctx->ctx = NULL;
+    }
+}
+
+secp256k1_wrapper_ctx* secp256k1_wrapper_ctx_create(void) {
+    secp256k1_wrapper_ctx* wctx = (secp256k1_wrapper_ctx*)malloc(sizeof(*wctx));
+    if (!wctx) {
+        return NULL;
+    }
+    if (wrapper_ctx_open(wctx, 1) != 0) {
+        free(wctx);
+        return NULL;
+    }
+    return wctx;
+}
+
+void secp256k1_wrapper_ctx_destroy(secp256k1_wrapper_ctx* ctx) {
+    if (ctx == NULL) {
+        return;
+    }
+    wrapper_ctx_close(ctx);
+    free(ctx);
+}
+
+int secp256k1_wrapper_ctx_rerandomize(secp256k1_wrapper_ctx* ctx) {
+    if (ctx == NULL || ctx->ctx == NULL) {
+        return -1; // Invalid input
+    }
+    return wrapper_ctx_rerandomize(ctx);
+}
+
+int secp256k1_wrapper_generate_keys_ctx(secp256k1_wrapper_ctx* ctx, unsigned char* privkey_out, unsigned char* pubkey_out, int compressed) {
+
+    if (ctx == NULL || ctx->ctx == NULL || privkey_out == NULL || pubkey_out == NULL || (compressed != 0 && compressed != 1)) {
+        return -1; // Invalid input
+    }
+
+    size_t pubkey_len = compressed ? PUBKEY_COMPRESSION_SIZE : PUBKEY_UNCOMPRESSION_SIZE;
+    int flags = compressed ? SECP256K1_EC_COMPRESSED : SECP256K1_EC_UNCOMPRESSED;
+
+    int res = wrapper_ctx_begin_op(ctx);
+    if (res != 0) {
+        return res;
     }
-    
-    // Clear randomization data after use 
-    secure_memzero(randomize, sizeof(randomize)); 
 
     // Generate private key
     unsigned char privkey[PRIVKEY_SIZE];
     do {
         if (!secp256k1_wrapper_fill_random(privkey, sizeof(privkey))) {
-            secp256k1_context_destroy(ctx);
             return -3;  // Random number generation failed
         }
-    } while (!secp256k1_ec_seckey_verify(ctx, privkey));
+    } while (!secp256k1_ec_seckey_verify(ctx->ctx, privkey));
 
     // Create public key
     secp256k1_pubkey pubkey;
-    if (!secp256k1_ec_pubkey_create(ctx, &pubkey, privkey)) {
+    if (!secp256k1_ec_pubkey_create(ctx->ctx, &pubkey, privkey)) {
         secure_memzero(privkey, sizeof(privkey));
-        secp256k1_context_destroy(ctx);
         return -5; // Public key creation failed
     }
 
     // Serialize public key in compressed or uncompresed format
     // on success write to the pubkey_out
-    if (!secp256k1_ec_pubkey_serialize(ctx, pubkey_out, &pubkey_len, &pubkey, flags)) {
-        secure_memzero(privkey, sizeof(privkey)); 
-        secp256k1_context_destroy(ctx);
+    if (!secp256k1_ec_pubkey_serialize(ctx->ctx, pubkey_out, &pubkey_len, &pubkey, flags)) {
+        secure_memzero(privkey, sizeof(privkey));
         return -5; // Public key serialization failed
     }
-    
+
     // Safe since both are 32 bytes
-    memcpy(privkey_out, privkey, sizeof(privkey)); 
-    
+    memcpy(privkey_out, privkey, sizeof(privkey));
+
     // Clean up on a way out
-    secure_memzero(privkey, sizeof(privkey)); 
-    secp256k1_context_destroy(ctx);
+    secure_memzero(privkey, sizeof(privkey));
     return 0;
 }
 
+int secp256k1_wrapper_derive_pubkey_ctx(secp256k1_wrapper_ctx* ctx, const unsigned char* privkey, unsigned char* pubkey_out, int compressed) {
 
-int secp256k1_wrapper_derive_pubkey(const unsigned char* privkey, unsigned char* pubkey_out, int compressed) {
-
-    if (privkey == NULL || pubkey_out == NULL || (compressed != 0 && compressed != 1)) {
+    if (ctx == NULL || ctx->ctx == NULL || privkey == NULL || pubkey_out == NULL || (compressed != 0 && compressed != 1)) {
         return -1; // Invalid input
     }
 
@@ -168,88 +286,217 @@ int secp256k1_wrapper_derive_pubkey(const unsigned char* privkey, unsigned char*
     size_t pubkey_len = compressed ? PUBKEY_COMPRESSION_SIZE : PUBKEY_UNCOMPRESSION_SIZE;
     int flags = compressed ? SECP256K1_EC_COMPRESSED : SECP256K1_EC_UNCOMPRESSED;
 
-    secp256k1_context* ctx = secp256k1_context_create(SECP256K1_CONTEXT_SIGN);
-     if (!ctx) {
-        return -2; // Context creation failed
+    int res = wrapper_ctx_begin_op(ctx);
+    if (res != 0) {
+        return res;
     }
 
-    if (!secp256k1_ec_seckey_verify(ctx, privkey)) {
-        secp256k1_context_destroy(ctx);
+    if (!secp256k1_ec_seckey_verify(ctx->ctx, privkey)) {
         return -5; // Private key verification failed
     }
 
     secp256k1_pubkey pubkey;
-    if (!secp256k1_ec_pubkey_create(ctx, &pubkey, privkey)) {
-        secp256k1_context_destroy(ctx);
+    if (!secp256k1_ec_pubkey_create(ctx->ctx, &pubkey, privkey)) {
         return -5; // Public key creation failed
     }
 
-    if (!secp256k1_ec_pubkey_serialize(ctx, pubkey_out, &pubkey_len, &pubkey, flags)) {
-        secp256k1_context_destroy(ctx);
+    if (!secp256k1_ec_pubkey_serialize(ctx->ctx, pubkey_out, &pubkey_len, &pubkey, flags)) {
         return -5; // Public key serialization failed
     }
 
-    secp256k1_context_destroy(ctx);
     return 0;
 }
 
-/* Returns 1 on success, and 0 on failure. */
-int secp256k1_wrapper_fill_random(unsigned char* data, size_t size) {
+/* ---------- Per-thread state ---------- */
+
+static volatile int g_thread_cache_enabled = SECP256K1_WRAPPER_THREAD_CACHE_DEFAULT;
+
+static void wrapper_thread_state_free(void* p) {
+    wrapper_thread_state* st = (wrapper_thread_state*)p;
+    if (st == NULL) {
+        return;
+    }
+    wrapper_ctx_close(&st->ctx);
+    wrapper_rng_thread_free(st);
+    free(st);
+}
+
 #if defined(_WIN32)
 
-    if (size > ULONG_MAX) return 0;
-    NTSTATUS res = BCryptGenRandom(NULL, data, (ULONG)size, BCRYPT_USE_SYSTEM_PREFERRED_RNG);
-    return res == STATUS_SUCCESS;
+/* Fiber-local storage is the only Win32 TLS flavour with an exit callback */
+static INIT_ONCE g_tls_once = INIT_ONCE_STATIC_INIT;
+static DWORD g_tls_key = FLS_OUT_OF_INDEXES;
 
-#elif defined(__linux__) || defined(__FreeBSD__)
+static VOID NTAPI wrapper_thread_state_fls_free(PVOID p) {
+    wrapper_thread_state_free(p);
+}
 
-    ssize_t res = getrandom(data, size, 0);
-    if (res == -1 && errno == ENOSYS) {
-        int fd = open("/dev/urandom", O_RDONLY);
-        if (fd < 0) {
-            return 0;
-        }
-        size_t off = 0;
-        while (off < size) {
-            ssize_t r = read(fd, data + off, size - off);
-            if (r <= 0) {
-                close(fd);
-                return 0;
-            }
-            off += (size_t)r;
-        }
-        close(fd);
-        return 1;
+static BOOL CALLBACK wrapper_tls_init(PINIT_ONCE once, PVOID param, PVOID* context) {
+    (void)once; (void)param; (void)context;
+    g_tls_key = FlsAlloc(wrapper_thread_state_fls_free);
+    return TRUE;
+}
+
+static int wrapper_tls_ready(void) {
+    InitOnceExecuteOnce(&g_tls_once, wrapper_tls_init, NULL, NULL);
+    return g_tls_key != FLS_OUT_OF_INDEXES;
+}
+
+static wrapper_thread_state* wrapper_tls_get(void) {
+    return (wrapper_thread_state*)FlsGetValue(g_tls_key);
+}
+
+static int wrapper_tls_set(wrapper_thread_state* st) {
+    return FlsSetValue(g_tls_key, st) ? 1 : 0;
+}
+
+#else
+
+static pthread_once_t g_tls_once = PTHREAD_ONCE_INIT;
+static pthread_key_t g_tls_key;
+static int g_tls_ok = 0;
+
+static void wrapper_tls_init(void) {
+    g_tls_ok = (pthread_key_create(&g_tls_key, wrapper_thread_state_free) == 0);
+}
+
+static int wrapper_tls_ready(void) {
+    return pthread_once(&g_tls_once, wrapper_tls_init) == 0 && g_tls_ok;
+}
+
+static wrapper_thread_state* wrapper_tls_get(void) {
+    return (wrapper_thread_state*)pthread_getspecific(g_tls_key);
+}
+
+static int wrapper_tls_set(wrapper_thread_state* st) {
+    return pthread_setspecific(g_tls_key, st) == 0;
+}
+
+#endif
+
+wrapper_thread_state* wrapper_thread_state_peek(void) {
+    return wrapper_tls_ready() ? wrapper_tls_get() : NULL;
+}
+
+wrapper_thread_state* wrapper_thread_state_get(void) {
+    if (!wrapper_tls_ready()) {
+        return NULL;
+    }
+    wrapper_thread_state* st = wrapper_tls_get();
+    if (st != NULL) {
+        return st;
+    }
+    st = (wrapper_thread_state*)calloc(1, sizeof(*st));
+    if (st == NULL) {
+        return NULL;
     }
-    return (res >= 0 && (size_t)res == size) ? 1 : 0;
+    if (!wrapper_tls_set(st)) {
+        free(st);
+        return NULL;
+    }
+    return st;
+}
 
-#elif defined(__APPLE__)
+/* Returns the calling thread's cached context, creating and randomizing it
+ * lazily. Returns NULL if it could not be set up; callers then fall back to
+ * a one-shot context. */
+static secp256k1_wrapper_ctx* wrapper_thread_ctx(void) {
+    wrapper_thread_state* st = wrapper_thread_state_get();
+    if (st == NULL) {
+        return NULL;
+    }
+    if (st->ctx.ctx == NULL && wrapper_ctx_open(&st->ctx, 1) != 0) {
+        return NULL;
+    }
+    return &st->ctx;
+}
+
+void secp256k1_wrapper_thread_cache_enable(int enable) {
+    wrapper_atomic_store_int(&g_thread_cache_enabled, enable ? 1 : 0);
+}
+
+int secp256k1_wrapper_thread_cache_enabled(void) {
+    return wrapper_atomic_load_int(&g_thread_cache_enabled);
+}
+
+void secp256k1_wrapper_thread_cache_release(void) {
+    if (!wrapper_tls_ready()) {
+        return;
+    }
+    wrapper_thread_state* st = wrapper_tls_get();
+    if (st != NULL) {
+        wrapper_ctx_close(&st->ctx);
+    }
+}
+
+/* ---------- Context selection for the one-shot API ---------- */
 
-    #if defined(USE_SECURITY_RNG)
-        if (SecRandomCopyBytes(kSecRandomDefault, size, data) == errSecSuccess) return 1;
-    #endif
+int wrapper_lease_acquire(wrapper_ctx_lease* lease, int randomize) {
+    lease->pooled = 0;
+    lease->local.ctx = NULL;
 
-    // Try CCRandomGenerateBytes (macOS 10.7+)
-    if (CCRandomGenerateBytes(data, size) == kCCSuccess) {
-        return 1;
+    lease->ctx = wrapper_ctx_pool_acquire();
+    if (lease->ctx != NULL) {
+        lease->pooled = 1;
+        return 0;
     }
-    // Try getentropy (macOS 10.12+), limited to 256 bytes
-    #if defined(__MAC_10_12)
-    if (size <= 256 && getentropy(data, size) == 0) {
-        return 1;
+
+    if (secp256k1_wrapper_thread_cache_enabled()) {
+        lease->ctx = wrapper_thread_ctx();
+        if (lease->ctx != NULL) {
+            return 0;
+        }
     }
-    #endif
-   return 0;
 
-#elif defined(__OpenBSD__)
-    // getentropy() on OpenBSD is limited to 256 bytes per call
-    if (size <= 256 && getentropy(data, size) == 0) {
-        return 1;
+    int res = wrapper_ctx_open(&lease->local, randomize);
+    if (res != 0) {
+        return res;
     }
+    lease->ctx = &lease->local;
     return 0;
+}
 
-#else
-    #error "Couldn't identify the OS"
-#endif
+void wrapper_lease_release(wrapper_ctx_lease* lease) {
+    if (lease->pooled) {
+        wrapper_ctx_pool_release(lease->ctx);
+    } else {
+        wrapper_ctx_close(&lease->local);
+    }
+}
+
+// Function that generates and returns both private and public keys
+int secp256k1_wrapper_generate_keys(unsigned char* privkey_out, unsigned char* pubkey_out, int compressed) {
+
+    if (privkey_out == NULL || pubkey_out == NULL || (compressed != 0 && compressed != 1)) {
+        return -1; // Invalid input
+    }
+
+    wrapper_ctx_lease lease;
+    int res = wrapper_lease_acquire(&lease, 1);
+    if (res != 0) {
+        return res;
+    }
+
+    res = secp256k1_wrapper_generate_keys_ctx(lease.ctx, privkey_out, pubkey_out, compressed);
+    wrapper_lease_release(&lease);
+    return res;
 }
 
+
+int secp256k1_wrapper_derive_pubkey(const unsigned char* privkey, unsigned char* pubkey_out, int compressed) {
+
+    if (privkey == NULL || pubkey_out == NULL || (compressed != 0 && compressed != 1)) {
+        return -1; // Invalid input
+    }
+
+    // Derivation never used a randomized context, keep it that way for the one-shot path
+    wrapper_ctx_lease lease;
+    int res = wrapper_lease_acquire(&lease, 0);
+    if (res != 0) {
+        return res;
+    }
+
+    res = secp256k1_wrapper_derive_pubkey_ctx(lease.ctx, privkey, pubkey_out, compressed);
+    wrapper_lease_release(&lease);
+    return res;
+}
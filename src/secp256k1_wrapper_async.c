@@ -0,0 +1,567 @@
+/*
+ * secp256k1_wrapper - convenience wrapper around libsecp256k1
+ *
+ * Copyright (c) 2025 xXLegionBinFrogXx
+ *
+ * This file is licensed under the MIT License.
+ * See the LICENSE file in the project root for details.
+ *
+ * This project incorporates code from libsecp256k1,
+ * copyright (c) 2013 Bitcoin Core Developers, MIT License.
+ */
+
+/*
+ * Asynchronous request service.
+ *
+ * Callers push request pointers onto a bounded lock-free MPMC queue (Vyukov's
+ * array queue: every cell carries a sequence number telling producers and
+ * consumers whose turn it is, so both ends need one CAS and no lock).
+ * Service threads, each with its own randomized context, pop up to
+ * ASYNC_COALESCE requests at a time and run them as a group: the small key
+ * generation requests of a group share a single RNG request for their
+ * private keys, and the small sign requests another for their nonce
+ * entropy. Sign requests run on the service thread's context, verify
+ * requests on the shared verify runner.
+ *
+ * A finished request either has its callback run on the service thread, or
+ * goes onto a second MPMC queue that the caller drains with reap(), in which
+ * case a notification fd (an eventfd on Linux, a pipe elsewhere) is made
+ * readable for the caller's event loop. The number of outstanding requests,
+ * unreaped ones included, is capped at the queue size, so neither queue can
+ * overflow; a push only ever waits for a cell that a consumer has claimed
+ * but not yet handed back.
+ */
+
+#include "secp256k1_wrapper_internal.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__linux__)
+  #include <sys/eventfd.h>
+  #include <unistd.h>
+#elif !defined(_WIN32)
+  #include <fcntl.h>
+  #include <unistd.h>
+#endif
+
+#define ASYNC_MAX_THREADS  1024
+#define ASYNC_MAX_QUEUE    (1u << 20)
+#define ASYNC_COALESCE     32   // requests popped per round
+#define ASYNC_SHARED_KEYS  256  // generated keys per shared RNG request
+#define ASYNC_SHARED_SIGS  64   // signatures per shared nonce entropy request
+
+/* Every op's arguments must fit the reserved words, or the request's size
+ * (and with it the ABI) would change */
+typedef char async_args_fit[sizeof(((secp256k1_wrapper_async_req*)0)->args) == 8 * sizeof(void*) ? 1 : -1];
+
+/* ---------- MPMC queue ---------- */
+
+typedef struct mpmc_cell {
+    volatile uint64_t seq;
+    void* volatile data;
+} mpmc_cell;
+
+typedef struct mpmc_queue {
+    mpmc_cell* cells;
+    uint64_t mask;
+    unsigned char pad0[64];
+    volatile uint64_t enqueue_pos;
+    unsigned char pad1[64];
+    volatile uint64_t dequeue_pos;
+    unsigned char pad2[64];
+} mpmc_queue;
+
+static int mpmc_init(mpmc_queue* q, size_t size) {
+    q->cells = (mpmc_cell*)calloc(size, sizeof(mpmc_cell));
+    if (q->cells == NULL) {
+        return 0;
+    }
+    for (size_t i = 0; i < size; i++) {
+        q->cells[i].seq = i;
+    }
+    q->mask = size - 1;
+    q->enqueue_pos = 0;
+    q->dequeue_pos = 0;
+    return 1;
+}
+
+/* Returns 0 if the queue is full */
+static int mpmc_push(mpmc_queue* q, void* data) {
+    uint64_t pos = wrapper_atomic_load_u64(&q->enqueue_pos);
+    mpmc_cell* cell;
+    for (;;) {
+        cell = &q->cells[pos & q->mask];
+        int64_t diff = (int64_t)(wrapper_atomic_load_u64(&cell->seq) - pos);
+        if (diff == 0) {
+            if (wrapper_atomic_cas_u64(&q->enqueue_pos, &pos, pos + 1)) {
+                break;
+            }
+        } else if (diff < 0) {
+            return 0;
+        } else {
+            pos = wrapper_atomic_load_u64(&q->enqueue_pos);
+        }
+    }
+    wrapper_atomic_store_ptr(&cell->data, data);
+    wrapper_atomic_store_u64(&cell->seq, pos + 1);
+    return 1;
+}
+
+/* Push for callers whose outstanding count proves a cell is free. The next
+ * cell may still be claimed by a consumer that won dequeue_pos and has not
+ * stored its sequence number yet; that cell is only in flight, so wait for
+ * it rather than fail. */
+static void mpmc_push_reserved(mpmc_queue* q, void* data) {
+    while (!mpmc_push(q, data)) {
+        wrapper_thread_yield();
+    }
+}
+
+/* Returns NULL if the queue is empty */
+static void* mpmc_pop(mpmc_queue* q) {
+    uint64_t pos = wrapper_atomic_load_u64(&q->dequeue_pos);
+    mpmc_cell* cell;
+    for (;;) {
+        cell = &q->cells[pos & q->mask];
+        int64_t diff = (int64_t)(wrapper_atomic_load_u64(&cell->seq) - (pos + 1));
+        if (diff == 0) {
+            if (wrapper_atomic_cas_u64(&q->dequeue_pos, &pos, pos + 1)) {
+                break;
+            }
+        } else if (diff < 0) {
+            return NULL;
+        } else {
+            pos = wrapper_atomic_load_u64(&q->dequeue_pos);
+        }
+    }
+    void* data = wrapper_atomic_load_ptr(&cell->data);
+    wrapper_atomic_store_u64(&cell->seq, pos + q->mask + 1);
+    return data;
+}
+
+/* ---------- Service ---------- */
+
+struct async_service;
+
+typedef struct async_worker {
+    struct async_service* svc;
+    secp256k1_wrapper_ctx ctx;
+    wrapper_thread thread;
+    unsigned char entropy[ASYNC_SHARED_KEYS * PRIVKEY_SIZE];
+    unsigned char nonces[ASYNC_SHARED_SIGS * 32];
+} async_worker;
+
+typedef struct async_service {
+    mpmc_queue submitted;
+    mpmc_queue completed;
+    size_t capacity;
+    volatile uint64_t outstanding;  // submitted and not yet called back or reaped
+    volatile uint64_t sleepers;     // workers waiting on wake_cv
+    wrapper_mutex lock;             // guards shutdown, pairs with wake_cv
+    wrapper_cond wake_cv;
+    int shutdown;
+    int notify_fd;                  // read end handed to the caller, -1 if none
+    int notify_write_fd;
+    size_t threads;
+    async_worker* workers;
+    uint32_t fork_generation;       // service threads do not survive fork()
+} async_service;
+
+static void* volatile g_async = NULL;
+
+/* ---------- Notification fd ---------- */
+
+static int async_notify_open(async_service* svc) {
+    svc->notify_fd = svc->notify_write_fd = -1;
+#if defined(__linux__)
+    svc->notify_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    svc->notify_write_fd = svc->notify_fd;
+    return svc->notify_fd >= 0;
+#elif !defined(_WIN32)
+    int fds[2];
+    if (pipe(fds) != 0) {
+        return 0;
+    }
+    for (int i = 0; i < 2; i++) {
+        (void)fcntl(fds[i], F_SETFL, fcntl(fds[i], F_GETFL) | O_NONBLOCK);
+        (void)fcntl(fds[i], F_SETFD, FD_CLOEXEC);
+    }
+    svc->notify_fd = fds[0];
+    svc->notify_write_fd = fds[1];
+    return 1;
+#else
+    (void)svc;
+    return 1; // No fd on Windows: callbacks or polling reap()
+#endif
+}
+
+static void async_notify_close(async_service* svc) {
+#if !defined(_WIN32)
+    if (svc->notify_write_fd >= 0 && svc->notify_write_fd != svc->notify_fd) {
+        close(svc->notify_write_fd);
+    }
+    if (svc->notify_fd >= 0) {
+        close(svc->notify_fd);
+    }
+#else
+    (void)svc;
+#endif
+}
+
+/* A full pipe or a saturated eventfd is already readable, so failed writes
+ * need no retry */
+static void async_notify(async_service* svc) {
+#if defined(__linux__)
+    uint64_t one = 1;
+    ssize_t res = write(svc->notify_write_fd, &one, sizeof(one));
+    (void)res;
+#elif !defined(_WIN32)
+    unsigned char one = 1;
+    ssize_t res = write(svc->notify_write_fd, &one, sizeof(one));
+    (void)res;
+#else
+    (void)svc;
+#endif
+}
+
+static void async_notify_clear(async_service* svc) {
+#if defined(__linux__)
+    uint64_t value;
+    ssize_t res = read(svc->notify_fd, &value, sizeof(value));
+    (void)res;
+#elif !defined(_WIN32)
+    unsigned char buf[64];
+    while (read(svc->notify_fd, buf, sizeof(buf)) > 0) {
+    }
+#else
+    (void)svc;
+#endif
+}
+
+/* ---------- Request processing ---------- */
+
+static void async_complete(async_service* svc, secp256k1_wrapper_async_req* req, int res) {
+    req->result = res;
+    if (req->callback != NULL) {
+        // Released first, so the callback may resubmit
+        wrapper_atomic_fetch_sub_u64(&svc->outstanding, 1);
+        req->callback(req);
+        return;
+    }
+    mpmc_push_reserved(&svc->completed, req);  // counted in outstanding until reaped
+    async_notify(svc);
+}
+
+static int async_derive(secp256k1_wrapper_ctx* wctx, secp256k1_wrapper_async_req* req) {
+    size_t pubkey_size = req->compressed ? PUBKEY_COMPRESSION_SIZE : PUBKEY_UNCOMPRESSION_SIZE;
+    if (req->results != NULL) {
+        return wrapper_derive_pubkey_batch(wctx, req->privkeys, req->pubkeys_out, req->n, req->compressed,
+                                           req->results);
+    }
+    // No per-item codes wanted: run in slices over a scratch array
+    int scratch[64];
+    int first_error = 0;
+    for (size_t i = 0; i < req->n; i += 64) {
+        size_t count = req->n - i < 64 ? req->n - i : 64;
+        int res = wrapper_derive_pubkey_batch(wctx, req->privkeys + i * PRIVKEY_SIZE, req->pubkeys_out + i * pubkey_size,
+                                              count, req->compressed, scratch);
+        if (first_error == 0) {
+            first_error = res;
+        }
+    }
+    return first_error;
+}
+
+static int async_sign(secp256k1_wrapper_ctx* wctx, secp256k1_wrapper_async_req* req) {
+    const struct secp256k1_wrapper_async_sign_args* sign = &req->args.sign;
+    size_t slot = sign->format == SECP256K1_WRAPPER_SIG_COMPACT ? SECP256K1_WRAPPER_SIG_COMPACT_SIZE
+                                                                : SECP256K1_WRAPPER_SIG_DER_MAX_SIZE;
+    if (req->results != NULL) {
+        return wrapper_sign_batch(wctx, req->privkeys, sign->hashes, req->n, sign->sigs_out, sign->sig_lens,
+                                  sign->format, req->results);
+    }
+    int scratch[64];
+    int first_error = 0;
+    for (size_t i = 0; i < req->n; i += 64) {
+        size_t count = req->n - i < 64 ? req->n - i : 64;
+        int res = wrapper_sign_batch(wctx, req->privkeys + i * PRIVKEY_SIZE, sign->hashes + i * 32, count,
+                                     sign->sigs_out + i * slot, sign->sig_lens != NULL ? sign->sig_lens + i : NULL,
+                                     sign->format, scratch);
+        if (first_error == 0) {
+            first_error = res;
+        }
+    }
+    return first_error;
+}
+
+/* Sign request whose nonce entropy was drawn for the whole group; `ndata`
+ * is NULL if that draw failed */
+static int async_sign_shared(secp256k1_wrapper_ctx* wctx, secp256k1_wrapper_async_req* req,
+                             const unsigned char* ndata) {
+    const struct secp256k1_wrapper_async_sign_args* sign = &req->args.sign;
+    int scratch[ASYNC_SHARED_SIGS];
+    return wrapper_sign_batch_entropy(wctx, req->privkeys, sign->hashes, req->n, sign->sigs_out, sign->sig_lens,
+                                      sign->format, ndata, req->results != NULL ? req->results : scratch);
+}
+
+static int async_verify(const secp256k1_wrapper_async_req* req) {
+    const struct secp256k1_wrapper_async_verify_args* verify = &req->args.verify;
+    return wrapper_verify_run(req->n, wrapper_verify_check(verify->format), verify->items,
+                              verify->mode == SECP256K1_WRAPPER_VERIFY_EARLY_EXIT, verify->valid_bitmap);
+}
+
+/* Runs a group of popped requests. Key generation requests that fit are
+ * served from one shared RNG draw, split among them in order, and so are
+ * the nonces of the sign requests that fit. */
+static void async_run_group(async_worker* w, secp256k1_wrapper_async_req** reqs, size_t count) {
+    int shared[ASYNC_COALESCE];
+    size_t keys = 0;
+    size_t sigs = 0;
+    for (size_t i = 0; i < count; i++) {
+        shared[i] = 0;
+        if (reqs[i]->op == SECP256K1_WRAPPER_ASYNC_GENERATE && reqs[i]->n <= ASYNC_SHARED_KEYS - keys) {
+            shared[i] = 1;
+            keys += reqs[i]->n;
+        } else if (reqs[i]->op == SECP256K1_WRAPPER_ASYNC_SIGN && reqs[i]->n <= ASYNC_SHARED_SIGS - sigs) {
+            shared[i] = 1;
+            sigs += reqs[i]->n;
+        }
+    }
+    int drawn = keys == 0 || wrapper_batch_draw_privkeys(w->ctx.ctx, w->entropy, keys);
+    int nonces_drawn = sigs == 0 || secp256k1_wrapper_fill_random(w->nonces, sigs * 32);
+
+    size_t offset = 0;
+    size_t nonce_offset = 0;
+    for (size_t i = 0; i < count; i++) {
+        secp256k1_wrapper_async_req* req = reqs[i];
+        int res;
+        if (req->op == SECP256K1_WRAPPER_ASYNC_DERIVE) {
+            res = async_derive(&w->ctx, req);
+        } else if (req->op == SECP256K1_WRAPPER_ASYNC_SIGN && shared[i]) {
+            res = async_sign_shared(&w->ctx, req, nonces_drawn ? w->nonces + nonce_offset * 32 : NULL);
+            nonce_offset += req->n;
+        } else if (req->op == SECP256K1_WRAPPER_ASYNC_SIGN) {
+            res = async_sign(&w->ctx, req);
+        } else if (req->op == SECP256K1_WRAPPER_ASYNC_VERIFY) {
+            res = async_verify(req);
+        } else if (!shared[i]) {
+            res = wrapper_generate_keys_batch(&w->ctx, req->privkeys, req->pubkeys_out, req->n, req->compressed,
+                                              SECP256K1_WRAPPER_BATCH_ALL_OR_NOTHING, NULL);
+        } else if (!drawn) {
+            secure_memzero(req->privkeys, req->n * PRIVKEY_SIZE);
+            res = -3; // Random number generation failed
+        } else {
+            memcpy(req->privkeys, w->entropy + offset * PRIVKEY_SIZE, req->n * PRIVKEY_SIZE);
+            offset += req->n;
+            res = wrapper_batch_pubkeys(&w->ctx, req->privkeys, req->pubkeys_out, req->n, req->compressed,
+                                        SECP256K1_WRAPPER_BATCH_ALL_OR_NOTHING, NULL);
+        }
+        async_complete(w->svc, req, res);
+    }
+    secure_memzero(w->entropy, keys * PRIVKEY_SIZE);
+    secure_memzero(w->nonces, sigs * 32);
+}
+
+static wrapper_thread_ret WRAPPER_THREAD_CALL async_worker_main(void* arg) {
+    async_worker* w = (async_worker*)arg;
+    async_service* svc = w->svc;
+    secp256k1_wrapper_async_req* reqs[ASYNC_COALESCE];
+
+    for (;;) {
+        size_t count = 0;
+        while (count < ASYNC_COALESCE && (reqs[count] = (secp256k1_wrapper_async_req*)mpmc_pop(&svc->submitted)) != NULL) {
+            count++;
+        }
+        if (count > 0) {
+            async_run_group(w, reqs, count);
+            continue;
+        }
+
+        /* Announce the sleep, then look again: a submitter either sees the
+         * announcement and signals, or its request is seen here */
+        wrapper_mutex_lock(&svc->lock);
+        wrapper_atomic_store_u64(&svc->sleepers, wrapper_atomic_load_u64(&svc->sleepers) + 1);
+        wrapper_atomic_fence();
+        secp256k1_wrapper_async_req* req = (secp256k1_wrapper_async_req*)mpmc_pop(&svc->submitted);
+        if (req == NULL && !svc->shutdown) {
+            wrapper_cond_wait(&svc->wake_cv, &svc->lock);
+        }
+        wrapper_atomic_store_u64(&svc->sleepers, wrapper_atomic_load_u64(&svc->sleepers) - 1);
+        int stop = svc->shutdown && req == NULL;
+        wrapper_mutex_unlock(&svc->lock);
+
+        if (req != NULL) {
+            async_run_group(w, &req, 1);
+        } else if (stop) {
+            // Drain whatever is left before leaving
+            while ((req = (secp256k1_wrapper_async_req*)mpmc_pop(&svc->submitted)) != NULL) {
+                async_run_group(w, &req, 1);
+            }
+            break;
+        }
+    }
+    return 0;
+}
+
+/* ---------- Public API ---------- */
+
+/* Stops and joins the first `started` workers, then frees everything */
+static void async_service_free(async_service* svc, size_t started) {
+    wrapper_mutex_lock(&svc->lock);
+    svc->shutdown = 1;
+    wrapper_cond_broadcast(&svc->wake_cv);
+    wrapper_mutex_unlock(&svc->lock);
+
+    for (size_t i = 0; i < started; i++) {
+        wrapper_thread_join(svc->workers[i].thread);
+    }
+    for (size_t i = 0; i < svc->threads; i++) {
+        wrapper_ctx_close(&svc->workers[i].ctx);
+    }
+    async_notify_close(svc);
+    wrapper_cond_destroy(&svc->wake_cv);
+    wrapper_mutex_destroy(&svc->lock);
+    free(svc->submitted.cells);
+    free(svc->completed.cells);
+    free(svc->workers);
+    free(svc);
+}
+
+int secp256k1_wrapper_async_init(size_t threads, size_t queue_size) {
+    if (threads == 0 || threads > ASYNC_MAX_THREADS || queue_size == 0 || queue_size > ASYNC_MAX_QUEUE ||
+        wrapper_atomic_load_ptr(&g_async) != NULL) {
+        return -1; // Invalid input or already running
+    }
+    size_t capacity = 1;
+    while (capacity < queue_size) {
+        capacity <<= 1;
+    }
+
+    async_service* svc = (async_service*)calloc(1, sizeof(*svc));
+    if (svc == NULL) {
+        return -2;
+    }
+    wrapper_mutex_init(&svc->lock);
+    wrapper_cond_init(&svc->wake_cv);
+    svc->notify_fd = svc->notify_write_fd = -1;
+    svc->capacity = queue_size;
+    svc->workers = (async_worker*)calloc(threads, sizeof(async_worker));
+    if (svc->workers == NULL || !mpmc_init(&svc->submitted, capacity) || !mpmc_init(&svc->completed, capacity) ||
+        !async_notify_open(svc)) {
+        async_service_free(svc, 0);
+        return -2;
+    }
+    svc->threads = threads;
+    svc->fork_generation = wrapper_fork_generation();
+
+    // Contexts first, so a failure leaves no threads to stop
+    for (size_t i = 0; i < threads; i++) {
+        svc->workers[i].svc = svc;
+        int res = wrapper_ctx_open(&svc->workers[i].ctx, 1);
+        if (res != 0) {
+            async_service_free(svc, 0);
+            return res;
+        }
+    }
+    for (size_t i = 0; i < threads; i++) {
+        if (!wrapper_thread_start(&svc->workers[i].thread, async_worker_main, &svc->workers[i])) {
+            async_service_free(svc, i);
+            return -2;
+        }
+    }
+    wrapper_atomic_store_ptr(&g_async, svc);
+    return 0;
+}
+
+/* Checks the fields the request's op uses, as its batch call would */
+static int async_req_valid(const secp256k1_wrapper_async_req* req) {
+    const struct secp256k1_wrapper_async_sign_args* sign = &req->args.sign;
+    const struct secp256k1_wrapper_async_verify_args* verify = &req->args.verify;
+    if (req->n == 0) {
+        return 0;
+    }
+    switch (req->op) {
+    case SECP256K1_WRAPPER_ASYNC_GENERATE:
+    case SECP256K1_WRAPPER_ASYNC_DERIVE:
+        return req->privkeys != NULL && req->pubkeys_out != NULL && (req->compressed == 0 || req->compressed == 1) &&
+               req->n <= SIZE_MAX / PUBKEY_UNCOMPRESSION_SIZE;
+    case SECP256K1_WRAPPER_ASYNC_SIGN:
+        return req->privkeys != NULL && sign->hashes != NULL && sign->sigs_out != NULL &&
+               (sign->format == SECP256K1_WRAPPER_SIG_COMPACT ||
+                (sign->format == SECP256K1_WRAPPER_SIG_DER && sign->sig_lens != NULL)) &&
+               req->n <= SIZE_MAX / SECP256K1_WRAPPER_SIG_DER_MAX_SIZE;
+    case SECP256K1_WRAPPER_ASYNC_VERIFY:
+        return verify->items != NULL &&
+               (verify->format == SECP256K1_WRAPPER_SIG_COMPACT || verify->format == SECP256K1_WRAPPER_SIG_DER) &&
+               (verify->mode == SECP256K1_WRAPPER_VERIFY_EARLY_EXIT ||
+                (verify->mode == SECP256K1_WRAPPER_VERIFY_ALL && verify->valid_bitmap != NULL));
+    default:
+        return 0;
+    }
+}
+
+int secp256k1_wrapper_async_submit(secp256k1_wrapper_async_req* req) {
+    if (req == NULL || !async_req_valid(req)) {
+        return -1; // Invalid input
+    }
+    async_service* svc = (async_service*)wrapper_atomic_load_ptr(&g_async);
+    if (svc == NULL || svc->fork_generation != wrapper_fork_generation()) {
+        return -6; // Not running (or this is a fork()ed child)
+    }
+
+    uint64_t outstanding = wrapper_atomic_load_u64(&svc->outstanding);
+    do {
+        if (outstanding >= svc->capacity) {
+            return -7; // Too many outstanding requests
+        }
+    } while (!wrapper_atomic_cas_u64(&svc->outstanding, &outstanding, outstanding + 1));
+
+    mpmc_push_reserved(&svc->submitted, req);  // slot reserved above
+
+    wrapper_atomic_fence();
+    if (wrapper_atomic_load_u64(&svc->sleepers) > 0) {
+        wrapper_mutex_lock(&svc->lock);
+        wrapper_cond_signal(&svc->wake_cv);
+        wrapper_mutex_unlock(&svc->lock);
+    }
+    return 0;
+}
+
+size_t secp256k1_wrapper_async_reap(secp256k1_wrapper_async_req** reqs_out, size_t max) {
+    async_service* svc = (async_service*)wrapper_atomic_load_ptr(&g_async);
+    if (svc == NULL || reqs_out == NULL) {
+        return 0;
+    }
+    if (svc->notify_fd >= 0) {
+        async_notify_clear(svc);  // before popping, so a later completion re-arms it
+    }
+    size_t count = 0;
+    while (count < max && (reqs_out[count] = (secp256k1_wrapper_async_req*)mpmc_pop(&svc->completed)) != NULL) {
+        count++;
+    }
+    if (count > 0) {
+        wrapper_atomic_fetch_sub_u64(&svc->outstanding, (uint64_t)count);
+    }
+    if (count == max && svc->notify_fd >= 0) {
+        async_notify(svc);  // more may be waiting, keep the fd readable
+    }
+    return count;
+}
+
+int secp256k1_wrapper_async_fd(void) {
+    async_service* svc = (async_service*)wrapper_atomic_load_ptr(&g_async);
+    return svc != NULL ? svc->notify_fd : -1;
+}
+
+void secp256k1_wrapper_async_shutdown(void) {
+    async_service* svc = (async_service*)wrapper_atomic_load_ptr(&g_async);
+    if (svc == NULL) {
+        return;
+    }
+    wrapper_atomic_store_ptr(&g_async, NULL);
+    if (svc->fork_generation != wrapper_fork_generation()) {
+        return; // Inherited across fork() without its threads; nothing to join, leak it
+    }
+    async_service_free(svc, svc->threads);
+}
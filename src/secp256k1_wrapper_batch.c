@@ -0,0 +1,622 @@
+/*
+ * secp256k1_wrapper - convenience wrapper around libsecp256k1
+ *
+ * Copyright (c) 2025 xXLegionBinFrogXx
+ *
+ * This file is licensed under the MIT License.
+ * See the LICENSE file in the project root for details.
+ *
+ * This project incorporates code from libsecp256k1,
+ * copyright (c) 2013 Bitcoin Core Developers, MIT License.
+ */
+
+/*
+ * Batch key operations. Keys are addressed through a view: a contiguous
+ * array, records at a fixed stride, or an array of pointers, so results land
+ * straight in the caller's structures. A whole batch shares one borrowed
+ * context, and key generation over contiguous private keys draws the entropy
+ * for the whole batch in a single request. Ranges of consecutive private keys
+ * step from one public key to the next by adding the generator. In parallel
+ * mode a batch is split into chunks that run on the worker pool, each chunk
+ * on its worker's own context.
+ *
+ * The streaming generator hands out the same kind of batches in caller-sized
+ * pieces. It keeps one context and a small entropy buffer across calls, so
+ * small pieces still share RNG requests without the whole batch in memory.
+ */
+
+#include "secp256k1_wrapper_internal.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/* Private keys' worth of entropy a generator buffers (8 KiB). Requests of
+ * at least this many keys draw straight into the caller's buffer. */
+#define KEYGEN_ENTROPY_KEYS 256
+
+struct secp256k1_wrapper_keygen {
+    secp256k1_wrapper_ctx wctx;
+    int compressed;
+    size_t avail;               // unused keys at the end of `entropy`
+    uint32_t fork_generation;   // buffered entropy must not survive fork()
+    unsigned char entropy[KEYGEN_ENTROPY_KEYS * PRIVKEY_SIZE];
+};
+
+/* Entropy staged per RNG request when a batch's private keys are not
+ * contiguous (2 KiB) */
+#define BATCH_STAGE_KEYS 64
+
+/* Where the keys of a batch live: key i is at base + i * stride, or at
+ * ptrs[i] for a scatter-gather array */
+typedef struct batch_view {
+    unsigned char* base;
+    size_t stride;
+    unsigned char* const* ptrs;
+} batch_view;
+
+/* Input views share the type; the batch code never writes through them */
+static batch_view batch_view_strided(const unsigned char* base, size_t stride) {
+    batch_view v = { (unsigned char*)base, stride, NULL };
+    return v;
+}
+
+static batch_view batch_view_ptrs(const unsigned char* const* ptrs) {
+    batch_view v = { NULL, 0, (unsigned char* const*)ptrs };
+    return v;
+}
+
+static WRAPPER_INLINE unsigned char* batch_at(const batch_view* v, size_t i) {
+    return v->ptrs != NULL ? v->ptrs[i] : v->base + i * v->stride;
+}
+
+/* The same view, starting at item `begin` */
+static batch_view batch_slice(batch_view v, size_t begin) {
+    if (v.ptrs != NULL) {
+        v.ptrs += begin;
+    } else {
+        v.base += begin * v.stride;
+    }
+    return v;
+}
+
+static void batch_wipe_privkeys(const batch_view* keys, size_t n) {
+    if (keys->ptrs == NULL && keys->stride == PRIVKEY_SIZE) {
+        secure_memzero(keys->base, n * PRIVKEY_SIZE);
+        return;
+    }
+    for (size_t i = 0; i < n; i++) {
+        secure_memzero(batch_at(keys, i), PRIVKEY_SIZE);
+    }
+}
+
+/* A 32-byte string is a valid private key iff it is non-zero and below the
+ * group order n = FFFFFFFF FFFFFFFF FFFFFFFF FFFFFFFE BAAEDCE6 ... . Any
+ * string whose leading 64 bits are not all ones is below n, so only the
+ * all-ones prefix (probability 2^-64) and zero need the full check. Works on
+ * whole words, endianness does not matter for either test. */
+static int batch_key_suspect(const unsigned char* key) {
+    uint64_t w[4];
+    memcpy(w, key, sizeof(w));
+    return w[0] == UINT64_MAX || (w[0] | w[1] | w[2] | w[3]) == 0;
+}
+
+/* Redraws the rare keys outside [1, n-1] in `n` random private keys.
+ * Returns 1 on success, and 0 if the RNG failed. */
+static int batch_screen_privkeys(const secp256k1_context* ctx, const batch_view* keys, size_t n) {
+    /* Branch-light screening pass over the whole batch first */
+    size_t suspects = 0;
+    for (size_t i = 0; i < n; i++) {
+        suspects += (size_t)batch_key_suspect(batch_at(keys, i));
+    }
+    if (suspects == 0) {
+        return 1;
+    }
+
+    for (size_t i = 0; i < n; i++) {
+        unsigned char* key = batch_at(keys, i);
+        if (!batch_key_suspect(key)) {
+            continue;
+        }
+        while (!secp256k1_ec_seckey_verify(ctx, key)) {
+            if (!secp256k1_wrapper_fill_random(key, PRIVKEY_SIZE)) {
+                return 0;
+            }
+        }
+    }
+    return 1;
+}
+
+/* Contiguous keys take the whole batch's entropy in one request; scattered
+ * ones are drawn a stage at a time and copied into place. */
+static int batch_draw_privkeys(const secp256k1_context* ctx, const batch_view* keys, size_t n) {
+    if (keys->ptrs == NULL && keys->stride == PRIVKEY_SIZE) {
+        if (!secp256k1_wrapper_fill_random(keys->base, n * PRIVKEY_SIZE)) {
+            return 0;
+        }
+        return batch_screen_privkeys(ctx, keys, n);
+    }
+
+    unsigned char stage[BATCH_STAGE_KEYS * PRIVKEY_SIZE];
+    int ok = 1;
+    for (size_t done = 0; ok && done < n;) {
+        size_t count = n - done < BATCH_STAGE_KEYS ? n - done : BATCH_STAGE_KEYS;
+        ok = secp256k1_wrapper_fill_random(stage, count * PRIVKEY_SIZE);
+        for (size_t i = 0; ok && i < count; i++) {
+            memcpy(batch_at(keys, done + i), stage + i * PRIVKEY_SIZE, PRIVKEY_SIZE);
+        }
+        done += count;
+    }
+    secure_memzero(stage, sizeof(stage));
+    return ok && batch_screen_privkeys(ctx, keys, n);
+}
+
+int wrapper_batch_draw_privkeys(const secp256k1_context* ctx, unsigned char* privkeys, size_t n) {
+    batch_view keys = batch_view_strided(privkeys, PRIVKEY_SIZE);
+    return batch_draw_privkeys(ctx, &keys, n);
+}
+
+/* Computes and serializes the public key of one valid private key.
+ * Returns 0 on success, -5 on failure. */
+static int batch_pubkey(const secp256k1_context* ctx, const unsigned char* privkey, unsigned char* pubkey_out, int compressed) {
+    size_t pubkey_len = compressed ? PUBKEY_COMPRESSION_SIZE : PUBKEY_UNCOMPRESSION_SIZE;
+    unsigned int flags = compressed ? SECP256K1_EC_COMPRESSED : SECP256K1_EC_UNCOMPRESSED;
+
+    secp256k1_pubkey pubkey;
+    if (!secp256k1_ec_pubkey_create(ctx, &pubkey, privkey)) {
+        return -5; // Public key creation failed
+    }
+    if (!secp256k1_ec_pubkey_serialize(ctx, pubkey_out, &pubkey_len, &pubkey, flags)) {
+        return -5; // Public key serialization failed
+    }
+    return 0;
+}
+
+static int batch_pubkeys(secp256k1_wrapper_ctx* wctx, const batch_view* privkeys, const batch_view* pubkeys,
+                         size_t n, int compressed, int flags, int* results) {
+    int per_item = flags == SECP256K1_WRAPPER_BATCH_PER_ITEM;
+    int first_error = 0;
+
+    for (size_t i = 0; i < n; i++) {
+        unsigned char* privkey = batch_at(privkeys, i);
+        int res = wrapper_ctx_begin_op(wctx);
+        if (res == 0) {
+            res = batch_pubkey(wctx->ctx, privkey, batch_at(pubkeys, i), compressed);
+        }
+        if (res != 0) {
+            if (!per_item) {
+                batch_wipe_privkeys(privkeys, n);
+                return res;
+            }
+            secure_memzero(privkey, PRIVKEY_SIZE);  // never hand out a key without its pubkey
+            if (first_error == 0) {
+                first_error = res;
+            }
+        }
+        if (per_item) {
+            results[i] = res;
+        }
+    }
+    return first_error;
+}
+
+int wrapper_batch_pubkeys(secp256k1_wrapper_ctx* wctx, unsigned char* privkeys_out, unsigned char* pubkeys_out,
+                          size_t n, int compressed, int flags, int* results) {
+    batch_view privkeys = batch_view_strided(privkeys_out, PRIVKEY_SIZE);
+    batch_view pubkeys = batch_view_strided(pubkeys_out, compressed ? PUBKEY_COMPRESSION_SIZE : PUBKEY_UNCOMPRESSION_SIZE);
+    return batch_pubkeys(wctx, &privkeys, &pubkeys, n, compressed, flags, results);
+}
+
+static int batch_generate_keys(secp256k1_wrapper_ctx* wctx, const batch_view* privkeys, const batch_view* pubkeys,
+                               size_t n, int compressed, int flags, int* results) {
+    if (!batch_draw_privkeys(wctx->ctx, privkeys, n)) {
+        batch_wipe_privkeys(privkeys, n);
+        for (size_t i = 0; flags == SECP256K1_WRAPPER_BATCH_PER_ITEM && i < n; i++) {
+            results[i] = -3;
+        }
+        return -3; // Random number generation failed
+    }
+    return batch_pubkeys(wctx, privkeys, pubkeys, n, compressed, flags, results);
+}
+
+int wrapper_generate_keys_batch(secp256k1_wrapper_ctx* wctx, unsigned char* privkeys_out, unsigned char* pubkeys_out,
+                                size_t n, int compressed, int flags, int* results) {
+    batch_view privkeys = batch_view_strided(privkeys_out, PRIVKEY_SIZE);
+    batch_view pubkeys = batch_view_strided(pubkeys_out, compressed ? PUBKEY_COMPRESSION_SIZE : PUBKEY_UNCOMPRESSION_SIZE);
+    return batch_generate_keys(wctx, &privkeys, &pubkeys, n, compressed, flags, results);
+}
+
+static int batch_derive_pubkeys(secp256k1_wrapper_ctx* wctx, const batch_view* privkeys, const batch_view* pubkeys,
+                                size_t n, int compressed, int* results) {
+    size_t pubkey_size = compressed ? PUBKEY_COMPRESSION_SIZE : PUBKEY_UNCOMPRESSION_SIZE;
+    int first_error = 0;
+
+    for (size_t i = 0; i < n; i++) {
+        unsigned char* pubkey_out = batch_at(pubkeys, i);
+        int res = wrapper_ctx_begin_op(wctx);
+        if (res == 0) {
+            // pubkey_create rejects zero and out-of-range keys, same as seckey_verify
+            res = batch_pubkey(wctx->ctx, batch_at(privkeys, i), pubkey_out, compressed);
+        }
+        if (res != 0) {
+            memset(pubkey_out, 0, pubkey_size);
+            if (first_error == 0) {
+                first_error = res;
+            }
+        }
+        results[i] = res;
+    }
+    return first_error;
+}
+
+int wrapper_derive_pubkey_batch(secp256k1_wrapper_ctx* wctx, const unsigned char* privkeys, unsigned char* pubkeys_out,
+                                size_t n, int compressed, int* results) {
+    batch_view in = batch_view_strided(privkeys, PRIVKEY_SIZE);
+    batch_view out = batch_view_strided(pubkeys_out, compressed ? PUBKEY_COMPRESSION_SIZE : PUBKEY_UNCOMPRESSION_SIZE);
+    return batch_derive_pubkeys(wctx, &in, &out, n, compressed, results);
+}
+
+/* ---------- Public batch calls ---------- */
+
+/* Arguments of a batch call, shared by every chunk of a parallel run */
+typedef struct batch_args {
+    batch_view privkeys;
+    batch_view pubkeys;
+    int compressed;
+    int flags;
+    int* results;
+} batch_args;
+
+static int batch_generate_range(void* arg, secp256k1_wrapper_ctx* wctx, size_t begin, size_t end) {
+    const batch_args* a = (const batch_args*)arg;
+    batch_view privkeys = batch_slice(a->privkeys, begin);
+    batch_view pubkeys = batch_slice(a->pubkeys, begin);
+    return batch_generate_keys(wctx, &privkeys, &pubkeys, end - begin, a->compressed, a->flags,
+                               a->results != NULL ? a->results + begin : NULL);
+}
+
+static int batch_derive_range(void* arg, secp256k1_wrapper_ctx* wctx, size_t begin, size_t end) {
+    const batch_args* a = (const batch_args*)arg;
+    batch_view privkeys = batch_slice(a->privkeys, begin);
+    batch_view pubkeys = batch_slice(a->pubkeys, begin);
+    return batch_derive_pubkeys(wctx, &privkeys, &pubkeys, end - begin, a->compressed, a->results + begin);
+}
+
+/* Checks the arguments all generate calls share */
+static int batch_generate_args_ok(size_t n, int compressed, int flags, const int* results) {
+    return (compressed == 0 || compressed == 1) &&
+           (flags == SECP256K1_WRAPPER_BATCH_ALL_OR_NOTHING || flags == SECP256K1_WRAPPER_BATCH_PER_ITEM) &&
+           (flags != SECP256K1_WRAPPER_BATCH_PER_ITEM || results != NULL) &&
+           n <= SIZE_MAX / PUBKEY_UNCOMPRESSION_SIZE;
+}
+
+/* Resolves a caller's stride (0 = packed) and checks that `n` items of
+ * `size` bytes at that stride neither overlap nor run past the address space.
+ * Returns the stride, or 0 if it is unusable. */
+static size_t batch_stride(size_t stride, size_t size, size_t n) {
+    if (stride == 0) {
+        stride = size;
+    }
+    if (stride < size || (n > 1 && stride > (SIZE_MAX - size) / (n - 1))) {
+        return 0;
+    }
+    return stride;
+}
+
+/* A scatter-gather array must name a buffer for every item */
+static int batch_ptrs_ok(const unsigned char* const* ptrs, size_t n) {
+    if (ptrs == NULL) {
+        return 0;
+    }
+    for (size_t i = 0; i < n; i++) {
+        if (ptrs[i] == NULL) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/* Runs a validated generate call, in parallel if enabled */
+static int batch_generate(const batch_view* privkeys, const batch_view* pubkeys, size_t n, int compressed,
+                          int flags, int* results) {
+    if (n == 0) {
+        return 0;
+    }
+
+    batch_args args = { *privkeys, *pubkeys, compressed, flags, results };
+    int res;
+    if (wrapper_parallel_run(n, batch_generate_range, &args, &res)) {
+        if (res != 0 && flags == SECP256K1_WRAPPER_BATCH_ALL_OR_NOTHING) {
+            batch_wipe_privkeys(privkeys, n);  // chunks that succeeded still hold keys
+        }
+        return res;
+    }
+
+    wrapper_ctx_lease lease;
+    res = wrapper_lease_acquire(&lease, 1);
+    if (res != 0) {
+        for (size_t i = 0; flags == SECP256K1_WRAPPER_BATCH_PER_ITEM && i < n; i++) {
+            results[i] = res;
+        }
+        return res;
+    }
+
+    res = batch_generate_keys(lease.ctx, privkeys, pubkeys, n, compressed, flags, results);
+    wrapper_lease_release(&lease);
+    return res;
+}
+
+/* Runs a validated derive call, in parallel if enabled */
+static int batch_derive(const batch_view* privkeys, const batch_view* pubkeys, size_t n, int compressed,
+                        int* results) {
+    if (n == 0) {
+        return 0;
+    }
+
+    batch_args args = { *privkeys, *pubkeys, compressed, 0, results };
+    int res;
+    if (wrapper_parallel_run(n, batch_derive_range, &args, &res)) {
+        return res;
+    }
+
+    // Same as the one-shot derive: a one-shot fallback context is not randomized
+    wrapper_ctx_lease lease;
+    res = wrapper_lease_acquire(&lease, 0);
+    if (res != 0) {
+        for (size_t i = 0; i < n; i++) {
+            results[i] = res;
+        }
+        return res;
+    }
+
+    res = batch_derive_pubkeys(lease.ctx, privkeys, pubkeys, n, compressed, results);
+    wrapper_lease_release(&lease);
+    return res;
+}
+
+int secp256k1_wrapper_generate_keys_batch(unsigned char* privkeys_out, unsigned char* pubkeys_out, size_t n,
+                                          int compressed, int flags, int* results) {
+    return secp256k1_wrapper_generate_keys_strided(privkeys_out, 0, pubkeys_out, 0, n, compressed, flags, results);
+}
+
+int secp256k1_wrapper_generate_keys_strided(unsigned char* privkeys_out, size_t privkey_stride,
+                                            unsigned char* pubkeys_out, size_t pubkey_stride, size_t n,
+                                            int compressed, int flags, int* results) {
+    if (privkeys_out == NULL || pubkeys_out == NULL || !batch_generate_args_ok(n, compressed, flags, results)) {
+        return -1; // Invalid input
+    }
+    privkey_stride = batch_stride(privkey_stride, PRIVKEY_SIZE, n);
+    pubkey_stride = batch_stride(pubkey_stride, compressed ? PUBKEY_COMPRESSION_SIZE : PUBKEY_UNCOMPRESSION_SIZE, n);
+    if (privkey_stride == 0 || pubkey_stride == 0) {
+        return -1; // Invalid input
+    }
+
+    batch_view privkeys = batch_view_strided(privkeys_out, privkey_stride);
+    batch_view pubkeys = batch_view_strided(pubkeys_out, pubkey_stride);
+    return batch_generate(&privkeys, &pubkeys, n, compressed, flags, results);
+}
+
+int secp256k1_wrapper_generate_keys_scatter(unsigned char* const* privkeys_out, unsigned char* const* pubkeys_out,
+                                            size_t n, int compressed, int flags, int* results) {
+    if (!batch_generate_args_ok(n, compressed, flags, results) ||
+        !batch_ptrs_ok((const unsigned char* const*)privkeys_out, n) ||
+        !batch_ptrs_ok((const unsigned char* const*)pubkeys_out, n)) {
+        return -1; // Invalid input
+    }
+
+    batch_view privkeys = batch_view_ptrs((const unsigned char* const*)privkeys_out);
+    batch_view pubkeys = batch_view_ptrs((const unsigned char* const*)pubkeys_out);
+    return batch_generate(&privkeys, &pubkeys, n, compressed, flags, results);
+}
+
+int secp256k1_wrapper_derive_pubkey_batch(const unsigned char* privkeys, unsigned char* pubkeys_out, size_t n,
+                                          int compressed, int* results) {
+    return secp256k1_wrapper_derive_pubkey_strided(privkeys, 0, pubkeys_out, 0, n, compressed, results);
+}
+
+int secp256k1_wrapper_derive_pubkey_strided(const unsigned char* privkeys, size_t privkey_stride,
+                                            unsigned char* pubkeys_out, size_t pubkey_stride, size_t n,
+                                            int compressed, int* results) {
+    if (privkeys == NULL || pubkeys_out == NULL || results == NULL || (compressed != 0 && compressed != 1) ||
+        n > SIZE_MAX / PUBKEY_UNCOMPRESSION_SIZE) {
+        return -1; // Invalid input
+    }
+    privkey_stride = batch_stride(privkey_stride, PRIVKEY_SIZE, n);
+    pubkey_stride = batch_stride(pubkey_stride, compressed ? PUBKEY_COMPRESSION_SIZE : PUBKEY_UNCOMPRESSION_SIZE, n);
+    if (privkey_stride == 0 || pubkey_stride == 0) {
+        return -1; // Invalid input
+    }
+
+    batch_view in = batch_view_strided(privkeys, privkey_stride);
+    batch_view out = batch_view_strided(pubkeys_out, pubkey_stride);
+    return batch_derive(&in, &out, n, compressed, results);
+}
+
+int secp256k1_wrapper_derive_pubkey_scatter(const unsigned char* const* privkeys, unsigned char* const* pubkeys_out,
+                                            size_t n, int compressed, int* results) {
+    if (results == NULL || (compressed != 0 && compressed != 1) || n > SIZE_MAX / PUBKEY_UNCOMPRESSION_SIZE ||
+        !batch_ptrs_ok(privkeys, n) || !batch_ptrs_ok((const unsigned char* const*)pubkeys_out, n)) {
+        return -1; // Invalid input
+    }
+
+    batch_view in = batch_view_ptrs(privkeys);
+    batch_view out = batch_view_ptrs((const unsigned char* const*)pubkeys_out);
+    return batch_derive(&in, &out, n, compressed, results);
+}
+
+/* ---------- Sequential ranges ---------- */
+
+/* out = key + add, as 256-bit big-endian integers. Returns the carry out of
+ * the top byte. */
+static int batch_scalar_add(unsigned char* out, const unsigned char* key, uint64_t add) {
+    unsigned int carry = 0;
+    for (int i = PRIVKEY_SIZE - 1; i >= 0; i--) {
+        unsigned int sum = key[i] + (unsigned int)(add & 0xFF) + carry;
+        out[i] = (unsigned char)sum;
+        carry = sum >> 8;
+        add >>= 8;
+    }
+    return (int)carry;
+}
+
+/* Public keys of privkey + begin ... privkey + begin + n - 1, all known to
+ * be valid. One scalar multiplication for the first point, then one
+ * addition of G per key, normalized a block at a time; the outputs are
+ * public, so the variable-time arithmetic leaks nothing. Returns 0, or -5
+ * with the slots zeroed. */
+static int batch_range(secp256k1_wrapper_ctx* wctx, const unsigned char* privkey, size_t begin, size_t n,
+                       unsigned char* pubkeys_out, int compressed) {
+    size_t pubkey_size = compressed ? PUBKEY_COMPRESSION_SIZE : PUBKEY_UNCOMPRESSION_SIZE;
+
+    int res = wrapper_ctx_begin_op(wctx);
+    if (res != 0) {
+        memset(pubkeys_out, 0, n * pubkey_size);
+        return res;
+    }
+
+    unsigned char key[PRIVKEY_SIZE];
+    unsigned char start[PUBKEY_UNCOMPRESSION_SIZE];
+    size_t start_len = sizeof(start);
+    secp256k1_pubkey point;
+    (void)batch_scalar_add(key, privkey, begin);
+    int ok = secp256k1_ec_pubkey_create(wctx->ctx, &point, key) &&
+             secp256k1_ec_pubkey_serialize(wctx->ctx, start, &start_len, &point, SECP256K1_EC_UNCOMPRESSED) &&
+             wrapper_group_range(start, n, pubkeys_out, compressed);
+    secure_memzero(key, sizeof(key));
+
+    if (!ok) {
+        memset(pubkeys_out, 0, n * pubkey_size);
+        return -5; // Public key creation or serialization failed
+    }
+    return 0;
+}
+
+typedef struct batch_range_args {
+    const unsigned char* privkey;
+    unsigned char* pubkeys_out;
+    int compressed;
+} batch_range_args;
+
+static int batch_range_chunk(void* arg, secp256k1_wrapper_ctx* wctx, size_t begin, size_t end) {
+    const batch_range_args* a = (const batch_range_args*)arg;
+    size_t pubkey_size = a->compressed ? PUBKEY_COMPRESSION_SIZE : PUBKEY_UNCOMPRESSION_SIZE;
+    return batch_range(wctx, a->privkey, begin, end - begin, a->pubkeys_out + begin * pubkey_size, a->compressed);
+}
+
+int secp256k1_wrapper_derive_pubkey_range(const unsigned char* privkey, size_t n, unsigned char* pubkeys_out,
+                                          int compressed) {
+    if (privkey == NULL || pubkeys_out == NULL || (compressed != 0 && compressed != 1) ||
+        n > SIZE_MAX / PUBKEY_UNCOMPRESSION_SIZE) {
+        return -1; // Invalid input
+    }
+    if (n == 0) {
+        return 0;
+    }
+    if (!secp256k1_ec_seckey_verify(secp256k1_context_static, privkey)) {
+        return -5; // Invalid private key, as secp256k1_wrapper_derive_pubkey()
+    }
+    // The start is at least 1, so the whole range is valid iff its last key is
+    unsigned char last[PRIVKEY_SIZE];
+    int in_range = !batch_scalar_add(last, privkey, (uint64_t)(n - 1)) &&
+                   secp256k1_ec_seckey_verify(secp256k1_context_static, last);
+    secure_memzero(last, sizeof(last));
+    if (!in_range) {
+        return -1; // Range runs past the group order
+    }
+
+    batch_range_args args = { privkey, pubkeys_out, compressed };
+    int res;
+    if (wrapper_parallel_run(n, batch_range_chunk, &args, &res)) {
+        if (res != 0) {
+            memset(pubkeys_out, 0, n * (compressed ? PUBKEY_COMPRESSION_SIZE : PUBKEY_UNCOMPRESSION_SIZE));
+        }
+        return res;
+    }
+
+    // Same as the one-shot derive: a one-shot fallback context is not randomized
+    wrapper_ctx_lease lease;
+    res = wrapper_lease_acquire(&lease, 0);
+    if (res != 0) {
+        return res;
+    }
+    res = batch_range(lease.ctx, privkey, 0, n, pubkeys_out, compressed);
+    wrapper_lease_release(&lease);
+    return res;
+}
+
+/* ---------- Streaming generator ---------- */
+
+secp256k1_wrapper_keygen* secp256k1_wrapper_keygen_open(int compressed) {
+    if (compressed != 0 && compressed != 1) {
+        return NULL;
+    }
+    secp256k1_wrapper_keygen* gen = (secp256k1_wrapper_keygen*)malloc(sizeof(*gen));
+    if (gen == NULL) {
+        return NULL;
+    }
+    if (wrapper_ctx_open(&gen->wctx, 1) != 0) {
+        free(gen);
+        return NULL;
+    }
+    gen->compressed = compressed;
+    gen->avail = 0;
+    gen->fork_generation = wrapper_fork_generation();
+    return gen;
+}
+
+/* Moves `n` private keys out of the entropy buffer, refilling it as needed.
+ * Consumed entropy is wiped. Returns 1 on success, and 0 if the RNG failed. */
+static int keygen_draw_privkeys(secp256k1_wrapper_keygen* gen, unsigned char* privkeys, size_t n) {
+    if (gen->fork_generation != wrapper_fork_generation()) {
+        // The parent holds the same buffered entropy
+        secure_memzero(gen->entropy, sizeof(gen->entropy));
+        gen->avail = 0;
+        gen->fork_generation = wrapper_fork_generation();
+    }
+    if (n >= KEYGEN_ENTROPY_KEYS) {
+        return wrapper_batch_draw_privkeys(gen->wctx.ctx, privkeys, n);
+    }
+
+    size_t done = 0;
+    while (done < n) {
+        if (gen->avail == 0) {
+            if (!secp256k1_wrapper_fill_random(gen->entropy, sizeof(gen->entropy))) {
+                return 0;
+            }
+            gen->avail = KEYGEN_ENTROPY_KEYS;
+        }
+        size_t take = n - done < gen->avail ? n - done : gen->avail;
+        unsigned char* src = gen->entropy + (KEYGEN_ENTROPY_KEYS - gen->avail) * PRIVKEY_SIZE;
+        memcpy(privkeys + done * PRIVKEY_SIZE, src, take * PRIVKEY_SIZE);
+        secure_memzero(src, take * PRIVKEY_SIZE);
+        gen->avail -= take;
+        done += take;
+    }
+    batch_view keys = batch_view_strided(privkeys, PRIVKEY_SIZE);
+    return batch_screen_privkeys(gen->wctx.ctx, &keys, n);
+}
+
+int secp256k1_wrapper_keygen_next(secp256k1_wrapper_keygen* gen, unsigned char* privkeys_out,
+                                  unsigned char* pubkeys_out, size_t n) {
+    if (gen == NULL || privkeys_out == NULL || pubkeys_out == NULL || n > SIZE_MAX / PUBKEY_UNCOMPRESSION_SIZE) {
+        return -1; // Invalid input
+    }
+    if (n == 0) {
+        return 0;
+    }
+
+    if (!keygen_draw_privkeys(gen, privkeys_out, n)) {
+        secure_memzero(privkeys_out, n * PRIVKEY_SIZE);
+        return -3; // Random number generation failed
+    }
+    return wrapper_batch_pubkeys(&gen->wctx, privkeys_out, pubkeys_out, n, gen->compressed,
+                                 SECP256K1_WRAPPER_BATCH_ALL_OR_NOTHING, NULL);
+}
+
+void secp256k1_wrapper_keygen_close(secp256k1_wrapper_keygen* gen) {
+    if (gen == NULL) {
+        return;
+    }
+    wrapper_ctx_close(&gen->wctx);
+    secure_memzero(gen, sizeof(*gen));
+    free(gen);
+}
@@ -0,0 +1,210 @@
+/*
+ * secp256k1_wrapper - convenience wrapper around libsecp256k1
+ *
+ * Copyright (c) 2025 xXLegionBinFrogXx
+ *
+ * This file is licensed under the MIT License.
+ * See the LICENSE file in the project root for details.
+ *
+ * This project incorporates code from libsecp256k1,
+ * copyright (c) 2013 Bitcoin Core Developers, MIT License.
+ */
+
+/*
+ * ChaCha20 block function (RFC 8439) used as the keystream generator of the
+ * userspace DRBG. A portable scalar version is always built; on x86 with
+ * GCC or Clang an AVX2 kernel computing 8 blocks at once is selected at
+ * runtime when the CPU supports it.
+ */
+
+#include "secp256k1_wrapper_internal.h"
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+  #define WRAPPER_HAVE_AVX2_KERNEL 1
+  #include <immintrin.h>
+#endif
+
+#define ROTL32(v, n) (((v) << (n)) | ((v) >> (32 - (n))))
+
+#define QUARTERROUND(a, b, c, d)                   \
+    a += b; d ^= a; d = ROTL32(d, 16);             \
+    c += d; b ^= c; b = ROTL32(b, 12);             \
+    a += b; d ^= a; d = ROTL32(d, 8);              \
+    c += d; b ^= c; b = ROTL32(b, 7)
+
+static uint32_t load32_le(const unsigned char* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static void store32_le(unsigned char* p, uint32_t v) {
+    p[0] = (unsigned char)v;
+    p[1] = (unsigned char)(v >> 8);
+    p[2] = (unsigned char)(v >> 16);
+    p[3] = (unsigned char)(v >> 24);
+}
+
+/* Initial state with the block counter in word 12 */
+static void chacha20_init(uint32_t state[16], const unsigned char key[32], const unsigned char nonce[12], uint32_t counter) {
+    state[0] = 0x61707865u;  // "expand 32-byte k"
+    state[1] = 0x3320646eu;
+    state[2] = 0x79622d32u;
+    state[3] = 0x6b206574u;
+    for (int i = 0; i < 8; i++) {
+        state[4 + i] = load32_le(key + 4 * i);
+    }
+    state[12] = counter;
+    state[13] = load32_le(nonce);
+    state[14] = load32_le(nonce + 4);
+    state[15] = load32_le(nonce + 8);
+}
+
+void wrapper_chacha20_blocks_scalar(const unsigned char key[32], const unsigned char nonce[12], uint32_t counter, unsigned char* out, size_t nblocks) {
+    uint32_t state[16], x[16];
+    chacha20_init(state, key, nonce, counter);
+
+    for (size_t blk = 0; blk < nblocks; blk++) {
+        memcpy(x, state, sizeof(x));
+        for (int i = 0; i < 10; i++) {
+            QUARTERROUND(x[0], x[4], x[8],  x[12]);
+            QUARTERROUND(x[1], x[5], x[9],  x[13]);
+            QUARTERROUND(x[2], x[6], x[10], x[14]);
+            QUARTERROUND(x[3], x[7], x[11], x[15]);
+            QUARTERROUND(x[0], x[5], x[10], x[15]);
+            QUARTERROUND(x[1], x[6], x[11], x[12]);
+            QUARTERROUND(x[2], x[7], x[8],  x[13]);
+            QUARTERROUND(x[3], x[4], x[9],  x[14]);
+        }
+        for (int i = 0; i < 16; i++) {
+            store32_le(out + 64 * blk + 4 * i, x[i] + state[i]);
+        }
+        state[12]++;
+    }
+
+    secure_memzero(x, sizeof(x));
+    secure_memzero(state, sizeof(state));
+}
+
+#if defined(WRAPPER_HAVE_AVX2_KERNEL)
+
+/* Each vector holds the same state word of 8 consecutive blocks */
+#define AVX2_ROTL(v, n) _mm256_or_si256(_mm256_slli_epi32(v, n), _mm256_srli_epi32(v, 32 - (n)))
+
+#define AVX2_QUARTERROUND(a, b, c, d)                                                   \
+    a = _mm256_add_epi32(a, b); d = _mm256_shuffle_epi8(_mm256_xor_si256(d, a), rot16); \
+    c = _mm256_add_epi32(c, d); b = _mm256_xor_si256(b, c); b = AVX2_ROTL(b, 12);       \
+    a = _mm256_add_epi32(a, b); d = _mm256_shuffle_epi8(_mm256_xor_si256(d, a), rot8);  \
+    c = _mm256_add_epi32(c, d); b = _mm256_xor_si256(b, c); b = AVX2_ROTL(b, 7)
+
+/* Transposes 8 state words of 8 blocks and stores them as 32 contiguous
+ * bytes per block, at `out` + 64 * block */
+__attribute__((target("avx2")))
+static void avx2_store_half(unsigned char* out, const __m256i w[8]) {
+    __m256i t0 = _mm256_unpacklo_epi32(w[0], w[1]);
+    __m256i t1 = _mm256_unpackhi_epi32(w[0], w[1]);
+    __m256i t2 = _mm256_unpacklo_epi32(w[2], w[3]);
+    __m256i t3 = _mm256_unpackhi_epi32(w[2], w[3]);
+    __m256i t4 = _mm256_unpacklo_epi32(w[4], w[5]);
+    __m256i t5 = _mm256_unpackhi_epi32(w[4], w[5]);
+    __m256i t6 = _mm256_unpacklo_epi32(w[6], w[7]);
+    __m256i t7 = _mm256_unpackhi_epi32(w[6], w[7]);
+
+    __m256i u0 = _mm256_unpacklo_epi64(t0, t2);  // blocks 0 | 4, words 0-3
+    __m256i u1 = _mm256_unpackhi_epi64(t0, t2);  // blocks 1 | 5
+    __m256i u2 = _mm256_unpacklo_epi64(t1, t3);  // blocks 2 | 6
+    __m256i u3 = _mm256_unpackhi_epi64(t1, t3);  // blocks 3 | 7
+    __m256i u4 = _mm256_unpacklo_epi64(t4, t6);  // blocks 0 | 4, words 4-7
+    __m256i u5 = _mm256_unpackhi_epi64(t4, t6);
+    __m256i u6 = _mm256_unpacklo_epi64(t5, t7);
+    __m256i u7 = _mm256_unpackhi_epi64(t5, t7);
+
+    _mm256_storeu_si256((__m256i*)(out + 0 * 64), _mm256_permute2x128_si256(u0, u4, 0x20));
+    _mm256_storeu_si256((__m256i*)(out + 1 * 64), _mm256_permute2x128_si256(u1, u5, 0x20));
+    _mm256_storeu_si256((__m256i*)(out + 2 * 64), _mm256_permute2x128_si256(u2, u6, 0x20));
+    _mm256_storeu_si256((__m256i*)(out + 3 * 64), _mm256_permute2x128_si256(u3, u7, 0x20));
+    _mm256_storeu_si256((__m256i*)(out + 4 * 64), _mm256_permute2x128_si256(u0, u4, 0x31));
+    _mm256_storeu_si256((__m256i*)(out + 5 * 64), _mm256_permute2x128_si256(u1, u5, 0x31));
+    _mm256_storeu_si256((__m256i*)(out + 6 * 64), _mm256_permute2x128_si256(u2, u6, 0x31));
+    _mm256_storeu_si256((__m256i*)(out + 7 * 64), _mm256_permute2x128_si256(u3, u7, 0x31));
+}
+
+__attribute__((target("avx2")))
+static void chacha20_8blocks_avx2(const uint32_t state[16], unsigned char* out) {
+    const __m256i rot16 = _mm256_setr_epi8(2, 3, 0, 1, 6, 7, 4, 5, 10, 11, 8, 9, 14, 15, 12, 13,
+                                           2, 3, 0, 1, 6, 7, 4, 5, 10, 11, 8, 9, 14, 15, 12, 13);
+    const __m256i rot8 = _mm256_setr_epi8(3, 0, 1, 2, 7, 4, 5, 6, 11, 8, 9, 10, 15, 12, 13, 14,
+                                          3, 0, 1, 2, 7, 4, 5, 6, 11, 8, 9, 10, 15, 12, 13, 14);
+    __m256i x[16], orig[16];
+
+    for (int i = 0; i < 16; i++) {
+        orig[i] = _mm256_set1_epi32((int)state[i]);
+    }
+    orig[12] = _mm256_add_epi32(orig[12], _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+    for (int i = 0; i < 16; i++) {
+        x[i] = orig[i];
+    }
+
+    for (int i = 0; i < 10; i++) {
+        AVX2_QUARTERROUND(x[0], x[4], x[8],  x[12]);
+        AVX2_QUARTERROUND(x[1], x[5], x[9],  x[13]);
+        AVX2_QUARTERROUND(x[2], x[6], x[10], x[14]);
+        AVX2_QUARTERROUND(x[3], x[7], x[11], x[15]);
+        AVX2_QUARTERROUND(x[0], x[5], x[10], x[15]);
+        AVX2_QUARTERROUND(x[1], x[6], x[11], x[12]);
+        AVX2_QUARTERROUND(x[2], x[7], x[8],  x[13]);
+        AVX2_QUARTERROUND(x[3], x[4], x[9],  x[14]);
+    }
+
+    for (int i = 0; i < 16; i++) {
+        x[i] = _mm256_add_epi32(x[i], orig[i]);
+    }
+    avx2_store_half(out, x);
+    avx2_store_half(out + 32, x + 8);
+
+    secure_memzero(x, sizeof(x));
+    secure_memzero(orig, sizeof(orig));
+}
+
+static int cpu_has_avx2(void) {
+    static volatile int cached = -1;
+    int has = wrapper_atomic_load_int(&cached);
+    if (has < 0) {
+        __builtin_cpu_init();
+        has = __builtin_cpu_supports("avx2") ? 1 : 0;
+        wrapper_atomic_store_int(&cached, has);
+    }
+    return has;
+}
+
+#endif /* WRAPPER_HAVE_AVX2_KERNEL */
+
+int wrapper_chacha20_blocks_avx2(const unsigned char key[32], const unsigned char nonce[12], uint32_t counter, unsigned char* out, size_t nblocks) {
+#if defined(WRAPPER_HAVE_AVX2_KERNEL)
+    if (!cpu_has_avx2()) {
+        return 0;
+    }
+    uint32_t state[16];
+    chacha20_init(state, key, nonce, counter);
+
+    while (nblocks >= 8) {
+        chacha20_8blocks_avx2(state, out);
+        state[12] += 8;
+        out += 8 * 64;
+        nblocks -= 8;
+    }
+    if (nblocks > 0) {
+        wrapper_chacha20_blocks_scalar(key, nonce, state[12], out, nblocks);
+    }
+    secure_memzero(state, sizeof(state));
+    return 1;
+#else
+    (void)key; (void)nonce; (void)counter; (void)out; (void)nblocks;
+    return 0;
+#endif
+}
+
+void wrapper_chacha20_blocks(const unsigned char key[32], const unsigned char nonce[12], uint32_t counter, unsigned char* out, size_t nblocks) {
+    if (nblocks >= 8 && wrapper_chacha20_blocks_avx2(key, nonce, counter, out, nblocks)) {
+        return;
+    }
+    wrapper_chacha20_blocks_scalar(key, nonce, counter, out, nblocks);
+}
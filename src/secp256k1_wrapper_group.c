@@ -0,0 +1,101 @@
+/*
+ * secp256k1_wrapper - convenience wrapper around libsecp256k1
+ *
+ * Copyright (c) 2025 xXLegionBinFrogXx
+ *
+ * This file is licensed under the MIT License.
+ * See the LICENSE file in the project root for details.
+ *
+ * This project incorporates code from libsecp256k1,
+ * copyright (c) 2013 Bitcoin Core Developers, MIT License.
+ */
+
+/*
+ * Group arithmetic on libsecp256k1's internal point representation.
+ *
+ * The public API hands every point back in affine form, so stepping through
+ * consecutive public keys with secp256k1_ec_pubkey_combine() pays one field
+ * inversion per key. This file includes the library's field and group
+ * implementation, as its own benchmarks and tests do, to keep the points in
+ * Jacobian coordinates and bring a whole block back to affine form with a
+ * single inversion (Montgomery's simultaneous inversion in
+ * secp256k1_ge_set_all_gej_var()).
+ *
+ * Only serialized points cross into the rest of the wrapper: the internal
+ * types depend on the field implementation this file is compiled with.
+ */
+
+#include "secp256k1_wrapper_internal.h"
+
+/* The implementation headers define many static functions this file does
+ * not use */
+#if defined(__GNUC__) || defined(__clang__)
+  #pragma GCC diagnostic push
+  #pragma GCC diagnostic ignored "-Wunused-function"
+  #pragma GCC diagnostic ignored "-Wunused-const-variable"
+#elif defined(_MSC_VER)
+  #pragma warning(push)
+  #pragma warning(disable : 4505)
+#endif
+#include "util.h"
+#include "field_impl.h"
+#include "group_impl.h"
+#include "int128_impl.h"
+#if defined(__GNUC__) || defined(__clang__)
+  #pragma GCC diagnostic pop
+#elif defined(_MSC_VER)
+  #pragma warning(pop)
+#endif
+
+#define GROUP_RANGE_BLOCK 64  // points brought to affine form per inversion
+
+/* Serializes an affine point like secp256k1_ec_pubkey_serialize() */
+static void group_serialize(secp256k1_ge* point, unsigned char* out, int compressed) {
+    secp256k1_fe_normalize_var(&point->x);
+    secp256k1_fe_normalize_var(&point->y);
+    secp256k1_fe_get_b32(out + 1, &point->x);
+    if (compressed) {
+        out[0] = secp256k1_fe_is_odd(&point->y) ? 0x03 : 0x02;
+    } else {
+        out[0] = 0x04;
+        secp256k1_fe_get_b32(out + 33, &point->y);
+    }
+}
+
+int wrapper_group_range(const unsigned char* start, size_t n, unsigned char* pubkeys_out, int compressed) {
+    size_t pubkey_size = compressed ? PUBKEY_COMPRESSION_SIZE : PUBKEY_UNCOMPRESSION_SIZE;
+    secp256k1_gej jacobian[GROUP_RANGE_BLOCK];
+    secp256k1_ge affine[GROUP_RANGE_BLOCK];
+    secp256k1_gej next;
+    secp256k1_ge point;
+    secp256k1_fe x, y;
+
+    if (start[0] != 0x04 || !secp256k1_fe_set_b32_limit(&x, start + 1) ||
+        !secp256k1_fe_set_b32_limit(&y, start + 33)) {
+        return 0;
+    }
+    secp256k1_ge_set_xy(&point, &x, &y);
+    if (!secp256k1_ge_is_valid_var(&point)) {
+        return 0;
+    }
+    secp256k1_gej_set_ge(&next, &point);
+
+    for (size_t done = 0; done < n;) {
+        size_t count = n - done < GROUP_RANGE_BLOCK ? n - done : GROUP_RANGE_BLOCK;
+        for (size_t i = 0; i < count; i++) {
+            jacobian[i] = next;
+            if (done + i + 1 < n) {
+                secp256k1_gej_add_ge_var(&next, &next, &secp256k1_ge_const_g, NULL);
+            }
+        }
+        secp256k1_ge_set_all_gej_var(affine, jacobian, count);
+        for (size_t i = 0; i < count; i++) {
+            if (secp256k1_ge_is_infinity(&affine[i])) {
+                return 0;
+            }
+            group_serialize(&affine[i], pubkeys_out + (done + i) * pubkey_size, compressed);
+        }
+        done += count;
+    }
+    return 1;
+}
@@ -0,0 +1,474 @@
+/*
+ * secp256k1_wrapper - convenience wrapper around libsecp256k1
+ *
+ * Copyright (c) 2025 xXLegionBinFrogXx
+ *
+ * This file is licensed under the MIT License.
+ * See the LICENSE file in the project root for details.
+ *
+ * Internal helpers shared by the wrapper sources. Not installed.
+ */
+
+#ifndef SECP256K1_WRAPPER_INTERNAL_H
+#define SECP256K1_WRAPPER_INTERNAL_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "secp256k1_wrapper.h"
+#include "secp256k1.h"
+#include "secp256k1_extrakeys.h"
+#include "secp256k1_schnorrsig.h"
+
+#if defined(_WIN32)
+  #include <windows.h>
+#else
+  #include <pthread.h>
+  #include <sched.h>
+#endif
+
+#if defined(_MSC_VER) && !defined(__clang__)
+  #define WRAPPER_INLINE __inline
+#else
+  #define WRAPPER_INLINE inline
+#endif
+
+/* Cross-file helpers are kept out of the shared library's export table */
+#if (defined(__GNUC__) || defined(__clang__)) && !defined(_WIN32)
+  #define WRAPPER_INTERNAL __attribute__((visibility("hidden")))
+#else
+  #define WRAPPER_INTERNAL
+#endif
+
+/* ---------- Secure zeroing ---------- */
+
+/* Secure memory zeroing that won't be optimized away */
+static WRAPPER_INLINE void secure_memzero(void *p, size_t n) {
+#if defined(_WIN32)
+    SecureZeroMemory(p, n);
+#elif defined(__STDC_LIB_EXT1__)
+    (void)memset_s(p, n, 0, n);   // In case someone actually implemented section K
+#elif defined(__GNUC__) || defined(__clang__)
+
+    /* Let the compiler emit an efficient memset, then block DSE with a
+       compiler barrier that "uses" ptr and clobbers memory. 
+       This method is used in Linux kernel : `memzero_explicit()` see the `barrier_data`  
+       ```
+       static inline void memzero_explicit(void *s, size_t count){
+	        memset(s, 0, count);
+	        barrier_data(s);
+        }
+        ```*/
+
+    memset(p, 0, n);
+    __asm__ __volatile__ ("" : : "r"(p) : "memory");
+#else
+    /* Fallback. cannot be optimized away, I hope */
+    typedef void *(*memset_fn)(void *, int, size_t);
+    volatile memset_fn vmemset = memset;
+    vmemset(p, 0, n);
+
+#endif
+}
+
+/* ---------- Atomics ---------- */
+
+/* Thin wrappers so the rest of the code does not depend on C11 <stdatomic.h>,
+ * which is missing from older MSVC. Loads acquire, stores release. */
+#if defined(_MSC_VER) && !defined(__clang__)
+
+static __inline int wrapper_atomic_load_int(volatile int* p) {
+    return (int)InterlockedCompareExchange((volatile LONG*)p, 0, 0);
+}
+static __inline void wrapper_atomic_store_int(volatile int* p, int v) {
+    (void)InterlockedExchange((volatile LONG*)p, (LONG)v);
+}
+static __inline uint32_t wrapper_atomic_load_u32(volatile uint32_t* p) {
+    return (uint32_t)InterlockedCompareExchange((volatile LONG*)p, 0, 0);
+}
+static __inline void wrapper_atomic_store_u32(volatile uint32_t* p, uint32_t v) {
+    (void)InterlockedExchange((volatile LONG*)p, (LONG)v);
+}
+static __inline uint64_t wrapper_atomic_load_u64(volatile uint64_t* p) {
+    return (uint64_t)InterlockedCompareExchange64((volatile LONG64*)p, 0, 0);
+}
+static __inline void wrapper_atomic_store_u64(volatile uint64_t* p, uint64_t v) {
+    (void)InterlockedExchange64((volatile LONG64*)p, (LONG64)v);
+}
+static __inline uint64_t wrapper_atomic_fetch_add_u64(volatile uint64_t* p, uint64_t v) {
+    return (uint64_t)InterlockedExchangeAdd64((volatile LONG64*)p, (LONG64)v);
+}
+/* Acquire-release, for counters whose last decrement hands over results */
+static __inline uint64_t wrapper_atomic_fetch_sub_u64(volatile uint64_t* p, uint64_t v) {
+    return (uint64_t)InterlockedExchangeAdd64((volatile LONG64*)p, -(LONG64)v);
+}
+static __inline void wrapper_atomic_fence(void) {
+    MemoryBarrier();
+}
+/* Relaxed, for bitmaps whose bytes straddle ranges run by different threads */
+static __inline void wrapper_atomic_or_u8(volatile unsigned char* p, unsigned char v) {
+    (void)InterlockedOr8((volatile char*)p, (char)v);
+}
+/* On failure *expected is updated with the current value */
+static __inline int wrapper_atomic_cas_u64(volatile uint64_t* p, uint64_t* expected, uint64_t desired) {
+    uint64_t prev = (uint64_t)InterlockedCompareExchange64((volatile LONG64*)p, (LONG64)desired, (LONG64)*expected);
+    if (prev == *expected) {
+        return 1;
+    }
+    *expected = prev;
+    return 0;
+}
+static __inline void* wrapper_atomic_load_ptr(void* volatile* p) {
+    return InterlockedCompareExchangePointer(p, NULL, NULL);
+}
+static __inline void wrapper_atomic_store_ptr(void* volatile* p, void* v) {
+    (void)InterlockedExchangePointer(p, v);
+}
+
+#else
+
+static inline int wrapper_atomic_load_int(volatile int* p) {
+    return __atomic_load_n(p, __ATOMIC_ACQUIRE);
+}
+static inline void wrapper_atomic_store_int(volatile int* p, int v) {
+    __atomic_store_n(p, v, __ATOMIC_RELEASE);
+}
+static inline uint32_t wrapper_atomic_load_u32(volatile uint32_t* p) {
+    return __atomic_load_n(p, __ATOMIC_ACQUIRE);
+}
+static inline void wrapper_atomic_store_u32(volatile uint32_t* p, uint32_t v) {
+    __atomic_store_n(p, v, __ATOMIC_RELEASE);
+}
+static inline uint64_t wrapper_atomic_load_u64(volatile uint64_t* p) {
+    return __atomic_load_n(p, __ATOMIC_ACQUIRE);
+}
+static inline void wrapper_atomic_store_u64(volatile uint64_t* p, uint64_t v) {
+    __atomic_store_n(p, v, __ATOMIC_RELEASE);
+}
+static inline uint64_t wrapper_atomic_fetch_add_u64(volatile uint64_t* p, uint64_t v) {
+    return __atomic_fetch_add(p, v, __ATOMIC_RELAXED);
+}
+/* Acquire-release, for counters whose last decrement hands over results */
+static inline uint64_t wrapper_atomic_fetch_sub_u64(volatile uint64_t* p, uint64_t v) {
+    return __atomic_fetch_sub(p, v, __ATOMIC_ACQ_REL);
+}
+/* Full (sequentially consistent) fence */
+static inline void wrapper_atomic_fence(void) {
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+}
+/* Relaxed, for bitmaps whose bytes straddle ranges run by different threads */
+static inline void wrapper_atomic_or_u8(volatile unsigned char* p, unsigned char v) {
+    (void)__atomic_fetch_or(p, v, __ATOMIC_RELAXED);
+}
+/* On failure *expected is updated with the current value */
+static inline int wrapper_atomic_cas_u64(volatile uint64_t* p, uint64_t* expected, uint64_t desired) {
+    return __atomic_compare_exchange_n(p, expected, desired, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+}
+static inline void* wrapper_atomic_load_ptr(void* volatile* p) {
+    return __atomic_load_n(p, __ATOMIC_ACQUIRE);
+}
+static inline void wrapper_atomic_store_ptr(void* volatile* p, void* v) {
+    __atomic_store_n(p, v, __ATOMIC_RELEASE);
+}
+
+#endif
+
+/* ---------- Threads ---------- */
+
+/* Minimal mutex / condition variable / thread layer over Win32 and pthreads
+ * for the wrapper's own worker threads. */
+#if defined(_WIN32)
+
+typedef SRWLOCK wrapper_mutex;
+typedef CONDITION_VARIABLE wrapper_cond;
+typedef HANDLE wrapper_thread;
+typedef DWORD wrapper_thread_ret;
+#define WRAPPER_THREAD_CALL WINAPI
+
+static __inline void wrapper_mutex_init(wrapper_mutex* m) { InitializeSRWLock(m); }
+static __inline void wrapper_mutex_destroy(wrapper_mutex* m) { (void)m; }
+static __inline void wrapper_mutex_lock(wrapper_mutex* m) { AcquireSRWLockExclusive(m); }
+static __inline void wrapper_mutex_unlock(wrapper_mutex* m) { ReleaseSRWLockExclusive(m); }
+static __inline void wrapper_cond_init(wrapper_cond* c) { InitializeConditionVariable(c); }
+static __inline void wrapper_cond_destroy(wrapper_cond* c) { (void)c; }
+static __inline void wrapper_cond_wait(wrapper_cond* c, wrapper_mutex* m) { SleepConditionVariableSRW(c, m, INFINITE, 0); }
+static __inline void wrapper_cond_signal(wrapper_cond* c) { WakeConditionVariable(c); }
+static __inline void wrapper_cond_broadcast(wrapper_cond* c) { WakeAllConditionVariable(c); }
+static __inline void wrapper_thread_yield(void) { (void)SwitchToThread(); }
+
+#else
+
+typedef pthread_mutex_t wrapper_mutex;
+typedef pthread_cond_t wrapper_cond;
+typedef pthread_t wrapper_thread;
+typedef void* wrapper_thread_ret;
+#define WRAPPER_THREAD_CALL
+
+static inline void wrapper_mutex_init(wrapper_mutex* m) { pthread_mutex_init(m, NULL); }
+static inline void wrapper_mutex_destroy(wrapper_mutex* m) { pthread_mutex_destroy(m); }
+static inline void wrapper_mutex_lock(wrapper_mutex* m) { pthread_mutex_lock(m); }
+static inline void wrapper_mutex_unlock(wrapper_mutex* m) { pthread_mutex_unlock(m); }
+static inline void wrapper_cond_init(wrapper_cond* c) { pthread_cond_init(c, NULL); }
+static inline void wrapper_cond_destroy(wrapper_cond* c) { pthread_cond_destroy(c); }
+static inline void wrapper_cond_wait(wrapper_cond* c, wrapper_mutex* m) { pthread_cond_wait(c, m); }
+static inline void wrapper_cond_signal(wrapper_cond* c) { pthread_cond_signal(c); }
+static inline void wrapper_cond_broadcast(wrapper_cond* c) { pthread_cond_broadcast(c); }
+static inline void wrapper_thread_yield(void) { (void)sched_yield(); }
+
+#endif
+
+/* Thread entry points are declared as
+ *     static wrapper_thread_ret WRAPPER_THREAD_CALL fn(void* arg) { ...; return 0; } */
+typedef wrapper_thread_ret (WRAPPER_THREAD_CALL *wrapper_thread_fn)(void* arg);
+
+/* Returns 1 if the thread was started, 0 otherwise */
+WRAPPER_INTERNAL int wrapper_thread_start(wrapper_thread* thread, wrapper_thread_fn fn, void* arg);
+WRAPPER_INTERNAL void wrapper_thread_join(wrapper_thread thread);
+
+/* ---------- Fork safety ---------- */
+
+/* Bumped in the child after every fork(). Anything holding secret state that
+ * must not be shared with a parent (blinded contexts, buffered entropy)
+ * records the generation it was seeded in and re-seeds on mismatch. */
+WRAPPER_INTERNAL extern volatile uint32_t wrapper_fork_gen;
+
+static WRAPPER_INLINE uint32_t wrapper_fork_generation(void) {
+    return wrapper_atomic_load_u32(&wrapper_fork_gen);
+}
+
+/* Registers the pthread_atfork handlers once. Call before caching state. */
+WRAPPER_INTERNAL void wrapper_fork_guard(void);
+
+/* ---------- Context handles ---------- */
+
+/* Wrapper context handle. Owns one libsecp256k1 signing context that is
+ * reused across calls instead of being created and destroyed per key. */
+struct secp256k1_wrapper_ctx {
+    secp256k1_context* ctx;
+    uint64_t ops_since_randomize;  // operations since the last blinding
+    uint64_t randomized_at_us;     // wrapper_monotonic_us() of the last blinding
+    int preallocated;              // ctx lives in caller-owned memory
+    uint32_t fork_generation;      // wrapper_fork_generation() at the last blinding
+};
+
+/* Monotonic clock in microseconds, for policies and time budgets */
+WRAPPER_INTERNAL uint64_t wrapper_monotonic_us(void);
+
+/* Randomizes (blinds) a signing context with a fresh 32-byte seed.
+ * Returns 0 on success, -3 if the RNG failed, -2 if randomization failed. */
+WRAPPER_INTERNAL int wrapper_context_randomize(secp256k1_context* ctx);
+
+/* Re-blinds a wrapper context and resets its policy counters */
+WRAPPER_INTERNAL int wrapper_ctx_rerandomize(secp256k1_wrapper_ctx* wctx);
+
+/* Call before every key operation on a long-lived context: re-blinds it after
+ * a fork or when the re-randomization policy is due. Returns 0, or the error
+ * code of a failed re-blinding. */
+WRAPPER_INTERNAL int wrapper_ctx_begin_op(secp256k1_wrapper_ctx* wctx);
+
+/* Sets up a wrapper context in caller-provided storage.
+ * Returns 0 on success or the error code of the failing step. */
+WRAPPER_INTERNAL int wrapper_ctx_open(secp256k1_wrapper_ctx* wctx, int randomize);
+
+/* Same as wrapper_ctx_open(), placing the context in `mem`, which must hold
+ * secp256k1_context_preallocated_size(SECP256K1_CONTEXT_SIGN) bytes */
+WRAPPER_INTERNAL int wrapper_ctx_open_preallocated(secp256k1_wrapper_ctx* wctx, void* mem, int randomize);
+
+WRAPPER_INTERNAL void wrapper_ctx_close(secp256k1_wrapper_ctx* wctx);
+
+/* A context borrowed for a single call. Sources are tried in order: the
+ * shared pool, the per-thread cache, then a context set up for this call. */
+typedef struct wrapper_ctx_lease {
+    secp256k1_wrapper_ctx* ctx;
+    secp256k1_wrapper_ctx local;  // storage for the one-shot fallback
+    int pooled;
+} wrapper_ctx_lease;
+
+/* Returns 0 with lease->ctx set, or the error code of the one-shot setup.
+ * `randomize` only applies to the one-shot fallback. */
+WRAPPER_INTERNAL int wrapper_lease_acquire(wrapper_ctx_lease* lease, int randomize);
+
+WRAPPER_INTERNAL void wrapper_lease_release(wrapper_ctx_lease* lease);
+
+/* ---------- Per-thread state ---------- */
+
+/* Buffered entropy owned by one thread (secp256k1_wrapper_rng.c) */
+typedef struct wrapper_rng_buffer {
+    unsigned char* data;
+    size_t size;               // capacity of data
+    size_t pos;                // bytes before pos are consumed and wiped
+    uint32_t fork_generation;  // generation the buffer was filled in
+} wrapper_rng_buffer;
+
+/* Fast-key-erasure ChaCha20 DRBG owned by one thread (secp256k1_wrapper_rng.c) */
+typedef struct wrapper_drbg {
+    unsigned char key[32];        // replaced after every generate call
+    uint64_t bytes_since_reseed;
+    uint32_t fork_generation;     // generation the key was last seeded in
+    int seeded;
+} wrapper_drbg;
+
+/* State owned by a single thread, released by the thread-exit destructor. */
+typedef struct wrapper_thread_state {
+    secp256k1_wrapper_ctx ctx;  // cached context, ctx.ctx is NULL until first use
+    wrapper_rng_buffer rng;
+    wrapper_drbg drbg;
+} wrapper_thread_state;
+
+/* Returns the calling thread's state, allocating it on first use.
+ * Returns NULL if TLS is unavailable or allocation failed. */
+WRAPPER_INTERNAL wrapper_thread_state* wrapper_thread_state_get(void);
+/* Returns the calling thread's state if it has one; never allocates */
+WRAPPER_INTERNAL wrapper_thread_state* wrapper_thread_state_peek(void);
+
+/* Wipes and frees the thread's RNG state; called by the exit destructor */
+WRAPPER_INTERNAL void wrapper_rng_thread_free(wrapper_thread_state* st);
+
+/* ---------- ChaCha20 (secp256k1_wrapper_chacha20.c) ---------- */
+
+/* Writes `nblocks` 64-byte ChaCha20 keystream blocks starting at block
+ * `counter`, using the fastest kernel the CPU supports. */
+WRAPPER_INTERNAL void wrapper_chacha20_blocks(const unsigned char key[32], const unsigned char nonce[12],
+                                              uint32_t counter, unsigned char* out, size_t nblocks);
+
+/* Portable reference kernel */
+WRAPPER_INTERNAL void wrapper_chacha20_blocks_scalar(const unsigned char key[32], const unsigned char nonce[12],
+                                                     uint32_t counter, unsigned char* out, size_t nblocks);
+
+/* AVX2 kernel, 8 blocks per iteration with a scalar tail. Returns 0 without
+ * writing anything if the build or the CPU lacks AVX2, and 1 otherwise. */
+WRAPPER_INTERNAL int wrapper_chacha20_blocks_avx2(const unsigned char key[32], const unsigned char nonce[12],
+                                                  uint32_t counter, unsigned char* out, size_t nblocks);
+
+/* ---------- Context pool (secp256k1_wrapper_pool.c) ---------- */
+
+/* Pops a pre-randomized context from the shared pool. Returns NULL if no
+ * pool is configured or it is empty; the miss is counted in the stats. */
+WRAPPER_INTERNAL secp256k1_wrapper_ctx* wrapper_ctx_pool_acquire(void);
+
+/* Returns a context obtained from wrapper_ctx_pool_acquire() */
+WRAPPER_INTERNAL void wrapper_ctx_pool_release(secp256k1_wrapper_ctx* wctx);
+
+/* Child-side fork handler: only the forking thread survives, so every
+ * context is free again. Rebuilds the free list without atomics. */
+WRAPPER_INTERNAL void wrapper_ctx_pool_after_fork(void);
+
+/* ---------- Key pair pool (secp256k1_wrapper_keypool.c) ---------- */
+
+/* Child-side fork handler: wipes the pre-generated private keys, which the
+ * parent still owns, and leaves the ring empty. Takes no locks. */
+WRAPPER_INTERNAL void wrapper_keypool_after_fork(void);
+
+/* ---------- Signing (secp256k1_wrapper_sign.c) ---------- */
+
+/* Body of secp256k1_wrapper_sign_batch() on an already borrowed context.
+ * Arguments must have been validated and n must be non-zero. */
+WRAPPER_INTERNAL int wrapper_sign_batch(secp256k1_wrapper_ctx* wctx, const unsigned char* privkeys,
+                                        const unsigned char* hashes, size_t n, unsigned char* sigs_out,
+                                        size_t* sig_lens, int format, int* results);
+
+/* Same as wrapper_sign_batch() with the nonce entropy drawn by the caller:
+ * 32 bytes per item at `ndata`, or NULL if that draw failed, in which case
+ * every item fails with -3 */
+WRAPPER_INTERNAL int wrapper_sign_batch_entropy(secp256k1_wrapper_ctx* wctx, const unsigned char* privkeys,
+                                                const unsigned char* hashes, size_t n, unsigned char* sigs_out,
+                                                size_t* sig_lens, int format, const unsigned char* ndata,
+                                                int* results);
+
+/* ---------- Verification (secp256k1_wrapper_verify.c) ---------- */
+
+/* Checks item i of a verify batch: 0 if it is valid, nonzero otherwise */
+typedef int (*wrapper_verify_fn)(const void* items, size_t i);
+
+/* Checks n items, on the worker pool in parallel mode, and sets bit i of
+ * `valid_bitmap` ((n + 7) / 8 bytes, zeroed first; may be NULL) for each
+ * valid item. With `early_exit`, stops at the first invalid item. Returns 0
+ * if every item is valid, -4 otherwise. */
+WRAPPER_INTERNAL int wrapper_verify_run(size_t n, wrapper_verify_fn check, const void* items, int early_exit,
+                                        unsigned char* valid_bitmap);
+
+/* Item check of secp256k1_wrapper_verify_batch() for a valid `format` */
+WRAPPER_INTERNAL wrapper_verify_fn wrapper_verify_check(int format);
+
+/* ---------- Signature cache (secp256k1_wrapper_sigcache.c) ---------- */
+
+/* Hashes a verification triple into `digest` (32 bytes) and looks it up.
+ * Returns 1 on a hit, 0 on a miss, and -1 if no cache is active or the
+ * triple is too long to cache. */
+WRAPPER_INTERNAL int wrapper_sigcache_lookup(const secp256k1_wrapper_verify_item* item, int format,
+                                             unsigned char* digest);
+/* Records a digest from wrapper_sigcache_lookup() as verified */
+WRAPPER_INTERNAL void wrapper_sigcache_insert(const unsigned char* digest);
+
+/* ---------- Parsed public keys (secp256k1_wrapper_pubkey.c) ---------- */
+
+struct secp256k1_wrapper_pubkey {
+    secp256k1_pubkey pubkey;        // parsed form
+    unsigned char encoding[PUBKEY_UNCOMPRESSION_SIZE];
+    size_t encoding_len;
+    volatile uint64_t refs;
+
+    // Cache links, guarded by the lock of the entry's cache shard
+    uint64_t hash;
+    struct secp256k1_wrapper_pubkey* chain;   // next in the bucket
+    struct secp256k1_wrapper_pubkey* newer;
+    struct secp256k1_wrapper_pubkey* older;
+};
+
+/* Parses a public key through the handle cache. Returns 1 if `pubkey_out`
+ * was filled, 0 if the key is unparsable, and -1 if no cache is active (or
+ * it ran out of memory); the caller then parses the key itself. */
+WRAPPER_INTERNAL int wrapper_pubkey_cache_parse(const unsigned char* pubkey, size_t pubkey_len,
+                                                secp256k1_pubkey* pubkey_out);
+
+/* ---------- Batch operations (secp256k1_wrapper_batch.c) ---------- */
+
+/* Fills `n` private keys with one RNG request and redraws the rare ones out
+ * of range. Returns 1 on success, and 0 if the RNG failed. */
+WRAPPER_INTERNAL int wrapper_batch_draw_privkeys(const secp256k1_context* ctx, unsigned char* privkeys, size_t n);
+
+/* Derives the public keys of `n` freshly drawn private keys, wiping private
+ * keys that fail like wrapper_generate_keys_batch() does for `flags` */
+WRAPPER_INTERNAL int wrapper_batch_pubkeys(secp256k1_wrapper_ctx* wctx, unsigned char* privkeys_out,
+                                           unsigned char* pubkeys_out, size_t n, int compressed, int flags,
+                                           int* results);
+
+/* Body of secp256k1_wrapper_generate_keys_batch() on an already borrowed
+ * context. Arguments must have been validated and n must be non-zero. */
+WRAPPER_INTERNAL int wrapper_generate_keys_batch(secp256k1_wrapper_ctx* wctx, unsigned char* privkeys_out,
+                                                 unsigned char* pubkeys_out, size_t n, int compressed,
+                                                 int flags, int* results);
+
+/* Body of secp256k1_wrapper_derive_pubkey_batch() on an already borrowed
+ * context. Arguments must have been validated and n must be non-zero. */
+WRAPPER_INTERNAL int wrapper_derive_pubkey_batch(secp256k1_wrapper_ctx* wctx, const unsigned char* privkeys,
+                                                 unsigned char* pubkeys_out, size_t n, int compressed,
+                                                 int* results);
+
+/* ---------- Group arithmetic (secp256k1_wrapper_group.c) ---------- */
+
+/* Writes the public keys P, P + G, ..., P + (n - 1)G to `pubkeys_out`,
+ * with P given as a 65-byte uncompressed encoding. The points stay in
+ * Jacobian form and each block shares one field inversion. Variable time,
+ * for public points only. Returns 1 on success, and 0 if `start` is not a
+ * valid point or the range reaches infinity. */
+WRAPPER_INTERNAL int wrapper_group_range(const unsigned char* start, size_t n, unsigned char* pubkeys_out,
+                                         int compressed);
+
+/* ---------- Parallel batches (secp256k1_wrapper_parallel.c) ---------- */
+
+/* Processes items [begin, end) of a batch on the given context. Returns 0 or
+ * the code of the first failing item in the range. */
+typedef int (*wrapper_range_fn)(void* arg, secp256k1_wrapper_ctx* wctx, size_t begin, size_t end);
+
+/* Runs `fn` over [0, n) on the work-stealing pool, returning once every
+ * item is done. The range is split recursively down to the chunk size and
+ * the halves are stolen by idle workers, so `fn` sees arbitrary disjoint
+ * sub-ranges. Returns 1 with *result set to the code reported for the
+ * lowest-indexed failing range (0 if none) when the batch ran in parallel,
+ * or 0 if parallel mode is off, the batch fits in one chunk or the pool is
+ * unusable, in which case the caller runs the batch itself. */
+WRAPPER_INTERNAL int wrapper_parallel_run(size_t n, wrapper_range_fn fn, void* arg, int* result);
+
+#endif // SECP256K1_WRAPPER_INTERNAL_H
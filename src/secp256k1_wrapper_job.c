@@ -0,0 +1,167 @@
+/*
+ * secp256k1_wrapper - convenience wrapper around libsecp256k1
+ *
+ * Copyright (c) 2025 xXLegionBinFrogXx
+ *
+ * This file is licensed under the MIT License.
+ * See the LICENSE file in the project root for details.
+ *
+ * This project incorporates code from libsecp256k1,
+ * copyright (c) 2013 Bitcoin Core Developers, MIT License.
+ */
+
+/*
+ * Resumable batch jobs for cooperative schedulers.
+ *
+ * A job is a batch call cut into slices that the caller runs a few at a
+ * time with secp256k1_wrapper_job_step(), on the caller's own thread. Each
+ * slice is an ordinary batch call on the job's context, so the output is
+ * the same as running the whole batch at once; the time budget is checked
+ * between slices.
+ */
+
+#include "secp256k1_wrapper_internal.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/* Items per slice: small enough to keep step() near its time budget
+ * (a few hundred microseconds per slice) */
+#define JOB_SLICE 8
+
+#define JOB_GENERATE 0
+#define JOB_DERIVE   1
+
+struct secp256k1_wrapper_job {
+    int op;
+    const unsigned char* privkeys;  // derive input
+    unsigned char* privkeys_out;    // generate output
+    unsigned char* pubkeys_out;
+    int* results;
+    size_t n;
+    size_t done;
+    int compressed;
+    int flags;
+    int result;                     // first error so far
+    int finished;
+    secp256k1_wrapper_ctx wctx;
+};
+
+static secp256k1_wrapper_job* job_create(int op, size_t n, int compressed) {
+    secp256k1_wrapper_job* job = (secp256k1_wrapper_job*)calloc(1, sizeof(*job));
+    if (job == NULL) {
+        return NULL;
+    }
+    if (wrapper_ctx_open(&job->wctx, 1) != 0) {
+        free(job);
+        return NULL;
+    }
+    job->op = op;
+    job->n = n;
+    job->compressed = compressed;
+    job->finished = n == 0;
+    return job;
+}
+
+secp256k1_wrapper_job* secp256k1_wrapper_job_generate_keys(unsigned char* privkeys_out, unsigned char* pubkeys_out,
+                                                           size_t n, int compressed, int flags, int* results) {
+    if (privkeys_out == NULL || pubkeys_out == NULL || (compressed != 0 && compressed != 1) ||
+        (flags != SECP256K1_WRAPPER_BATCH_ALL_OR_NOTHING && flags != SECP256K1_WRAPPER_BATCH_PER_ITEM) ||
+        (flags == SECP256K1_WRAPPER_BATCH_PER_ITEM && results == NULL) ||
+        n > SIZE_MAX / PUBKEY_UNCOMPRESSION_SIZE) {
+        return NULL; // Invalid input
+    }
+    secp256k1_wrapper_job* job = job_create(JOB_GENERATE, n, compressed);
+    if (job != NULL) {
+        job->privkeys_out = privkeys_out;
+        job->pubkeys_out = pubkeys_out;
+        job->flags = flags;
+        job->results = results;
+    }
+    return job;
+}
+
+secp256k1_wrapper_job* secp256k1_wrapper_job_derive_pubkeys(const unsigned char* privkeys, unsigned char* pubkeys_out,
+                                                            size_t n, int compressed, int* results) {
+    if (privkeys == NULL || pubkeys_out == NULL || results == NULL || (compressed != 0 && compressed != 1) ||
+        n > SIZE_MAX / PUBKEY_UNCOMPRESSION_SIZE) {
+        return NULL; // Invalid input
+    }
+    secp256k1_wrapper_job* job = job_create(JOB_DERIVE, n, compressed);
+    if (job != NULL) {
+        job->privkeys = privkeys;
+        job->pubkeys_out = pubkeys_out;
+        job->results = results;
+    }
+    return job;
+}
+
+/* Runs items [done, done + count). Returns 0 or the slice's first error. */
+static int job_run_slice(secp256k1_wrapper_job* job, size_t count) {
+    size_t pubkey_size = job->compressed ? PUBKEY_COMPRESSION_SIZE : PUBKEY_UNCOMPRESSION_SIZE;
+    unsigned char* pubkeys_out = job->pubkeys_out + job->done * pubkey_size;
+    int* results = job->results != NULL ? job->results + job->done : NULL;
+
+    if (job->op == JOB_DERIVE) {
+        return wrapper_derive_pubkey_batch(&job->wctx, job->privkeys + job->done * PRIVKEY_SIZE, pubkeys_out,
+                                           count, job->compressed, results);
+    }
+    return wrapper_generate_keys_batch(&job->wctx, job->privkeys_out + job->done * PRIVKEY_SIZE, pubkeys_out,
+                                       count, job->compressed, job->flags, results);
+}
+
+int secp256k1_wrapper_job_step(secp256k1_wrapper_job* job, size_t max_items, uint64_t max_us) {
+    if (job == NULL) {
+        return -1; // Invalid input
+    }
+    uint64_t start = max_us != 0 ? wrapper_monotonic_us() : 0;
+    size_t budget = max_items != 0 ? max_items : SIZE_MAX;
+
+    while (!job->finished && budget > 0) {
+        size_t count = job->n - job->done;
+        if (count > JOB_SLICE) {
+            count = JOB_SLICE;
+        }
+        if (count > budget) {
+            count = budget;
+        }
+
+        int res = job_run_slice(job, count);
+        job->done += count;
+        budget -= count;
+        if (res != 0 && job->result == 0) {
+            job->result = res;
+        }
+        if (res != 0 && job->op == JOB_GENERATE && job->flags == SECP256K1_WRAPPER_BATCH_ALL_OR_NOTHING) {
+            secure_memzero(job->privkeys_out, job->done * PRIVKEY_SIZE);  // earlier slices too
+            job->finished = 1;
+            break;
+        }
+        if (job->done == job->n) {
+            job->finished = 1;
+        }
+        if (max_us != 0 && wrapper_monotonic_us() - start >= max_us) {
+            break;
+        }
+    }
+    return job->finished;
+}
+
+int secp256k1_wrapper_job_result(const secp256k1_wrapper_job* job, size_t* done) {
+    if (job == NULL) {
+        return -1; // Invalid input
+    }
+    if (done != NULL) {
+        *done = job->done;
+    }
+    return job->finished ? job->result : 1;
+}
+
+void secp256k1_wrapper_job_free(secp256k1_wrapper_job* job) {
+    if (job == NULL) {
+        return;
+    }
+    wrapper_ctx_close(&job->wctx);
+    secure_memzero(job, sizeof(*job));
+    free(job);
+}
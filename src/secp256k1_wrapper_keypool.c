@@ -0,0 +1,319 @@
+/*
+ * secp256k1_wrapper - convenience wrapper around libsecp256k1
+ *
+ * Copyright (c) 2025 xXLegionBinFrogXx
+ *
+ * This file is licensed under the MIT License.
+ * See the LICENSE file in the project root for details.
+ *
+ * This project incorporates code from libsecp256k1,
+ * copyright (c) 2013 Bitcoin Core Developers, MIT License.
+ */
+
+/*
+ * Pool of pre-generated key pairs.
+ *
+ * A background thread keeps a ring of ready key pairs topped up, so taking
+ * one is a copy under a short lock. The ring holds `count` ready pairs from
+ * `head` on; the free slots after them belong to the refill thread, which
+ * fills them with one batch call outside the lock and then publishes them.
+ *
+ * Private keys live in their own page-aligned mapping, locked into RAM where
+ * the OS allows it and excluded from core dumps. A taken slot is wiped at
+ * once. Pairs are never handed out twice: a fork()ed child wipes the ring
+ * and generates inline from then on, as its copy of the parent's keys would
+ * otherwise duplicate them.
+ */
+
+#include "secp256k1_wrapper_internal.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#if !defined(_WIN32)
+  #include <sys/mman.h>
+#endif
+
+typedef struct wrapper_keypool {
+    wrapper_mutex lock;         // guards head, count, stalled and shutdown
+    wrapper_cond refill_cv;
+    size_t head;
+    size_t count;
+    int stalled;                // last refill failed, wait for the next take
+    int shutdown;
+
+    size_t capacity;
+    size_t low_water;
+    int compressed;
+    size_t pubkey_size;
+    unsigned char* privkeys;    // secure mapping, capacity * PRIVKEY_SIZE
+    size_t privkeys_size;
+    unsigned char* pubkeys;
+    int locked;
+
+    volatile uint64_t hits;
+    volatile uint64_t misses;
+    volatile uint64_t refills;
+    volatile uint64_t refill_failures;
+
+    secp256k1_wrapper_ctx ctx;  // used by the refill thread only
+    wrapper_thread thread;
+    uint32_t fork_generation;   // the refill thread does not survive fork()
+} wrapper_keypool;
+
+static void* volatile g_keypool = NULL;
+
+/* ---------- Locked memory ---------- */
+
+/* Page-granular anonymous mapping for private keys. *locked is set if the
+ * pages could be pinned in RAM; failing that (RLIMIT_MEMLOCK) is not fatal. */
+static void* keypool_secure_alloc(size_t size, int* locked) {
+#if defined(_WIN32)
+    void* p = VirtualAlloc(NULL, size, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE);
+    if (p == NULL) {
+        return NULL;
+    }
+    *locked = VirtualLock(p, size) ? 1 : 0;
+    return p;
+#else
+    void* p = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (p == MAP_FAILED) {
+        return NULL;
+    }
+    *locked = mlock(p, size) == 0;
+  #if defined(MADV_DONTDUMP)
+    (void)madvise(p, size, MADV_DONTDUMP);
+  #endif
+  #if defined(MADV_WIPEONFORK)
+    (void)madvise(p, size, MADV_WIPEONFORK);  // belt and braces, the child handler wipes too
+  #endif
+    return p;
+#endif
+}
+
+static void keypool_secure_free(void* p, size_t size, int locked) {
+    secure_memzero(p, size);
+#if defined(_WIN32)
+    if (locked) {
+        (void)VirtualUnlock(p, size);
+    }
+    (void)VirtualFree(p, 0, MEM_RELEASE);
+#else
+    if (locked) {
+        (void)munlock(p, size);
+    }
+    (void)munmap(p, size);
+#endif
+}
+
+/* ---------- Refill ---------- */
+
+/* Fills `n` free slots starting at ring index `start`, wrapping at most
+ * once. Returns 0 or the batch error code. */
+static int keypool_fill(wrapper_keypool* kp, size_t start, size_t n) {
+    while (n > 0) {
+        size_t run = kp->capacity - start < n ? kp->capacity - start : n;
+        int res = wrapper_generate_keys_batch(&kp->ctx, kp->privkeys + start * PRIVKEY_SIZE,
+                                              kp->pubkeys + start * kp->pubkey_size, run, kp->compressed,
+                                              SECP256K1_WRAPPER_BATCH_ALL_OR_NOTHING, NULL);
+        if (res != 0) {
+            return res;
+        }
+        start = (start + run) % kp->capacity;
+        n -= run;
+    }
+    return 0;
+}
+
+/* Tops the ring up to capacity. Only the free slots are written, so takers
+ * are not blocked while keys are generated. */
+static int keypool_refill(wrapper_keypool* kp) {
+    wrapper_mutex_lock(&kp->lock);
+    size_t start = (kp->head + kp->count) % kp->capacity;
+    size_t missing = kp->capacity - kp->count;
+    wrapper_mutex_unlock(&kp->lock);
+
+    // Slots freed by takes meanwhile are picked up by the next refill
+    int res = keypool_fill(kp, start, missing);
+
+    wrapper_mutex_lock(&kp->lock);
+    if (res == 0) {
+        kp->count += missing;
+    } else {
+        kp->stalled = 1;
+    }
+    wrapper_mutex_unlock(&kp->lock);
+
+    wrapper_atomic_fetch_add_u64(res == 0 ? &kp->refills : &kp->refill_failures, 1);
+    return res;
+}
+
+static wrapper_thread_ret WRAPPER_THREAD_CALL keypool_thread_main(void* arg) {
+    wrapper_keypool* kp = (wrapper_keypool*)arg;
+
+    wrapper_mutex_lock(&kp->lock);
+    for (;;) {
+        while (!kp->shutdown && (kp->stalled || kp->count > kp->low_water)) {
+            wrapper_cond_wait(&kp->refill_cv, &kp->lock);
+        }
+        if (kp->shutdown) {
+            break;
+        }
+        wrapper_mutex_unlock(&kp->lock);
+        (void)keypool_refill(kp);
+        wrapper_mutex_lock(&kp->lock);
+    }
+    wrapper_mutex_unlock(&kp->lock);
+    return 0;
+}
+
+/* ---------- Public API ---------- */
+
+static void keypool_free(wrapper_keypool* kp) {
+    wrapper_ctx_close(&kp->ctx);
+    if (kp->privkeys != NULL) {
+        keypool_secure_free(kp->privkeys, kp->privkeys_size, kp->locked);
+    }
+    free(kp->pubkeys);
+    wrapper_cond_destroy(&kp->refill_cv);
+    wrapper_mutex_destroy(&kp->lock);
+    free(kp);
+}
+
+int secp256k1_wrapper_keypool_init(size_t capacity, size_t low_water, int compressed) {
+    if (capacity == 0 || low_water >= capacity || (compressed != 0 && compressed != 1) ||
+        capacity > SIZE_MAX / PUBKEY_UNCOMPRESSION_SIZE || wrapper_atomic_load_ptr(&g_keypool) != NULL) {
+        return -1; // Invalid input or already initialized
+    }
+
+    wrapper_keypool* kp = (wrapper_keypool*)calloc(1, sizeof(*kp));
+    if (kp == NULL) {
+        return -2;
+    }
+    wrapper_mutex_init(&kp->lock);
+    wrapper_cond_init(&kp->refill_cv);
+    kp->capacity = capacity;
+    kp->low_water = low_water;
+    kp->compressed = compressed;
+    kp->pubkey_size = compressed ? PUBKEY_COMPRESSION_SIZE : PUBKEY_UNCOMPRESSION_SIZE;
+    kp->privkeys_size = capacity * PRIVKEY_SIZE;
+    kp->privkeys = (unsigned char*)keypool_secure_alloc(kp->privkeys_size, &kp->locked);
+    kp->pubkeys = (unsigned char*)malloc(capacity * kp->pubkey_size);
+    if (kp->privkeys == NULL || kp->pubkeys == NULL) {
+        keypool_free(kp);
+        return -2;
+    }
+
+    int res = wrapper_ctx_open(&kp->ctx, 1);
+    if (res != 0) {
+        keypool_free(kp);
+        return res;
+    }
+
+    // First fill on the caller's thread: takes are fast from the start and errors surface here
+    res = keypool_fill(kp, 0, capacity);
+    if (res != 0) {
+        keypool_free(kp);
+        return res;
+    }
+    kp->count = capacity;
+    kp->refills = 1;
+
+    kp->fork_generation = wrapper_fork_generation();
+    if (!wrapper_thread_start(&kp->thread, keypool_thread_main, kp)) {
+        keypool_free(kp);
+        return -2;
+    }
+    wrapper_atomic_store_ptr(&g_keypool, kp);
+    return 0;
+}
+
+int secp256k1_wrapper_keypool_take(unsigned char* privkey_out, unsigned char* pubkey_out) {
+    if (privkey_out == NULL || pubkey_out == NULL) {
+        return -1; // Invalid input
+    }
+    wrapper_keypool* kp = (wrapper_keypool*)wrapper_atomic_load_ptr(&g_keypool);
+    if (kp == NULL) {
+        return -6; // Not initialized
+    }
+
+    if (kp->fork_generation == wrapper_fork_generation()) {
+        wrapper_mutex_lock(&kp->lock);
+        if (kp->count > 0) {
+            unsigned char* privkey = kp->privkeys + kp->head * PRIVKEY_SIZE;
+            memcpy(privkey_out, privkey, PRIVKEY_SIZE);
+            memcpy(pubkey_out, kp->pubkeys + kp->head * kp->pubkey_size, kp->pubkey_size);
+            secure_memzero(privkey, PRIVKEY_SIZE);
+            kp->head = (kp->head + 1) % kp->capacity;
+            kp->count--;
+            if (kp->count <= kp->low_water) {
+                kp->stalled = 0;
+                wrapper_cond_signal(&kp->refill_cv);
+            }
+            wrapper_mutex_unlock(&kp->lock);
+            wrapper_atomic_fetch_add_u64(&kp->hits, 1);
+            return 0;
+        }
+        kp->stalled = 0;  // let a failed refill retry
+        wrapper_cond_signal(&kp->refill_cv);
+        wrapper_mutex_unlock(&kp->lock);
+    }
+
+    // Ring empty, or this is a fork()ed child: generate inline
+    wrapper_atomic_fetch_add_u64(&kp->misses, 1);
+    return secp256k1_wrapper_generate_keys(privkey_out, pubkey_out, kp->compressed);
+}
+
+void secp256k1_wrapper_keypool_shutdown(void) {
+    wrapper_keypool* kp = (wrapper_keypool*)wrapper_atomic_load_ptr(&g_keypool);
+    if (kp == NULL) {
+        return;
+    }
+    wrapper_atomic_store_ptr(&g_keypool, NULL);
+
+    if (kp->fork_generation != wrapper_fork_generation()) {
+        // Inherited across fork(): no thread to join, and the lock may be held forever
+        keypool_secure_free(kp->privkeys, kp->privkeys_size, kp->locked);
+        return;
+    }
+    wrapper_mutex_lock(&kp->lock);
+    kp->shutdown = 1;
+    wrapper_cond_signal(&kp->refill_cv);
+    wrapper_mutex_unlock(&kp->lock);
+    wrapper_thread_join(kp->thread);
+    keypool_free(kp);
+}
+
+void secp256k1_wrapper_get_keypool_stats(secp256k1_wrapper_keypool_stats* stats) {
+    if (stats == NULL) {
+        return;
+    }
+    memset(stats, 0, sizeof(*stats));
+
+    wrapper_keypool* kp = (wrapper_keypool*)wrapper_atomic_load_ptr(&g_keypool);
+    if (kp == NULL) {
+        return;
+    }
+    stats->capacity = kp->capacity;
+    if (kp->fork_generation == wrapper_fork_generation()) {
+        wrapper_mutex_lock(&kp->lock);
+        stats->available = kp->count;
+        wrapper_mutex_unlock(&kp->lock);
+    }
+    stats->hits = wrapper_atomic_load_u64(&kp->hits);
+    stats->misses = wrapper_atomic_load_u64(&kp->misses);
+    stats->refills = wrapper_atomic_load_u64(&kp->refills);
+    stats->refill_failures = wrapper_atomic_load_u64(&kp->refill_failures);
+    stats->locked = kp->locked;
+}
+
+void wrapper_keypool_after_fork(void) {
+    wrapper_keypool* kp = (wrapper_keypool*)g_keypool;
+    if (kp == NULL) {
+        return;
+    }
+    /* The parent keeps handing out these keys; the child must never. The
+     * lock may have been held by a parent thread, so no locking here. */
+    secure_memzero(kp->privkeys, kp->privkeys_size);
+    kp->count = 0;
+}
@@ -0,0 +1,514 @@
+/*
+ * secp256k1_wrapper - convenience wrapper around libsecp256k1
+ *
+ * Copyright (c) 2025 xXLegionBinFrogXx
+ *
+ * This file is licensed under the MIT License.
+ * See the LICENSE file in the project root for details.
+ *
+ * This project incorporates code from libsecp256k1,
+ * copyright (c) 2013 Bitcoin Core Developers, MIT License.
+ */
+
+/*
+ * Work-stealing pool for parallel batch operations.
+ *
+ * A submitted batch becomes one range task [0, n) on a shared injector
+ * queue. A worker that picks up a range keeps halving it, pushing the upper
+ * half onto its own deque, until what is left fits in one chunk, which it
+ * then runs. Idle workers take from the injector or steal from the top of
+ * another worker's deque, which always holds the largest pending range, so
+ * a descheduled worker only delays the chunk it is running.
+ *
+ * The deques are Chase-Lev deques (Chase & Lev 2005, with the memory
+ * ordering of Le et al. 2013) over a fixed ring. Range splitting keeps at
+ * most log2(n / chunk) tasks on a deque, and a worker whose ring is full
+ * simply runs the range without splitting further.
+ *
+ * A worker that finds nothing to take or steal retries PARALLEL_SPIN times,
+ * then parks on work_cv until `pending` shows a task to take. Pushes wake a
+ * parked worker only when one is parked, so the split path stays lock-free.
+ *
+ * Every item writes to its own output slot, so the output is identical to a
+ * serial run whatever the schedule. Each worker owns a randomized context
+ * for its whole lifetime. Several batches may be in flight at once.
+ */
+
+#include "secp256k1_wrapper_internal.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define PARALLEL_MAX_THREADS 1024
+#define DEQUE_CAPACITY       64    // power of two
+#define CACHE_LINE           64
+/* Empty scans, each ending in a yield, before an idle worker parks */
+#define PARALLEL_SPIN        64
+
+typedef struct parallel_job {
+    wrapper_range_fn fn;
+    void* arg;
+    size_t n;
+    volatile uint64_t remaining;  // items not yet processed
+    size_t error_begin;           // start of the lowest failing range, SIZE_MAX if none
+    int error;
+    int done;
+    struct parallel_job* next;    // injector queue link
+} parallel_job;
+
+/* Slot fields are accessed atomically: a thief may read a slot that the
+ * owner is reusing, and then discards it when its CAS on `top` fails */
+typedef struct parallel_task {
+    void* volatile job;
+    volatile uint64_t begin;
+    volatile uint64_t end;
+} parallel_task;
+
+struct parallel_pool;
+
+typedef struct parallel_worker {
+    volatile uint64_t top;        // thieves take here
+    unsigned char pad0[CACHE_LINE - sizeof(uint64_t)];
+    volatile uint64_t bottom;     // owner pushes and pops here
+    unsigned char pad1[CACHE_LINE - sizeof(uint64_t)];
+    parallel_task ring[DEQUE_CAPACITY];
+
+    volatile uint64_t tasks;      // counters, written by the owner only
+    volatile uint64_t items;
+    volatile uint64_t steals;
+
+    struct parallel_pool* pool;
+    size_t index;
+    uint64_t victim_seed;
+    secp256k1_wrapper_ctx ctx;
+    wrapper_thread thread;
+} parallel_worker;
+
+typedef struct parallel_pool {
+    wrapper_mutex lock;           // guards the injector, done flags and shutdown
+    wrapper_cond work_cv;
+    wrapper_cond done_cv;
+    parallel_job* inject_head;
+    parallel_job* inject_tail;
+    volatile uint64_t injected;   // jobs on the injector, read without the lock
+    volatile uint64_t in_flight;  // unfinished jobs; idle workers park at once at 0
+    volatile uint64_t pending;    // tasks on the injector and deques, not yet taken
+    volatile uint64_t parked;     // workers waiting on work_cv
+    volatile uint64_t jobs;
+    volatile uint64_t steal_aborts;
+    int shutdown;
+    size_t threads;
+    size_t chunk;
+    uint32_t fork_generation;     // worker threads do not survive fork()
+    parallel_worker* workers;
+} parallel_pool;
+
+static void* volatile g_parallel = NULL;
+
+/* ---------- Threads ---------- */
+
+int wrapper_thread_start(wrapper_thread* thread, wrapper_thread_fn fn, void* arg) {
+#if defined(_WIN32)
+    *thread = CreateThread(NULL, 0, fn, arg, 0, NULL);
+    return *thread != NULL;
+#else
+    return pthread_create(thread, NULL, fn, arg) == 0;
+#endif
+}
+
+void wrapper_thread_join(wrapper_thread thread) {
+#if defined(_WIN32)
+    WaitForSingleObject(thread, INFINITE);
+    CloseHandle(thread);
+#else
+    (void)pthread_join(thread, NULL);
+#endif
+}
+
+/* ---------- Parking ---------- */
+
+/* Wakes a parked worker for a task just published; `pending` was raised
+ * before the task became visible, so it never drops below zero. The fence
+ * pairs with the one in worker_park(): either the pusher sees the parked
+ * count or the parking worker sees the raised `pending`. */
+static void pool_wake(parallel_pool* pool) {
+    wrapper_atomic_fence();
+    if (wrapper_atomic_load_u64(&pool->parked) > 0) {
+        wrapper_mutex_lock(&pool->lock);
+        wrapper_cond_signal(&pool->work_cv);
+        wrapper_mutex_unlock(&pool->lock);
+    }
+}
+
+static void pool_task_taken(parallel_pool* pool) {
+    wrapper_atomic_fetch_sub_u64(&pool->pending, 1);
+}
+
+/* Sleeps until a task is pending or the pool shuts down. Returns nonzero on
+ * shutdown. */
+static int worker_park(parallel_pool* pool) {
+    wrapper_mutex_lock(&pool->lock);
+    wrapper_atomic_fetch_add_u64(&pool->parked, 1);
+    wrapper_atomic_fence();
+    while (!pool->shutdown && wrapper_atomic_load_u64(&pool->pending) == 0) {
+        wrapper_cond_wait(&pool->work_cv, &pool->lock);
+    }
+    wrapper_atomic_fetch_sub_u64(&pool->parked, 1);
+    int stop = pool->shutdown;
+    wrapper_mutex_unlock(&pool->lock);
+    return stop;
+}
+
+/* ---------- Deque ---------- */
+
+/* Indices grow monotonically and are compared as signed values, since
+ * deque_take() briefly moves `bottom` below `top` */
+#define DEQUE_INDEX(i) ((int64_t)(i))
+
+static void task_store(parallel_task* slot, parallel_job* job, size_t begin, size_t end) {
+    wrapper_atomic_store_ptr(&slot->job, job);
+    wrapper_atomic_store_u64(&slot->begin, (uint64_t)begin);
+    wrapper_atomic_store_u64(&slot->end, (uint64_t)end);
+}
+
+static void task_load(parallel_task* slot, parallel_job** job, size_t* begin, size_t* end) {
+    *job = (parallel_job*)wrapper_atomic_load_ptr(&slot->job);
+    *begin = (size_t)wrapper_atomic_load_u64(&slot->begin);
+    *end = (size_t)wrapper_atomic_load_u64(&slot->end);
+}
+
+/* Owner only. Returns 0 if the ring is full. */
+static int deque_push(parallel_worker* w, parallel_job* job, size_t begin, size_t end) {
+    uint64_t b = wrapper_atomic_load_u64(&w->bottom);
+    uint64_t t = wrapper_atomic_load_u64(&w->top);
+    if (DEQUE_INDEX(b - t) >= DEQUE_CAPACITY) {
+        return 0;
+    }
+    task_store(&w->ring[b & (DEQUE_CAPACITY - 1)], job, begin, end);
+    wrapper_atomic_fetch_add_u64(&w->pool->pending, 1);
+    wrapper_atomic_store_u64(&w->bottom, b + 1);  // release publishes the slot
+    pool_wake(w->pool);
+    return 1;
+}
+
+/* Owner only, LIFO end. Returns 0 if the deque is empty. */
+static int deque_take(parallel_worker* w, parallel_job** job, size_t* begin, size_t* end) {
+    uint64_t b = wrapper_atomic_load_u64(&w->bottom) - 1;
+    wrapper_atomic_store_u64(&w->bottom, b);
+    wrapper_atomic_fence();
+    uint64_t t = wrapper_atomic_load_u64(&w->top);
+
+    if (DEQUE_INDEX(t) > DEQUE_INDEX(b)) {
+        wrapper_atomic_store_u64(&w->bottom, b + 1);  // empty
+        return 0;
+    }
+    task_load(&w->ring[b & (DEQUE_CAPACITY - 1)], job, begin, end);
+    if (t == b) {
+        // Last task: race the thieves for it
+        int won = wrapper_atomic_cas_u64(&w->top, &t, t + 1);
+        wrapper_atomic_store_u64(&w->bottom, b + 1);
+        return won;
+    }
+    return 1;
+}
+
+/* Any thread, FIFO end. Returns 1 on success, 0 if empty and -1 if it lost
+ * a race and the deque may still hold work. */
+static int deque_steal(parallel_worker* w, parallel_job** job, size_t* begin, size_t* end) {
+    uint64_t t = wrapper_atomic_load_u64(&w->top);
+    wrapper_atomic_fence();
+    uint64_t b = wrapper_atomic_load_u64(&w->bottom);
+
+    if (DEQUE_INDEX(t) >= DEQUE_INDEX(b)) {
+        return 0;
+    }
+    task_load(&w->ring[t & (DEQUE_CAPACITY - 1)], job, begin, end);
+    return wrapper_atomic_cas_u64(&w->top, &t, t + 1) ? 1 : -1;
+}
+
+/* ---------- Scheduling ---------- */
+
+static int injector_pop(parallel_pool* pool, parallel_job** job, size_t* begin, size_t* end) {
+    if (wrapper_atomic_load_u64(&pool->injected) == 0) {
+        return 0;
+    }
+    wrapper_mutex_lock(&pool->lock);
+    parallel_job* j = pool->inject_head;
+    if (j != NULL) {
+        pool->inject_head = j->next;
+        if (pool->inject_head == NULL) {
+            pool->inject_tail = NULL;
+        }
+        wrapper_atomic_store_u64(&pool->injected, wrapper_atomic_load_u64(&pool->injected) - 1);
+    }
+    wrapper_mutex_unlock(&pool->lock);
+    if (j == NULL) {
+        return 0;
+    }
+    pool_task_taken(pool);
+    *job = j;
+    *begin = 0;
+    *end = j->n;
+    return 1;
+}
+
+/* Tries every other worker once, starting at a pseudo-random victim */
+static int steal_any(parallel_worker* self, parallel_job** job, size_t* begin, size_t* end) {
+    parallel_pool* pool = self->pool;
+
+    self->victim_seed ^= self->victim_seed << 13;
+    self->victim_seed ^= self->victim_seed >> 7;
+    self->victim_seed ^= self->victim_seed << 17;
+    size_t start = (size_t)(self->victim_seed % pool->threads);
+
+    for (size_t i = 0; i < pool->threads; i++) {
+        parallel_worker* victim = &pool->workers[(start + i) % pool->threads];
+        if (victim == self) {
+            continue;
+        }
+        int res;
+        while ((res = deque_steal(victim, job, begin, end)) < 0) {
+            wrapper_atomic_fetch_add_u64(&pool->steal_aborts, 1);
+        }
+        if (res > 0) {
+            pool_task_taken(pool);
+            wrapper_atomic_fetch_add_u64(&self->steals, 1);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static void job_finish_range(parallel_pool* pool, parallel_job* job, size_t begin, size_t end, int res) {
+    if (res != 0) {
+        wrapper_mutex_lock(&pool->lock);
+        if (begin < job->error_begin) {
+            job->error_begin = begin;
+            job->error = res;
+        }
+        wrapper_mutex_unlock(&pool->lock);
+    }
+    uint64_t count = (uint64_t)(end - begin);
+    if (wrapper_atomic_fetch_sub_u64(&job->remaining, count) == count) {
+        wrapper_mutex_lock(&pool->lock);
+        job->done = 1;
+        wrapper_atomic_store_u64(&pool->in_flight, wrapper_atomic_load_u64(&pool->in_flight) - 1);
+        wrapper_cond_broadcast(&pool->done_cv);
+        wrapper_mutex_unlock(&pool->lock);
+    }
+}
+
+/* Splits the range down to one chunk, leaving the upper halves to thieves */
+static void run_range(parallel_worker* w, parallel_job* job, size_t begin, size_t end) {
+    size_t chunk = w->pool->chunk;
+    while (end - begin > chunk) {
+        size_t mid = begin + (end - begin) / 2;
+        if (!deque_push(w, job, mid, end)) {
+            break;  // ring full, run the rest here
+        }
+        end = mid;
+    }
+
+    int res = job->fn(job->arg, &w->ctx, begin, end);
+    wrapper_atomic_fetch_add_u64(&w->tasks, 1);
+    wrapper_atomic_fetch_add_u64(&w->items, (uint64_t)(end - begin));
+    job_finish_range(w->pool, job, begin, end, res);
+}
+
+static wrapper_thread_ret WRAPPER_THREAD_CALL parallel_worker_main(void* arg) {
+    parallel_worker* worker = (parallel_worker*)arg;
+    parallel_pool* pool = worker->pool;
+    int idle = 0;
+
+    for (;;) {
+        parallel_job* job;
+        size_t begin, end;
+        if (deque_take(worker, &job, &begin, &end)) {
+            pool_task_taken(pool);
+            run_range(worker, job, begin, end);
+            idle = 0;
+            continue;
+        }
+        if (injector_pop(pool, &job, &begin, &end) || steal_any(worker, &job, &begin, &end)) {
+            run_range(worker, job, begin, end);
+            idle = 0;
+            continue;
+        }
+
+        // Nothing to take: retry briefly while a batch is running, then park
+        if (wrapper_atomic_load_u64(&pool->in_flight) > 0 && ++idle < PARALLEL_SPIN) {
+            wrapper_thread_yield();
+            continue;
+        }
+        idle = 0;
+        if (worker_park(pool)) {
+            break;
+        }
+    }
+    return 0;
+}
+
+/* ---------- Pool ---------- */
+
+/* Stops and joins the first `started` workers, then frees everything */
+static void parallel_pool_free(parallel_pool* pool, size_t started) {
+    wrapper_mutex_lock(&pool->lock);
+    pool->shutdown = 1;
+    wrapper_cond_broadcast(&pool->work_cv);
+    wrapper_mutex_unlock(&pool->lock);
+
+    for (size_t i = 0; i < started; i++) {
+        wrapper_thread_join(pool->workers[i].thread);
+    }
+    for (size_t i = 0; i < pool->threads; i++) {
+        wrapper_ctx_close(&pool->workers[i].ctx);
+    }
+    wrapper_cond_destroy(&pool->done_cv);
+    wrapper_cond_destroy(&pool->work_cv);
+    wrapper_mutex_destroy(&pool->lock);
+    free(pool->workers);
+    free(pool);
+}
+
+static int parallel_pool_create(size_t threads, size_t chunk, parallel_pool** out) {
+    parallel_pool* pool = (parallel_pool*)calloc(1, sizeof(*pool));
+    if (pool == NULL) {
+        return -2;
+    }
+    pool->workers = (parallel_worker*)calloc(threads, sizeof(parallel_worker));
+    if (pool->workers == NULL) {
+        free(pool);
+        return -2;
+    }
+    wrapper_mutex_init(&pool->lock);
+    wrapper_cond_init(&pool->work_cv);
+    wrapper_cond_init(&pool->done_cv);
+    pool->threads = threads;
+    pool->chunk = chunk;
+    pool->fork_generation = wrapper_fork_generation();
+
+    // Contexts first, so a failure leaves no threads to stop
+    for (size_t i = 0; i < threads; i++) {
+        parallel_worker* w = &pool->workers[i];
+        w->pool = pool;
+        w->index = i;
+        w->top = w->bottom = 1;
+        w->victim_seed = 0x9E3779B97F4A7C15ull * (uint64_t)(i + 1);  // any non-zero xorshift seed
+        int res = wrapper_ctx_open(&w->ctx, 1);
+        if (res != 0) {
+            parallel_pool_free(pool, 0);
+            return res;
+        }
+    }
+    for (size_t i = 0; i < threads; i++) {
+        if (!wrapper_thread_start(&pool->workers[i].thread, parallel_worker_main, &pool->workers[i])) {
+            parallel_pool_free(pool, i);
+            return -2;
+        }
+    }
+    *out = pool;
+    return 0;
+}
+
+int secp256k1_wrapper_set_parallel(size_t threads, size_t chunk_size) {
+    if (threads > PARALLEL_MAX_THREADS) {
+        return -1; // Invalid input
+    }
+    if (chunk_size == 0) {
+        chunk_size = SECP256K1_WRAPPER_PARALLEL_CHUNK_DEFAULT;
+    }
+
+    wrapper_fork_guard();
+    parallel_pool* old = (parallel_pool*)wrapper_atomic_load_ptr(&g_parallel);
+    wrapper_atomic_store_ptr(&g_parallel, NULL);
+    if (old != NULL) {
+        if (old->fork_generation == wrapper_fork_generation()) {
+            parallel_pool_free(old, old->threads);
+        }
+        // else: inherited across fork() without its threads; nothing to join, leak it
+    }
+
+    if (threads <= 1) {
+        return 0; // Serial mode
+    }
+    parallel_pool* pool = NULL;
+    int res = parallel_pool_create(threads, chunk_size, &pool);
+    if (res != 0) {
+        return res;
+    }
+    wrapper_atomic_store_ptr(&g_parallel, pool);
+    return 0;
+}
+
+size_t secp256k1_wrapper_get_parallel_stats(secp256k1_wrapper_parallel_stats* stats,
+                                            secp256k1_wrapper_worker_stats* workers, size_t max_workers) {
+    if (stats != NULL) {
+        memset(stats, 0, sizeof(*stats));
+    }
+    parallel_pool* pool = (parallel_pool*)wrapper_atomic_load_ptr(&g_parallel);
+    if (pool == NULL) {
+        return 0;
+    }
+
+    size_t written = 0;
+    for (size_t i = 0; i < pool->threads; i++) {
+        parallel_worker* w = &pool->workers[i];
+        uint64_t tasks = wrapper_atomic_load_u64(&w->tasks);
+        uint64_t items = wrapper_atomic_load_u64(&w->items);
+        uint64_t steals = wrapper_atomic_load_u64(&w->steals);
+        if (stats != NULL) {
+            stats->tasks += tasks;
+            stats->items += items;
+            stats->steals += steals;
+        }
+        if (workers != NULL && i < max_workers) {
+            workers[i].tasks = tasks;
+            workers[i].items = items;
+            workers[i].steals = steals;
+            written++;
+        }
+    }
+    if (stats != NULL) {
+        stats->threads = pool->threads;
+        stats->jobs = wrapper_atomic_load_u64(&pool->jobs);
+        stats->steal_aborts = wrapper_atomic_load_u64(&pool->steal_aborts);
+    }
+    return written;
+}
+
+int wrapper_parallel_run(size_t n, wrapper_range_fn fn, void* arg, int* result) {
+    parallel_pool* pool = (parallel_pool*)wrapper_atomic_load_ptr(&g_parallel);
+    if (pool == NULL || n <= pool->chunk || pool->fork_generation != wrapper_fork_generation()) {
+        return 0;
+    }
+
+    parallel_job job;
+    job.fn = fn;
+    job.arg = arg;
+    job.n = n;
+    job.remaining = (uint64_t)n;
+    job.error_begin = SIZE_MAX;
+    job.error = 0;
+    job.done = 0;
+    job.next = NULL;
+
+    wrapper_mutex_lock(&pool->lock);
+    if (pool->inject_tail != NULL) {
+        pool->inject_tail->next = &job;
+    } else {
+        pool->inject_head = &job;
+    }
+    pool->inject_tail = &job;
+    wrapper_atomic_store_u64(&pool->injected, wrapper_atomic_load_u64(&pool->injected) + 1);
+    wrapper_atomic_store_u64(&pool->in_flight, wrapper_atomic_load_u64(&pool->in_flight) + 1);
+    wrapper_atomic_fetch_add_u64(&pool->jobs, 1);
+    wrapper_atomic_fetch_add_u64(&pool->pending, 1);
+    wrapper_cond_signal(&pool->work_cv);  // the lock is held: no parked worker can miss it
+    while (!job.done) {
+        wrapper_cond_wait(&pool->done_cv, &pool->lock);
+    }
+    wrapper_mutex_unlock(&pool->lock);
+
+    *result = job.error;
+    return 1;
+}
@@ -0,0 +1,252 @@
+/*
+ * secp256k1_wrapper - convenience wrapper around libsecp256k1
+ *
+ * Copyright (c) 2025 xXLegionBinFrogXx
+ *
+ * This file is licensed under the MIT License.
+ * See the LICENSE file in the project root for details.
+ *
+ * This project incorporates code from libsecp256k1,
+ * copyright (c) 2013 Bitcoin Core Developers, MIT License.
+ */
+
+/*
+ * Bounded pool of pre-randomized contexts.
+ *
+ * The free list is a Treiber stack over a fixed node array. The head packs a
+ * 32-bit node index with a 32-bit tag that is bumped on every update, so a
+ * single 64-bit CAS is enough to rule out ABA without double-width atomics.
+ *
+ * In preallocated mode the pool header, the nodes and the contexts themselves
+ * are carved out of caller-supplied (or static) memory, so borrowing and
+ * using a pooled context never touches the heap.
+ */
+
+#include "secp256k1_wrapper_internal.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define POOL_NIL       0xFFFFFFFFu
+#define POOL_MAX_SIZE  0xFFFFFFFEu
+
+/* Cache-line alignment for everything placed in preallocated memory */
+#define PREALLOC_ALIGN 64
+
+/* Storage used by secp256k1_wrapper_ctx_pool_init_preallocated(NULL, ...) */
+#ifndef SECP256K1_WRAPPER_STATIC_ARENA_SIZE
+  #define SECP256K1_WRAPPER_STATIC_ARENA_SIZE 16384
+#endif
+
+#define HEAD_INDEX(h)  ((uint32_t)((h) & 0xFFFFFFFFu))
+#define HEAD_TAG(h)    ((uint32_t)((h) >> 32))
+#define HEAD_MAKE(tag, index) (((uint64_t)(tag) << 32) | (uint64_t)(index))
+
+typedef struct pool_node {
+    secp256k1_wrapper_ctx ctx;  // must stay first, release() casts back
+    volatile uint32_t next;
+} pool_node;
+
+typedef struct wrapper_ctx_pool {
+    volatile uint64_t head;
+    volatile uint64_t hits;
+    volatile uint64_t misses;
+    volatile uint64_t contention;
+    size_t size;
+    pool_node* nodes;
+    int preallocated;  // header, nodes and contexts live in external memory
+} wrapper_ctx_pool;
+
+static void* volatile g_pool = NULL;
+
+static union {
+    void* align_ptr;
+    uint64_t align_u64;
+    double align_dbl;
+    unsigned char bytes[SECP256K1_WRAPPER_STATIC_ARENA_SIZE];
+} g_static_arena;
+
+static size_t prealloc_align(size_t n) {
+    return (n + PREALLOC_ALIGN - 1) & ~(size_t)(PREALLOC_ALIGN - 1);
+}
+
+static void pool_push(wrapper_ctx_pool* pool, uint32_t index) {
+    uint64_t old = wrapper_atomic_load_u64(&pool->head);
+    for (;;) {
+        wrapper_atomic_store_u32(&pool->nodes[index].next, HEAD_INDEX(old));
+        if (wrapper_atomic_cas_u64(&pool->head, &old, HEAD_MAKE(HEAD_TAG(old) + 1, index))) {
+            return;
+        }
+        wrapper_atomic_fetch_add_u64(&pool->contention, 1);
+    }
+}
+
+static uint32_t pool_pop(wrapper_ctx_pool* pool) {
+    uint64_t old = wrapper_atomic_load_u64(&pool->head);
+    for (;;) {
+        uint32_t index = HEAD_INDEX(old);
+        if (index == POOL_NIL) {
+            return POOL_NIL;
+        }
+        /* May read a stale link if the node was popped and pushed back
+         * meanwhile; the tag makes the CAS below fail in that case */
+        uint32_t next = wrapper_atomic_load_u32(&pool->nodes[index].next);
+        if (wrapper_atomic_cas_u64(&pool->head, &old, HEAD_MAKE(HEAD_TAG(old) + 1, next))) {
+            return index;
+        }
+        wrapper_atomic_fetch_add_u64(&pool->contention, 1);
+    }
+}
+
+static void pool_free(wrapper_ctx_pool* pool) {
+    for (size_t i = 0; i < pool->size; i++) {
+        wrapper_ctx_close(&pool->nodes[i].ctx);
+    }
+    if (!pool->preallocated) {
+        free(pool->nodes);
+        free(pool);
+    }
+}
+
+/* Opens and randomizes every context, then publishes the pool. Contexts are
+ * randomized up front so acquire never pays for blinding. `ctx_mem` is NULL
+ * for heap contexts, or points at size * ctx_stride bytes of storage. */
+static int pool_populate(wrapper_ctx_pool* pool, unsigned char* ctx_mem, size_t ctx_stride) {
+    pool->head = HEAD_MAKE(0, POOL_NIL);
+    for (size_t i = 0; i < pool->size; i++) {
+        int res = ctx_mem != NULL
+            ? wrapper_ctx_open_preallocated(&pool->nodes[i].ctx, ctx_mem + i * ctx_stride, 1)
+            : wrapper_ctx_open(&pool->nodes[i].ctx, 1);
+        if (res != 0) {
+            pool->size = i;  // only close what was opened
+            pool_free(pool);
+            return res;
+        }
+        pool_push(pool, (uint32_t)i);
+    }
+    pool->contention = 0;
+
+    wrapper_atomic_store_ptr(&g_pool, pool);
+    return 0;
+}
+
+int secp256k1_wrapper_ctx_pool_init(size_t size) {
+    if (size == 0 || size > POOL_MAX_SIZE || wrapper_atomic_load_ptr(&g_pool) != NULL) {
+        return -1; // Invalid input or already initialized
+    }
+
+    wrapper_ctx_pool* pool = (wrapper_ctx_pool*)calloc(1, sizeof(*pool));
+    if (pool == NULL) {
+        return -2;
+    }
+    pool->nodes = (pool_node*)calloc(size, sizeof(pool_node));
+    if (pool->nodes == NULL) {
+        free(pool);
+        return -2;
+    }
+    pool->size = size;
+    return pool_populate(pool, NULL, 0);
+}
+
+size_t secp256k1_wrapper_ctx_pool_preallocated_size(size_t count) {
+    if (count == 0 || count > POOL_MAX_SIZE) {
+        return 0;
+    }
+    size_t ctx_size = prealloc_align(secp256k1_context_preallocated_size(SECP256K1_CONTEXT_SIGN));
+    size_t fixed = (PREALLOC_ALIGN - 1) + prealloc_align(sizeof(wrapper_ctx_pool));
+    if (count > (SIZE_MAX - fixed) / (ctx_size + sizeof(pool_node) + PREALLOC_ALIGN)) {
+        return 0; // Would overflow
+    }
+    return fixed + prealloc_align(count * sizeof(pool_node)) + count * ctx_size;
+}
+
+int secp256k1_wrapper_ctx_pool_init_preallocated(void* mem, size_t mem_size, size_t count) {
+    if (mem == NULL) {
+        mem = g_static_arena.bytes;
+        mem_size = sizeof(g_static_arena.bytes);
+    }
+
+    size_t needed = secp256k1_wrapper_ctx_pool_preallocated_size(count);
+    if (needed == 0 || mem_size < needed || wrapper_atomic_load_ptr(&g_pool) != NULL) {
+        return -1; // Invalid input, too little memory or already initialized
+    }
+
+    // Layout: [pool header][nodes][context 0][context 1]...
+    unsigned char* base = (unsigned char*)mem;
+    base += prealloc_align((size_t)(uintptr_t)base) - (size_t)(uintptr_t)base;
+
+    wrapper_ctx_pool* pool = (wrapper_ctx_pool*)base;
+    memset(pool, 0, sizeof(*pool));
+    base += prealloc_align(sizeof(wrapper_ctx_pool));
+
+    pool->nodes = (pool_node*)base;
+    memset(pool->nodes, 0, count * sizeof(pool_node));
+    base += prealloc_align(count * sizeof(pool_node));
+
+    pool->size = count;
+    pool->preallocated = 1;
+    return pool_populate(pool, base, prealloc_align(secp256k1_context_preallocated_size(SECP256K1_CONTEXT_SIGN)));
+}
+
+void secp256k1_wrapper_ctx_pool_shutdown(void) {
+    wrapper_ctx_pool* pool = (wrapper_ctx_pool*)wrapper_atomic_load_ptr(&g_pool);
+    if (pool == NULL) {
+        return;
+    }
+    wrapper_atomic_store_ptr(&g_pool, NULL);
+    pool_free(pool);
+}
+
+void secp256k1_wrapper_ctx_pool_stats(secp256k1_wrapper_pool_stats* stats) {
+    if (stats == NULL) {
+        return;
+    }
+    memset(stats, 0, sizeof(*stats));
+
+    wrapper_ctx_pool* pool = (wrapper_ctx_pool*)wrapper_atomic_load_ptr(&g_pool);
+    if (pool == NULL) {
+        return;
+    }
+    stats->size = pool->size;
+    stats->hits = wrapper_atomic_load_u64(&pool->hits);
+    stats->misses = wrapper_atomic_load_u64(&pool->misses);
+    stats->contention = wrapper_atomic_load_u64(&pool->contention);
+}
+
+void wrapper_ctx_pool_after_fork(void) {
+    wrapper_ctx_pool* pool = (wrapper_ctx_pool*)g_pool;
+    if (pool == NULL) {
+        return;
+    }
+    /* Contexts borrowed by other parent threads are never coming back, and
+     * a CAS may have been cut short by the fork, so start from scratch */
+    uint32_t head = POOL_NIL;
+    for (size_t i = 0; i < pool->size; i++) {
+        pool->nodes[i].next = head;
+        head = (uint32_t)i;
+    }
+    pool->head = HEAD_MAKE(0, head);
+}
+
+secp256k1_wrapper_ctx* wrapper_ctx_pool_acquire(void) {
+    wrapper_ctx_pool* pool = (wrapper_ctx_pool*)wrapper_atomic_load_ptr(&g_pool);
+    if (pool == NULL) {
+        return NULL;
+    }
+    uint32_t index = pool_pop(pool);
+    if (index == POOL_NIL) {
+        wrapper_atomic_fetch_add_u64(&pool->misses, 1);
+        return NULL;
+    }
+    wrapper_atomic_fetch_add_u64(&pool->hits, 1);
+    return &pool->nodes[index].ctx;
+}
+
+void wrapper_ctx_pool_release(secp256k1_wrapper_ctx* wctx) {
+    wrapper_ctx_pool* pool = (wrapper_ctx_pool*)wrapper_atomic_load_ptr(&g_pool);
+    if (pool == NULL || wctx == NULL) {
+        return;
+    }
+    pool_node* node = (pool_node*)wctx;
+    pool_push(pool, (uint32_t)(node - pool->nodes));
+}
@@ -0,0 +1,380 @@
+/*
+ * secp256k1_wrapper - convenience wrapper around libsecp256k1
+ *
+ * Copyright (c) 2025 xXLegionBinFrogXx
+ *
+ * This file is licensed under the MIT License.
+ * See the LICENSE file in the project root for details.
+ *
+ * This project incorporates code from libsecp256k1,
+ * copyright (c) 2013 Bitcoin Core Developers, MIT License.
+ */
+
+/*
+ * Parsed public key handles and their LRU cache.
+ *
+ * A handle keeps libsecp256k1's parsed form of a public key next to the
+ * encoding it came from, so verifying against it skips the parse and, for
+ * compressed keys, the square root that recovers y. Handles are reference
+ * counted: the cache owns one reference to each entry and every caller of
+ * secp256k1_wrapper_pubkey_parse() another, so an evicted handle stays
+ * valid until its last holder releases it.
+ *
+ * The cache is striped into up to PUBKEY_CACHE_SHARDS shards picked by key
+ * hash, so parallel verify workers rarely meet on a lock even though every
+ * hit updates the recency list. Each shard is a hash table of entries
+ * chained by bucket, threaded on a list from most to least recently used,
+ * under its own mutex, and holds its share of the capacity; eviction is LRU
+ * within the shard. Keys are parsed outside the lock. Hashes mix the x
+ * coordinate with a random salt, so chosen keys cannot pile into one shard
+ * or chain. A fork()ed child bypasses the cache, as a parent thread may
+ * have held a lock.
+ */
+
+#include "secp256k1_wrapper_internal.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define PUBKEY_CACHE_SHARDS 16
+
+typedef struct pubkey_cache_shard {
+    wrapper_mutex lock;
+    secp256k1_wrapper_pubkey** buckets;
+    size_t bucket_mask;
+    size_t capacity;
+    size_t size;
+    secp256k1_wrapper_pubkey* newest;
+    secp256k1_wrapper_pubkey* oldest;
+
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t evictions;
+    unsigned char pad[64];      // keeps neighbouring locks off one cache line
+} pubkey_cache_shard;
+
+typedef struct wrapper_pubkey_cache {
+    pubkey_cache_shard* shards;
+    size_t shard_mask;
+    size_t capacity;
+    uint64_t salt;
+    uint32_t fork_generation;   // the locks are unusable after fork()
+} wrapper_pubkey_cache;
+
+static void* volatile g_pubkey_cache = NULL;
+
+static int pubkey_encoding_ok(const unsigned char* pubkey, size_t pubkey_len) {
+    return pubkey != NULL && (pubkey_len == PUBKEY_COMPRESSION_SIZE || pubkey_len == PUBKEY_UNCOMPRESSION_SIZE);
+}
+
+/* ---------- Handles ---------- */
+
+static secp256k1_wrapper_pubkey* pubkey_handle_parse(const unsigned char* pubkey, size_t pubkey_len, int* res) {
+    secp256k1_wrapper_pubkey* handle = (secp256k1_wrapper_pubkey*)calloc(1, sizeof(*handle));
+    if (handle == NULL) {
+        *res = -2;
+        return NULL;
+    }
+    if (!secp256k1_ec_pubkey_parse(secp256k1_context_static, &handle->pubkey, pubkey, pubkey_len)) {
+        free(handle);
+        *res = -5;
+        return NULL;
+    }
+    memcpy(handle->encoding, pubkey, pubkey_len);
+    handle->encoding_len = pubkey_len;
+    handle->refs = 1;
+    *res = 0;
+    return handle;
+}
+
+static void pubkey_handle_retain(secp256k1_wrapper_pubkey* handle) {
+    wrapper_atomic_fetch_add_u64(&handle->refs, 1);
+}
+
+void secp256k1_wrapper_pubkey_release(secp256k1_wrapper_pubkey* handle) {
+    if (handle != NULL && wrapper_atomic_fetch_sub_u64(&handle->refs, 1) == 1) {
+        free(handle);
+    }
+}
+
+/* ---------- Cache ---------- */
+
+/* splitmix64 finalizer */
+static uint64_t pubkey_mix(uint64_t x) {
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+/* Hashes the x coordinate and the encoding's prefix byte */
+static uint64_t pubkey_hash(const wrapper_pubkey_cache* c, const unsigned char* pubkey) {
+    uint64_t h = c->salt ^ pubkey[0];
+    for (int w = 0; w < 4; w++) {
+        uint64_t word;
+        memcpy(&word, pubkey + 1 + w * 8, sizeof(word));
+        h = pubkey_mix(h ^ word);
+    }
+    return h;
+}
+
+/* Shards take the high half of the hash, buckets the low half */
+static pubkey_cache_shard* pubkey_cache_shard_of(const wrapper_pubkey_cache* c, uint64_t hash) {
+    return &c->shards[(size_t)(hash >> 32) & c->shard_mask];
+}
+
+/* The shard's lock is held */
+static secp256k1_wrapper_pubkey* pubkey_cache_find(const pubkey_cache_shard* c, uint64_t hash,
+                                                   const unsigned char* pubkey, size_t pubkey_len) {
+    secp256k1_wrapper_pubkey* e = c->buckets[hash & c->bucket_mask];
+    for (; e != NULL; e = e->chain) {
+        if (e->hash == hash && e->encoding_len == pubkey_len && memcmp(e->encoding, pubkey, pubkey_len) == 0) {
+            return e;
+        }
+    }
+    return NULL;
+}
+
+static void pubkey_cache_unlink(pubkey_cache_shard* c, secp256k1_wrapper_pubkey* e) {
+    if (e->newer != NULL) {
+        e->newer->older = e->older;
+    } else {
+        c->newest = e->older;
+    }
+    if (e->older != NULL) {
+        e->older->newer = e->newer;
+    } else {
+        c->oldest = e->newer;
+    }
+    e->newer = e->older = NULL;
+}
+
+static void pubkey_cache_push(pubkey_cache_shard* c, secp256k1_wrapper_pubkey* e) {
+    e->newer = NULL;
+    e->older = c->newest;
+    if (c->newest != NULL) {
+        c->newest->newer = e;
+    } else {
+        c->oldest = e;
+    }
+    c->newest = e;
+}
+
+/* Drops the least recently used entry; returns it for release outside the lock */
+static secp256k1_wrapper_pubkey* pubkey_cache_evict(pubkey_cache_shard* c) {
+    secp256k1_wrapper_pubkey* e = c->oldest;
+    secp256k1_wrapper_pubkey** link = &c->buckets[e->hash & c->bucket_mask];
+    while (*link != e) {
+        link = &(*link)->chain;
+    }
+    *link = e->chain;
+    e->chain = NULL;
+    pubkey_cache_unlink(c, e);
+    c->size--;
+    c->evictions++;
+    return e;
+}
+
+static wrapper_pubkey_cache* pubkey_cache_active(void) {
+    wrapper_pubkey_cache* c = (wrapper_pubkey_cache*)wrapper_atomic_load_ptr(&g_pubkey_cache);
+    if (c == NULL || c->fork_generation != wrapper_fork_generation()) {
+        return NULL;
+    }
+    return c;
+}
+
+/* Returns a handle holding a reference for the caller, from the cache or
+ * parsed and inserted. Sets *res to 0, -2 or -5. */
+static secp256k1_wrapper_pubkey* pubkey_cache_get(wrapper_pubkey_cache* cache, const unsigned char* pubkey,
+                                                  size_t pubkey_len, int* res) {
+    uint64_t hash = pubkey_hash(cache, pubkey);
+    pubkey_cache_shard* c = pubkey_cache_shard_of(cache, hash);
+
+    wrapper_mutex_lock(&c->lock);
+    secp256k1_wrapper_pubkey* e = pubkey_cache_find(c, hash, pubkey, pubkey_len);
+    if (e != NULL) {
+        pubkey_cache_unlink(c, e);
+        pubkey_cache_push(c, e);
+        pubkey_handle_retain(e);
+        c->hits++;
+        wrapper_mutex_unlock(&c->lock);
+        *res = 0;
+        return e;
+    }
+    c->misses++;
+    wrapper_mutex_unlock(&c->lock);
+
+    secp256k1_wrapper_pubkey* parsed = pubkey_handle_parse(pubkey, pubkey_len, res);
+    if (parsed == NULL) {
+        return NULL;  // unparsable keys are not cached
+    }
+    parsed->hash = hash;
+
+    secp256k1_wrapper_pubkey* evicted = NULL;
+    wrapper_mutex_lock(&c->lock);
+    e = pubkey_cache_find(c, hash, pubkey, pubkey_len);
+    if (e == NULL) {
+        if (c->size == c->capacity) {
+            evicted = pubkey_cache_evict(c);
+        }
+        e = parsed;
+        e->chain = c->buckets[hash & c->bucket_mask];
+        c->buckets[hash & c->bucket_mask] = e;
+        pubkey_cache_push(c, e);
+        c->size++;
+        parsed = NULL;  // the cache owns the first reference
+    }
+    pubkey_handle_retain(e);
+    wrapper_mutex_unlock(&c->lock);
+
+    secp256k1_wrapper_pubkey_release(parsed);  // another thread inserted the key first
+    secp256k1_wrapper_pubkey_release(evicted);
+    return e;
+}
+
+/* ---------- Verification hook ---------- */
+
+int wrapper_pubkey_cache_parse(const unsigned char* pubkey, size_t pubkey_len, secp256k1_pubkey* pubkey_out) {
+    wrapper_pubkey_cache* c = pubkey_cache_active();
+    if (c == NULL || !pubkey_encoding_ok(pubkey, pubkey_len)) {
+        return -1;
+    }
+    int res;
+    secp256k1_wrapper_pubkey* handle = pubkey_cache_get(c, pubkey, pubkey_len, &res);
+    if (handle == NULL) {
+        return res == -5 ? 0 : -1;  // out of memory: let the caller parse
+    }
+    *pubkey_out = handle->pubkey;
+    secp256k1_wrapper_pubkey_release(handle);
+    return 1;
+}
+
+/* ---------- Public API ---------- */
+
+int secp256k1_wrapper_pubkey_parse(const unsigned char* pubkey, size_t pubkey_len,
+                                   secp256k1_wrapper_pubkey** handle_out) {
+    if (handle_out == NULL) {
+        return -1; // Invalid input
+    }
+    *handle_out = NULL;
+    if (!pubkey_encoding_ok(pubkey, pubkey_len)) {
+        return -1; // Invalid input
+    }
+
+    int res;
+    wrapper_pubkey_cache* c = pubkey_cache_active();
+    *handle_out = c != NULL ? pubkey_cache_get(c, pubkey, pubkey_len, &res)
+                            : pubkey_handle_parse(pubkey, pubkey_len, &res);
+    return res;
+}
+
+/* Frees the shards' bucket arrays and the cache itself */
+static void pubkey_cache_free(wrapper_pubkey_cache* c) {
+    if (c->shards != NULL) {
+        for (size_t i = 0; i <= c->shard_mask; i++) {
+            free(c->shards[i].buckets);
+        }
+        free(c->shards);
+    }
+    free(c);
+}
+
+int secp256k1_wrapper_pubkey_cache_init(size_t capacity) {
+    if (capacity == 0 || capacity > SIZE_MAX / 2 / sizeof(secp256k1_wrapper_pubkey*) ||
+        wrapper_atomic_load_ptr(&g_pubkey_cache) != NULL) {
+        return -1; // Invalid capacity or already initialized
+    }
+
+    // Every shard holds at least one key
+    size_t shards = 1;
+    while (shards < PUBKEY_CACHE_SHARDS && shards * 2 <= capacity) {
+        shards <<= 1;
+    }
+
+    wrapper_pubkey_cache* c = (wrapper_pubkey_cache*)calloc(1, sizeof(*c));
+    if (c == NULL) {
+        return -2;
+    }
+    c->shards = (pubkey_cache_shard*)calloc(shards, sizeof(*c->shards));
+    if (c->shards == NULL) {
+        free(c);
+        return -2;
+    }
+    c->shard_mask = shards - 1;
+    for (size_t i = 0; i < shards; i++) {
+        pubkey_cache_shard* shard = &c->shards[i];
+        shard->capacity = capacity / shards + (i < capacity % shards);
+        size_t buckets = 1;
+        while (buckets < shard->capacity) {
+            buckets <<= 1;
+        }
+        shard->buckets = (secp256k1_wrapper_pubkey**)calloc(buckets, sizeof(*shard->buckets));
+        if (shard->buckets == NULL) {
+            pubkey_cache_free(c);
+            return -2;
+        }
+        shard->bucket_mask = buckets - 1;
+    }
+    unsigned char salt[sizeof(c->salt)];
+    if (!secp256k1_wrapper_fill_random(salt, sizeof(salt))) {
+        pubkey_cache_free(c);
+        return -3;
+    }
+    memcpy(&c->salt, salt, sizeof(c->salt));
+    c->capacity = capacity;
+    for (size_t i = 0; i < shards; i++) {
+        wrapper_mutex_init(&c->shards[i].lock);
+    }
+    wrapper_fork_guard();
+    c->fork_generation = wrapper_fork_generation();
+
+    wrapper_atomic_store_ptr(&g_pubkey_cache, c);
+    return 0;
+}
+
+void secp256k1_wrapper_pubkey_cache_shutdown(void) {
+    wrapper_pubkey_cache* c = (wrapper_pubkey_cache*)wrapper_atomic_load_ptr(&g_pubkey_cache);
+    if (c == NULL) {
+        return;
+    }
+    wrapper_atomic_store_ptr(&g_pubkey_cache, NULL);
+
+    int own_locks = c->fork_generation == wrapper_fork_generation();
+    for (size_t i = 0; i <= c->shard_mask; i++) {
+        // Handles still held by callers outlive the cache
+        secp256k1_wrapper_pubkey* e = c->shards[i].newest;
+        while (e != NULL) {
+            secp256k1_wrapper_pubkey* older = e->older;
+            e->chain = e->newer = e->older = NULL;
+            secp256k1_wrapper_pubkey_release(e);
+            e = older;
+        }
+        if (own_locks) {
+            wrapper_mutex_destroy(&c->shards[i].lock);  // inherited across fork(), it may be held forever
+        }
+    }
+    pubkey_cache_free(c);
+}
+
+void secp256k1_wrapper_get_pubkey_cache_stats(secp256k1_wrapper_pubkey_cache_stats* stats) {
+    if (stats == NULL) {
+        return;
+    }
+    memset(stats, 0, sizeof(*stats));
+
+    wrapper_pubkey_cache* c = pubkey_cache_active();
+    if (c == NULL) {
+        return;
+    }
+    stats->capacity = c->capacity;
+    for (size_t i = 0; i <= c->shard_mask; i++) {
+        pubkey_cache_shard* shard = &c->shards[i];
+        wrapper_mutex_lock(&shard->lock);
+        stats->size += shard->size;
+        stats->hits += shard->hits;
+        stats->misses += shard->misses;
+        stats->evictions += shard->evictions;
+        wrapper_mutex_unlock(&shard->lock);
+    }
+}
@@ -0,0 +1,650 @@
+/*
+ * secp256k1_wrapper - convenience wrapper around libsecp256k1
+ *
+ * Copyright (c) 2025 xXLegionBinFrogXx
+ *
+ * This file is licensed under the MIT License.
+ * See the LICENSE file in the project root for details.
+ *
+ * This project incorporates code from libsecp256k1,
+ * copyright (c) 2013 Bitcoin Core Developers, MIT License.
+ */
+
+/*
+ * Random number generation: the per-OS system CSPRNG (through the vDSO on
+ * Linux kernels that export vgetrandom), an optional per-thread buffer in
+ * front of it that amortizes one system call over many small requests, and a
+ * per-thread ChaCha20 DRBG seeded from the system CSPRNG.
+ */
+
+#define __STDC_WANT_LIB_EXT1__ 1
+
+#include <string.h>
+#include <stdlib.h>
+
+/* ---------- Platform headers ---------- */
+
+#if defined(_WIN32)
+  /*
+   * The defined WIN32_NO_STATUS macro disables return code definitions in
+   * windows.h, which avoids "macro redefinition" MSVC warnings in ntstatus.h.
+   */
+  #define WIN32_NO_STATUS
+  #include <windows.h>
+  #undef WIN32_NO_STATUS
+  #include <ntstatus.h>
+  #include <bcrypt.h>
+  #include <limits.h>
+#elif defined(__linux__) || defined(__FreeBSD__)
+  #include <sys/random.h>
+  #include <sys/stat.h>
+  #include <errno.h>
+  #include <fcntl.h>
+  #include <pthread.h>
+  #include <unistd.h>
+  #if defined(__linux__)
+    #include <sys/auxv.h>
+    #include <sys/mman.h>
+    #include <elf.h>
+    #include <link.h>
+    #define WRAPPER_HAVE_VGETRANDOM 1
+  #endif
+#elif defined(__APPLE__)
+  // CCRandomGenerateBytes (in libSystem)
+  #include <CommonCrypto/CommonRandom.h>   
+  #if defined(USE_SECURITY_RNG)
+    #include <Security/SecRandom.h>        
+  #endif
+  #include <sys/random.h>               
+  #include <unistd.h>
+#elif defined(__OpenBSD__) || defined(__FreeBSD__) || defined(__NetBSD__)
+  #include <sys/random.h>  
+  #include <unistd.h>
+  #include <stdlib.h>                     
+#else
+  #error "Couldn't identify the OS"
+#endif
+
+#include "secp256k1_wrapper_internal.h"
+
+/* Requests larger than this fraction of the buffer bypass it */
+#define RNG_BYPASS_DIVISOR 4
+
+/* DRBG output between reseeds from the system CSPRNG, and the largest
+ * amount produced under one key before it is erased */
+#define DRBG_RESEED_INTERVAL (1024u * 1024u)
+#define DRBG_MAX_REQUEST     (64u * 1024u)
+
+/* Keystream blocks computed up front by each DRBG call; the first 32 bytes
+ * become the next key. 8 blocks keep the AVX2 kernel busy. */
+#define DRBG_HEAD_BLOCKS 8
+
+static volatile int g_rng_source = SECP256K1_WRAPPER_RNG_SYSTEM;
+static volatile uint64_t g_rng_buffer_size = SECP256K1_WRAPPER_RNG_BUFFER_DEFAULT;
+
+/* ---------- Linux vDSO getrandom ---------- */
+
+#if defined(WRAPPER_HAVE_VGETRANDOM)
+
+/* Returned by vgetrandom(NULL, 0, 0, &params, ~0UL), see the kernel's
+ * include/uapi/linux/random.h */
+struct vgetrandom_opaque_params {
+    uint32_t size_of_opaque_state;
+    uint32_t mmap_prot;
+    uint32_t mmap_flags;
+    uint32_t reserved[13];
+};
+
+typedef ssize_t (*vgetrandom_fn)(void* buffer, size_t len, unsigned int flags, void* opaque_state, size_t opaque_len);
+
+static pthread_once_t g_vgetrandom_once = PTHREAD_ONCE_INIT;
+static vgetrandom_fn g_vgetrandom = NULL;
+static struct vgetrandom_opaque_params g_vgetrandom_params;
+static size_t g_vgetrandom_map_size;    // opaque state rounded up to a page
+static pthread_key_t g_vgetrandom_key;  // unmaps a thread's state at exit
+
+/* The calling thread's opaque state. Kept in plain TLS rather than in
+ * wrapper_thread_state, so a thread's first call allocates nothing from the
+ * heap (the preallocated context pool promises that). */
+static __thread void* t_vgetrandom_state = NULL;
+
+/* Number of dynamic symbols covered by a DT_GNU_HASH table: one past the
+ * highest symbol index reachable from any bucket. */
+static size_t vdso_gnu_hash_count(const uint32_t* table) {
+    uint32_t nbuckets = table[0];
+    uint32_t symoffset = table[1];
+    uint32_t bloom_size = table[2];
+    const uint32_t* buckets = (const uint32_t*)((const ElfW(Addr)*)(table + 4) + bloom_size);
+    const uint32_t* chain = buckets + nbuckets;
+
+    uint32_t last = 0;
+    for (uint32_t i = 0; i < nbuckets; i++) {
+        if (buckets[i] > last) {
+            last = buckets[i];
+        }
+    }
+    if (last < symoffset) {
+        return symoffset;
+    }
+    while ((chain[last - symoffset] & 1) == 0) {  // low bit marks the end of a chain
+        last++;
+    }
+    return (size_t)last + 1;
+}
+
+/* Finds the address of the first defined function among `names` in the
+ * vDSO image the kernel mapped into this process. Returns 0 if absent. */
+static uintptr_t vdso_lookup(const char* const* names, size_t count) {
+    uintptr_t base = (uintptr_t)getauxval(AT_SYSINFO_EHDR);
+    if (base == 0) {
+        return 0;
+    }
+    const ElfW(Ehdr)* ehdr = (const ElfW(Ehdr)*)base;
+    if (memcmp(ehdr->e_ident, ELFMAG, SELFMAG) != 0) {
+        return 0;
+    }
+
+    const ElfW(Phdr)* phdr = (const ElfW(Phdr)*)(base + ehdr->e_phoff);
+    const ElfW(Dyn)* dyn = NULL;
+    uintptr_t load_offset = 0;
+    int have_load = 0;
+    for (size_t i = 0; i < ehdr->e_phnum; i++) {
+        if (phdr[i].p_type == PT_LOAD && !have_load) {
+            load_offset = base + phdr[i].p_offset - phdr[i].p_vaddr;
+            have_load = 1;
+        } else if (phdr[i].p_type == PT_DYNAMIC) {
+            dyn = (const ElfW(Dyn)*)(base + phdr[i].p_offset);
+        }
+    }
+    if (!have_load || dyn == NULL) {
+        return 0;
+    }
+
+    const ElfW(Sym)* symtab = NULL;
+    const char* strtab = NULL;
+    const uint32_t* hash = NULL;
+    const uint32_t* gnu_hash = NULL;
+    for (; dyn->d_tag != DT_NULL; dyn++) {
+        uintptr_t addr = load_offset + dyn->d_un.d_ptr;
+        switch (dyn->d_tag) {
+        case DT_SYMTAB: symtab = (const ElfW(Sym)*)addr; break;
+        case DT_STRTAB: strtab = (const char*)addr; break;
+        case DT_HASH:   hash = (const uint32_t*)addr; break;
+#if defined(DT_GNU_HASH)
+        case DT_GNU_HASH: gnu_hash = (const uint32_t*)addr; break;
+#endif
+        default: break;
+        }
+    }
+    if (symtab == NULL || strtab == NULL || (hash == NULL && gnu_hash == NULL)) {
+        return 0;
+    }
+
+    size_t nsyms = hash != NULL ? hash[1] : vdso_gnu_hash_count(gnu_hash);
+    for (size_t i = 0; i < nsyms; i++) {
+        const ElfW(Sym)* sym = &symtab[i];
+        if ((sym->st_info & 0xf) != STT_FUNC || sym->st_shndx == SHN_UNDEF) {
+            continue;
+        }
+        for (size_t n = 0; n < count; n++) {
+            if (strcmp(strtab + sym->st_name, names[n]) == 0) {
+                return load_offset + sym->st_value;
+            }
+        }
+    }
+    return 0;
+}
+
+/* Thread-exit destructor of g_vgetrandom_key */
+static void vgetrandom_state_unmap(void* state) {
+    t_vgetrandom_state = NULL;  // a later destructor may still ask for random bytes
+    munmap(state, g_vgetrandom_map_size);
+}
+
+static void vgetrandom_resolve(void) {
+    /* x86-64 and LoongArch use the first name, arm64, powerpc and s390 the second */
+    static const char* const names[] = { "__vdso_getrandom", "__kernel_getrandom" };
+    uintptr_t addr = vdso_lookup(names, sizeof(names) / sizeof(names[0]));
+    if (addr == 0) {
+        return;
+    }
+
+    vgetrandom_fn fn = (vgetrandom_fn)addr;
+    struct vgetrandom_opaque_params params;
+    memset(&params, 0, sizeof(params));
+    if (fn(NULL, 0, 0, &params, ~(size_t)0) != 0 || params.size_of_opaque_state == 0 ||
+        pthread_key_create(&g_vgetrandom_key, vgetrandom_state_unmap) != 0) {
+        return;
+    }
+    long page = sysconf(_SC_PAGESIZE);
+    size_t len = params.size_of_opaque_state;
+    if (page > 0) {
+        len = (len + (size_t)page - 1) & ~((size_t)page - 1);
+    }
+    g_vgetrandom_map_size = len;
+    g_vgetrandom_params = params;
+    g_vgetrandom = fn;
+}
+
+/* Maps the calling thread's opaque state with the protection and flags the
+ * kernel asked for. The kernel wipes it in a fork child by itself. The key
+ * only carries the mapping to the exit destructor; setting one of the first
+ * few keys needs no heap in glibc or musl. */
+static void* vgetrandom_state(void) {
+    void* state = t_vgetrandom_state;
+    if (state == NULL) {
+        state = mmap(NULL, g_vgetrandom_map_size, (int)g_vgetrandom_params.mmap_prot,
+                     (int)g_vgetrandom_params.mmap_flags, -1, 0);
+        if (state == MAP_FAILED) {
+            return NULL;
+        }
+        if (pthread_setspecific(g_vgetrandom_key, state) != 0) {
+            munmap(state, g_vgetrandom_map_size);
+            return NULL;
+        }
+        t_vgetrandom_state = state;
+    }
+    return state;
+}
+
+/* Unmaps the calling thread's opaque state, if it has one */
+static void vgetrandom_release(void) {
+    void* state = t_vgetrandom_state;
+    if (state != NULL) {
+        (void)pthread_setspecific(g_vgetrandom_key, NULL);
+        t_vgetrandom_state = NULL;
+        munmap(state, g_vgetrandom_map_size);
+    }
+}
+
+/* Fills as much of `data` as the vDSO will give without a system call.
+ * Returns the number of bytes written; the caller takes the rest from the
+ * getrandom path. */
+static size_t vgetrandom_fill(unsigned char* data, size_t size) {
+    if (pthread_once(&g_vgetrandom_once, vgetrandom_resolve) != 0 || g_vgetrandom == NULL) {
+        return 0;
+    }
+    void* state = vgetrandom_state();
+    if (state == NULL) {
+        return 0;
+    }
+
+    size_t done = 0;
+    while (done < size) {
+        /* Errors are returned in-band as negative errno values */
+        ssize_t res = g_vgetrandom(data + done, size - done, 0, state, g_vgetrandom_params.size_of_opaque_state);
+        if (res < 0) {
+            if (res == -EINTR) {
+                continue;
+            }
+            break;
+        }
+        done += (size_t)res;
+    }
+    return done;
+}
+
+#endif /* WRAPPER_HAVE_VGETRANDOM */
+
+/* ---------- getrandom and /dev/urandom ---------- */
+
+#if defined(__linux__) || defined(__FreeBSD__)
+
+/* Set once getrandom has failed with ENOSYS, so old kernels pay for the
+ * failed system call only once */
+static volatile int g_getrandom_missing = 0;
+
+/* Process-wide /dev/urandom descriptor. It is opened once with O_CLOEXEC and
+ * never closed, so a reader can never race with a close. */
+static pthread_mutex_t g_urandom_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_once_t g_urandom_atfork_once = PTHREAD_ONCE_INIT;
+static int g_urandom_fd = -1;
+static int g_urandom_check = 0;  // revalidate before the next use
+static dev_t g_urandom_rdev;
+static ino_t g_urandom_ino;
+
+static void urandom_atfork_prepare(void) {
+    pthread_mutex_lock(&g_urandom_lock);
+}
+
+static void urandom_atfork_parent(void) {
+    pthread_mutex_unlock(&g_urandom_lock);
+}
+
+/* The child may close or renumber descriptors (daemons usually do) */
+static void urandom_atfork_child(void) {
+    g_urandom_check = 1;
+    pthread_mutex_unlock(&g_urandom_lock);
+}
+
+static void urandom_atfork_register(void) {
+    (void)pthread_atfork(urandom_atfork_prepare, urandom_atfork_parent, urandom_atfork_child);
+}
+
+/* Returns 1 if `fd` still refers to the device opened earlier */
+static int urandom_fd_matches(int fd) {
+    struct stat sb;
+    return fstat(fd, &sb) == 0 && S_ISCHR(sb.st_mode) &&
+           sb.st_rdev == g_urandom_rdev && sb.st_ino == g_urandom_ino;
+}
+
+/* Returns the shared descriptor, opening it on first use. Returns -1 on failure. */
+static int urandom_fd(void) {
+    (void)pthread_once(&g_urandom_atfork_once, urandom_atfork_register);
+    pthread_mutex_lock(&g_urandom_lock);
+
+    if (g_urandom_fd >= 0 && g_urandom_check) {
+        if (!urandom_fd_matches(g_urandom_fd)) {
+            g_urandom_fd = -1;  // the number belongs to someone else now, leave it open
+        }
+        g_urandom_check = 0;
+    }
+
+    if (g_urandom_fd < 0) {
+        int fd;
+        do {
+            fd = open("/dev/urandom", O_RDONLY | O_CLOEXEC);
+        } while (fd < 0 && errno == EINTR);
+
+        struct stat sb;
+        if (fd >= 0 && fstat(fd, &sb) == 0 && S_ISCHR(sb.st_mode)) {
+            g_urandom_rdev = sb.st_rdev;
+            g_urandom_ino = sb.st_ino;
+            g_urandom_fd = fd;
+        } else if (fd >= 0) {
+            close(fd);
+        }
+    }
+
+    int fd = g_urandom_fd;
+    pthread_mutex_unlock(&g_urandom_lock);
+    return fd;
+}
+
+/* Both readers loop over short reads: getrandom returns at most 32 MiB per
+ * call, and either can be interrupted by a signal. */
+static int urandom_fill(unsigned char* data, size_t size) {
+    int fd = urandom_fd();
+    if (fd < 0) {
+        return 0;
+    }
+    while (size > 0) {
+        ssize_t res = read(fd, data, size);
+        if (res < 0 && errno == EINTR) {
+            continue;
+        }
+        if (res <= 0) {
+            return 0;
+        }
+        data += res;
+        size -= (size_t)res;
+    }
+    return 1;
+}
+
+static int getrandom_fill(unsigned char* data, size_t size) {
+    if (wrapper_atomic_load_int(&g_getrandom_missing)) {
+        return urandom_fill(data, size);
+    }
+    while (size > 0) {
+        ssize_t res = getrandom(data, size, 0);
+        if (res < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno == ENOSYS) {
+                wrapper_atomic_store_int(&g_getrandom_missing, 1);
+                return urandom_fill(data, size);
+            }
+            return 0;
+        }
+        data += res;
+        size -= (size_t)res;
+    }
+    return 1;
+}
+
+#endif
+
+/* Reads straight from the operating system's CSPRNG.
+ * Returns 1 on success, and 0 on failure. */
+static int os_fill_random(unsigned char* data, size_t size) {
+#if defined(_WIN32)
+
+    if (size > ULONG_MAX) return 0;
+    NTSTATUS res = BCryptGenRandom(NULL, data, (ULONG)size, BCRYPT_USE_SYSTEM_PREFERRED_RNG);
+    return res == STATUS_SUCCESS;
+
+#elif defined(__linux__) || defined(__FreeBSD__)
+
+    #if defined(WRAPPER_HAVE_VGETRANDOM)
+    size_t done = vgetrandom_fill(data, size);
+    if (done == size) {
+        return 1;
+    }
+    data += done;
+    size -= done;
+    #endif
+
+    return getrandom_fill(data, size);
+
+#elif defined(__APPLE__)
+
+    #if defined(USE_SECURITY_RNG)
+        if (SecRandomCopyBytes(kSecRandomDefault, size, data) == errSecSuccess) return 1;
+    #endif
+
+    // Try CCRandomGenerateBytes (macOS 10.7+)
+    if (CCRandomGenerateBytes(data, size) == kCCSuccess) {
+        return 1;
+    }
+    // Try getentropy (macOS 10.12+), limited to 256 bytes
+    #if defined(__MAC_10_12)
+    if (size <= 256 && getentropy(data, size) == 0) {
+        return 1;
+    }
+    #endif
+   return 0;
+
+#elif defined(__OpenBSD__)
+    // getentropy() on OpenBSD is limited to 256 bytes per call
+    if (size <= 256 && getentropy(data, size) == 0) {
+        return 1;
+    }
+    return 0;
+
+#else
+    #error "Couldn't identify the OS"
+#endif
+}
+
+/* ---------- ChaCha20 DRBG ---------- */
+
+/* One fast-key-erasure step: expands the current key into a keystream,
+ * keeps its first 32 bytes as the next key and returns the following `size`
+ * bytes. The old key is overwritten before returning, so output already
+ * handed out cannot be recomputed from a later state compromise.
+ * `size` must not exceed DRBG_MAX_REQUEST. */
+static void drbg_generate(wrapper_drbg* drbg, unsigned char* out, size_t size) {
+    static const unsigned char nonce[12] = {0};
+    unsigned char head[DRBG_HEAD_BLOCKS * 64];
+    unsigned char next_key[32];
+
+    wrapper_chacha20_blocks(drbg->key, nonce, 0, head, DRBG_HEAD_BLOCKS);
+    memcpy(next_key, head, sizeof(next_key));
+
+    size_t n = sizeof(head) - sizeof(next_key);
+    if (n > size) {
+        n = size;
+    }
+    memcpy(out, head + sizeof(next_key), n);
+
+    /* The rest of the stream continues block-aligned, straight into out */
+    size_t rest = size - n;
+    if (rest > 0) {
+        size_t full = rest / 64;
+        uint32_t counter = DRBG_HEAD_BLOCKS;
+        wrapper_chacha20_blocks(drbg->key, nonce, counter, out + n, full);
+        if (rest % 64 != 0) {
+            wrapper_chacha20_blocks(drbg->key, nonce, counter + (uint32_t)full, head, 1);
+            memcpy(out + n + full * 64, head, rest % 64);
+        }
+    }
+
+    memcpy(drbg->key, next_key, sizeof(next_key));
+    drbg->bytes_since_reseed += size;
+    secure_memzero(next_key, sizeof(next_key));
+    secure_memzero(head, sizeof(head));
+}
+
+/* Mixes fresh system entropy into the key. Returns 1 on success, 0 on failure. */
+static int drbg_reseed(wrapper_drbg* drbg) {
+    unsigned char seed[32];
+    wrapper_fork_guard();
+    if (!os_fill_random(seed, sizeof(seed))) {
+        return 0;
+    }
+    for (size_t i = 0; i < sizeof(seed); i++) {
+        drbg->key[i] ^= seed[i];
+    }
+    secure_memzero(seed, sizeof(seed));
+    drbg->bytes_since_reseed = 0;
+    drbg->fork_generation = wrapper_fork_generation();
+    drbg->seeded = 1;
+    return 1;
+}
+
+/* Fills `data` from the thread's DRBG, reseeding on first use, after a fork
+ * and every DRBG_RESEED_INTERVAL bytes. Returns 1 on success, 0 on failure. */
+static int drbg_fill(wrapper_drbg* drbg, unsigned char* data, size_t size) {
+    while (size > 0) {
+        /* The child inherits the parent's key: never let both produce the same stream */
+        if (!drbg->seeded || drbg->fork_generation != wrapper_fork_generation() ||
+            drbg->bytes_since_reseed >= DRBG_RESEED_INTERVAL) {
+            if (!drbg_reseed(drbg)) {
+                return 0;
+            }
+        }
+        size_t n = size < DRBG_MAX_REQUEST ? size : DRBG_MAX_REQUEST;
+        drbg_generate(drbg, data, n);
+        data += n;
+        size -= n;
+    }
+    return 1;
+}
+
+/* ---------- Buffered mode ---------- */
+
+void wrapper_rng_thread_free(wrapper_thread_state* st) {
+    wrapper_rng_buffer* buf = &st->rng;
+    if (buf->data != NULL) {
+        secure_memzero(buf->data, buf->size);
+        free(buf->data);
+        buf->data = NULL;
+    }
+    buf->size = 0;
+    buf->pos = 0;
+    secure_memzero(&st->drbg, sizeof(st->drbg));
+}
+
+/* Serves `size` bytes from the calling thread's buffer, refilling it with one
+ * system call (or one DRBG call) when it runs dry. Consumed bytes are wiped
+ * immediately so a later memory disclosure cannot reveal keys already
+ * generated from them.
+ * Returns -1 if the buffer is unavailable and the caller should go direct. */
+static int buffered_fill_random(unsigned char* data, size_t size, size_t capacity, int source) {
+    wrapper_thread_state* st = wrapper_thread_state_get();
+    if (st == NULL) {
+        return -1;
+    }
+    wrapper_rng_buffer* buf = &st->rng;
+
+    if (buf->data != NULL && buf->size != capacity) {
+        wrapper_rng_thread_free(st);  // resized since the last call
+    }
+    if (buf->data == NULL) {
+        wrapper_fork_guard();
+        buf->data = (unsigned char*)malloc(capacity);
+        if (buf->data == NULL) {
+            return -1;
+        }
+        buf->size = capacity;
+        buf->pos = capacity;  // empty, forces a refill below
+    }
+
+    /* Bytes buffered before a fork are also in the parent's copy: drop them */
+    if (buf->fork_generation != wrapper_fork_generation()) {
+        buf->pos = buf->size;
+    }
+
+    if (buf->size - buf->pos < size) {
+        int ok = source == SECP256K1_WRAPPER_RNG_CHACHA20
+            ? drbg_fill(&st->drbg, buf->data, buf->size)
+            : os_fill_random(buf->data, buf->size);
+        if (!ok) {
+            secure_memzero(buf->data, buf->size);
+            buf->pos = buf->size;
+            return 0;
+        }
+        buf->pos = 0;
+        buf->fork_generation = wrapper_fork_generation();
+    }
+
+    memcpy(data, buf->data + buf->pos, size);
+    secure_memzero(buf->data + buf->pos, size);
+    buf->pos += size;
+    return 1;
+}
+
+int secp256k1_wrapper_set_rng(int source, size_t buffer_size) {
+    if (buffer_size == 0) {
+        buffer_size = SECP256K1_WRAPPER_RNG_BUFFER_DEFAULT;
+    }
+    switch (source) {
+    case SECP256K1_WRAPPER_RNG_SYSTEM:
+        break;
+    case SECP256K1_WRAPPER_RNG_BUFFERED:
+    case SECP256K1_WRAPPER_RNG_CHACHA20:
+        if (buffer_size < SECP256K1_WRAPPER_RNG_BUFFER_MIN || buffer_size > SECP256K1_WRAPPER_RNG_BUFFER_MAX) {
+            return -1; // Invalid input
+        }
+        break;
+    default:
+        return -1; // Invalid input
+    }
+    wrapper_atomic_store_u64(&g_rng_buffer_size, (uint64_t)buffer_size);
+    wrapper_atomic_store_int(&g_rng_source, source);
+    return 0;
+}
+
+void secp256k1_wrapper_rng_thread_release(void) {
+#if defined(WRAPPER_HAVE_VGETRANDOM)
+    vgetrandom_release();
+#endif
+    wrapper_thread_state* st = wrapper_thread_state_peek();
+    if (st == NULL) {
+        return;
+    }
+    wrapper_rng_thread_free(st);
+}
+
+/* Returns 1 on success, and 0 on failure. */
+int secp256k1_wrapper_fill_random(unsigned char* data, size_t size) {
+    int source = wrapper_atomic_load_int(&g_rng_source);
+    if (source != SECP256K1_WRAPPER_RNG_SYSTEM) {
+        size_t capacity = (size_t)wrapper_atomic_load_u64(&g_rng_buffer_size);
+        if (size <= capacity / RNG_BYPASS_DIVISOR) {
+            int res = buffered_fill_random(data, size, capacity, source);
+            if (res >= 0) {
+                return res;
+            }
+        } else if (source == SECP256K1_WRAPPER_RNG_CHACHA20) {
+            // Bulk requests skip the buffer but still come from the DRBG
+            wrapper_thread_state* st = wrapper_thread_state_get();
+            if (st != NULL) {
+                return drbg_fill(&st->drbg, data, size);
+            }
+        }
+    }
+    return os_fill_random(data, size);
+}
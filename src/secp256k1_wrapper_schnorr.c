@@ -0,0 +1,264 @@
+/*
+ * secp256k1_wrapper - convenience wrapper around libsecp256k1
+ *
+ * Copyright (c) 2025 xXLegionBinFrogXx
+ *
+ * This file is licensed under the MIT License.
+ * See the LICENSE file in the project root for details.
+ *
+ * This project incorporates code from libsecp256k1,
+ * copyright (c) 2013 Bitcoin Core Developers, MIT License.
+ */
+
+/*
+ * BIP340 Schnorr signatures.
+ *
+ * Signing goes through key pair handles: libsecp256k1's secp256k1_keypair
+ * holds the secret key together with its public point, so the point
+ * multiplication is paid once per key when the handle is created, not once
+ * per signature. Every signature gets 32 bytes of auxiliary randomness from
+ * secp256k1_wrapper_fill_random(), drawn for up to SCHNORR_STAGE_ITEMS
+ * signatures per RNG request in batches. Verification runs on
+ * secp256k1_context_static, like ECDSA verification, and shares its
+ * batch runner.
+ */
+
+#include "secp256k1_wrapper_internal.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/* Signatures whose auxiliary randomness is drawn in one request (2 KiB) */
+#define SCHNORR_STAGE_ITEMS 64
+
+struct secp256k1_wrapper_keypair {
+    secp256k1_keypair keypair;
+};
+
+/* ---------- Key pairs ---------- */
+
+int secp256k1_wrapper_keypair_create(const unsigned char* privkey, secp256k1_wrapper_keypair** keypair_out) {
+    if (keypair_out == NULL) {
+        return -1; // Invalid input
+    }
+    *keypair_out = NULL;
+    if (privkey == NULL) {
+        return -1; // Invalid input
+    }
+
+    secp256k1_wrapper_keypair* keypair = (secp256k1_wrapper_keypair*)calloc(1, sizeof(*keypair));
+    if (keypair == NULL) {
+        return -2;
+    }
+
+    wrapper_ctx_lease lease;
+    int res = wrapper_lease_acquire(&lease, 1);
+    if (res == 0) {
+        res = wrapper_ctx_begin_op(lease.ctx);
+        if (res == 0 && !secp256k1_keypair_create(lease.ctx->ctx, &keypair->keypair, privkey)) {
+            res = -5; // Private key verification failed
+        }
+        wrapper_lease_release(&lease);
+    }
+    if (res != 0) {
+        secure_memzero(keypair, sizeof(*keypair));
+        free(keypair);
+        return res;
+    }
+    *keypair_out = keypair;
+    return 0;
+}
+
+int secp256k1_wrapper_keypair_xonly_pubkey(const secp256k1_wrapper_keypair* keypair, unsigned char* xonly_out,
+                                           int* parity) {
+    if (keypair == NULL || xonly_out == NULL) {
+        return -1; // Invalid input
+    }
+
+    secp256k1_xonly_pubkey xonly;
+    int pk_parity;
+    if (!secp256k1_keypair_xonly_pub(secp256k1_context_static, &xonly, &pk_parity, &keypair->keypair) ||
+        !secp256k1_xonly_pubkey_serialize(secp256k1_context_static, xonly_out, &xonly)) {
+        return -5; // Public key serialization failed
+    }
+    if (parity != NULL) {
+        *parity = pk_parity;
+    }
+    return 0;
+}
+
+void secp256k1_wrapper_keypair_destroy(secp256k1_wrapper_keypair* keypair) {
+    if (keypair == NULL) {
+        return;
+    }
+    secure_memzero(keypair, sizeof(*keypair));
+    free(keypair);
+}
+
+/* ---------- Signing ---------- */
+
+int secp256k1_wrapper_schnorr_sign_ctx(secp256k1_wrapper_ctx* ctx, const secp256k1_wrapper_keypair* keypair,
+                                       const unsigned char* msg32, unsigned char* sig64_out) {
+
+    if (ctx == NULL || ctx->ctx == NULL || keypair == NULL || msg32 == NULL || sig64_out == NULL) {
+        return -1; // Invalid input
+    }
+
+    int res = wrapper_ctx_begin_op(ctx);
+    if (res != 0) {
+        return res;
+    }
+
+    unsigned char aux_rand[32];
+    if (!secp256k1_wrapper_fill_random(aux_rand, sizeof(aux_rand))) {
+        secure_memzero(aux_rand, sizeof(aux_rand));  // may be partly filled
+        return -3; // Random number generation failed
+    }
+    int ok = secp256k1_schnorrsig_sign32(ctx->ctx, sig64_out, msg32, &keypair->keypair, aux_rand);
+    secure_memzero(aux_rand, sizeof(aux_rand));
+    if (!ok) {
+        return -4; // Signing failed
+    }
+    return 0;
+}
+
+int secp256k1_wrapper_schnorr_sign(const secp256k1_wrapper_keypair* keypair, const unsigned char* msg32,
+                                   unsigned char* sig64_out) {
+
+    if (keypair == NULL || msg32 == NULL || sig64_out == NULL) {
+        return -1; // Invalid input
+    }
+
+    wrapper_ctx_lease lease;
+    int res = wrapper_lease_acquire(&lease, 1);
+    if (res != 0) {
+        return res;
+    }
+
+    res = secp256k1_wrapper_schnorr_sign_ctx(lease.ctx, keypair, msg32, sig64_out);
+    wrapper_lease_release(&lease);
+    return res;
+}
+
+/* Arguments of a Schnorr sign batch, shared by every chunk of a parallel run */
+typedef struct schnorr_sign_args {
+    const secp256k1_wrapper_keypair* const* keypairs;
+    const unsigned char* msgs;
+    unsigned char* sigs_out;
+    int* results;
+} schnorr_sign_args;
+
+static void schnorr_sign_fail(const schnorr_sign_args* a, size_t i, int res) {
+    memset(a->sigs_out + i * SECP256K1_WRAPPER_SCHNORR_SIG_SIZE, 0, SECP256K1_WRAPPER_SCHNORR_SIG_SIZE);
+    a->results[i] = res;
+}
+
+/* Signs items [begin, end) on one context. Returns 0 or the first error. */
+static int schnorr_sign_range(void* arg, secp256k1_wrapper_ctx* wctx, size_t begin, size_t end) {
+    const schnorr_sign_args* a = (const schnorr_sign_args*)arg;
+    unsigned char aux_rand[SCHNORR_STAGE_ITEMS * 32];
+    int first_error = 0;
+
+    for (size_t stage = begin; stage < end; stage += SCHNORR_STAGE_ITEMS) {
+        size_t count = end - stage < SCHNORR_STAGE_ITEMS ? end - stage : SCHNORR_STAGE_ITEMS;
+        int drawn = secp256k1_wrapper_fill_random(aux_rand, count * 32);
+
+        for (size_t i = stage; i < stage + count; i++) {
+            int res = a->keypairs[i] == NULL ? -1 : drawn ? wrapper_ctx_begin_op(wctx) : -3;
+            if (res == 0 &&
+                !secp256k1_schnorrsig_sign32(wctx->ctx, a->sigs_out + i * SECP256K1_WRAPPER_SCHNORR_SIG_SIZE,
+                                             a->msgs + i * 32, &a->keypairs[i]->keypair,
+                                             aux_rand + (i - stage) * 32)) {
+                res = -4; // Signing failed
+            }
+            if (res != 0) {
+                schnorr_sign_fail(a, i, res);
+                if (first_error == 0) {
+                    first_error = res;
+                }
+                continue;
+            }
+            a->results[i] = 0;
+        }
+    }
+    secure_memzero(aux_rand, sizeof(aux_rand));
+    return first_error;
+}
+
+int secp256k1_wrapper_schnorr_sign_batch(const secp256k1_wrapper_keypair* const* keypairs,
+                                         const unsigned char* msgs, size_t n, unsigned char* sigs_out,
+                                         int* results) {
+
+    if (keypairs == NULL || msgs == NULL || sigs_out == NULL || results == NULL ||
+        n > SIZE_MAX / SECP256K1_WRAPPER_SCHNORR_SIG_SIZE) {
+        return -1; // Invalid input
+    }
+    if (n == 0) {
+        return 0;
+    }
+
+    schnorr_sign_args args = { keypairs, msgs, sigs_out, results };
+    int res;
+    if (wrapper_parallel_run(n, schnorr_sign_range, &args, &res)) {
+        return res;
+    }
+
+    wrapper_ctx_lease lease;
+    res = wrapper_lease_acquire(&lease, 1);
+    if (res != 0) {
+        for (size_t i = 0; i < n; i++) {
+            schnorr_sign_fail(&args, i, res);
+        }
+        return res;
+    }
+
+    res = schnorr_sign_range(&args, lease.ctx, 0, n);
+    wrapper_lease_release(&lease);
+    return res;
+}
+
+/* ---------- Verification ---------- */
+
+/* Returns 0 if the signature is valid, -4 if it is not, -5 for an
+ * unparsable public key. */
+static int schnorr_verify_one(const secp256k1_wrapper_schnorr_item* item) {
+    const secp256k1_context* ctx = secp256k1_context_static;
+
+    if (item->xonly_pubkey == NULL || item->msg32 == NULL || item->sig64 == NULL) {
+        return -4; // Nothing to verify
+    }
+    secp256k1_xonly_pubkey pubkey;
+    if (!secp256k1_xonly_pubkey_parse(ctx, &pubkey, item->xonly_pubkey)) {
+        return -5; // Public key parsing failed
+    }
+    if (!secp256k1_schnorrsig_verify(ctx, item->sig64, item->msg32, 32, &pubkey)) {
+        return -4; // Signature invalid
+    }
+    return 0;
+}
+
+int secp256k1_wrapper_schnorr_verify(const unsigned char* xonly_pubkey, const unsigned char* msg32,
+                                     const unsigned char* sig64) {
+
+    if (xonly_pubkey == NULL || msg32 == NULL || sig64 == NULL) {
+        return -1; // Invalid input
+    }
+    secp256k1_wrapper_schnorr_item item = { xonly_pubkey, msg32, sig64 };
+    return schnorr_verify_one(&item);
+}
+
+static int schnorr_verify_item(const void* items, size_t i) {
+    return schnorr_verify_one((const secp256k1_wrapper_schnorr_item*)items + i);
+}
+
+int secp256k1_wrapper_schnorr_verify_batch(const secp256k1_wrapper_schnorr_item* items, size_t n, int mode,
+                                           unsigned char* valid_bitmap) {
+
+    if (items == NULL ||
+        (mode != SECP256K1_WRAPPER_VERIFY_ALL && mode != SECP256K1_WRAPPER_VERIFY_EARLY_EXIT) ||
+        (mode == SECP256K1_WRAPPER_VERIFY_ALL && valid_bitmap == NULL)) {
+        return -1; // Invalid input
+    }
+    return wrapper_verify_run(n, schnorr_verify_item, items, mode == SECP256K1_WRAPPER_VERIFY_EARLY_EXIT,
+                              valid_bitmap);
+}
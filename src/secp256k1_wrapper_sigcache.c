@@ -0,0 +1,301 @@
+/*
+ * secp256k1_wrapper - convenience wrapper around libsecp256k1
+ *
+ * Copyright (c) 2025 xXLegionBinFrogXx
+ *
+ * This file is licensed under the MIT License.
+ * See the LICENSE file in the project root for details.
+ *
+ * This project incorporates code from libsecp256k1,
+ * copyright (c) 2013 Bitcoin Core Developers, MIT License.
+ */
+
+/*
+ * Cache of verified signatures.
+ *
+ * A fixed-size cuckoo set of 32-byte digests: each (public key, hash,
+ * signature) triple that verified is hashed with a random per-cache salt, so
+ * outsiders cannot aim collisions at chosen buckets. A digest lives in one of
+ * two buckets of SIGCACHE_BUCKET slots, picked by its first two words.
+ *
+ * Lookups take no lock. Every slot carries a sequence number that is odd
+ * while the slot is being written; a reader that sees it odd or changed
+ * treats the slot as a miss. Inserts are serialized by a mutex. Each insert
+ * is tagged with the current generation, which advances every quarter of
+ * the capacity inserted; slots more than one generation old are reused
+ * before live entries are displaced, so the cache keeps the recent ones.
+ * Only valid signatures are cached, so a hit is always a valid signature.
+ * A fork()ed child keeps looking up but stops inserting, as a parent thread
+ * may have held the insert lock.
+ */
+
+#include "secp256k1_wrapper_internal.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/* Slots per bucket: eight candidate slots per digest keep lookups within a
+ * few cache lines and let the table fill past 90% */
+#define SIGCACHE_BUCKET 4
+/* Displacements before an insert gives up and drops the entry in hand */
+#define SIGCACHE_KICKS 16
+
+/* Longest DER signature the cache hashes; longer ones are not cached */
+#define SIGCACHE_MAX_SIG 72
+
+static const unsigned char sigcache_tag[] = "secp256k1_wrapper/sigcache";
+
+typedef struct sigcache_slot {
+    volatile uint32_t seq;      // odd while the slot is written
+    uint32_t generation;        // insert generation, 0 = empty; writers only
+    volatile uint64_t key[4];
+} sigcache_slot;
+
+typedef struct wrapper_sigcache {
+    sigcache_slot* slots;
+    size_t buckets;
+    unsigned char salt[32];
+
+    wrapper_mutex lock;         // serializes inserts
+    uint32_t fork_generation;   // the lock is unusable after fork()
+    uint32_t generation;
+    size_t inserts_this_generation;
+    uint64_t kick_state;        // xorshift state for picking victims
+
+    volatile uint64_t hits;
+    volatile uint64_t misses;
+    volatile uint64_t inserts;
+    volatile uint64_t evictions;
+} wrapper_sigcache;
+
+static void* volatile g_sigcache = NULL;
+
+static void sigcache_buckets(const wrapper_sigcache* c, const uint64_t* key, size_t* b1, size_t* b2) {
+    *b1 = (size_t)(key[0] % c->buckets);
+    *b2 = (size_t)(key[1] % c->buckets);
+    if (*b2 == *b1) {
+        *b2 = (*b1 + 1) % c->buckets;
+    }
+}
+
+/* Lock-free: a torn or in-progress slot never matches */
+static int sigcache_slot_holds(const sigcache_slot* slot, const uint64_t* key) {
+    uint32_t seq = wrapper_atomic_load_u32((volatile uint32_t*)&slot->seq);
+    if (seq & 1) {
+        return 0;
+    }
+    int match = 1;
+    for (int w = 0; w < 4; w++) {
+        match &= wrapper_atomic_load_u64((volatile uint64_t*)&slot->key[w]) == key[w];
+    }
+    return match && wrapper_atomic_load_u32((volatile uint32_t*)&slot->seq) == seq;
+}
+
+static int sigcache_find(const wrapper_sigcache* c, const uint64_t* key) {
+    size_t b[2];
+    sigcache_buckets(c, key, &b[0], &b[1]);
+    for (int i = 0; i < 2; i++) {
+        const sigcache_slot* bucket = c->slots + b[i] * SIGCACHE_BUCKET;
+        for (int s = 0; s < SIGCACHE_BUCKET; s++) {
+            if (sigcache_slot_holds(&bucket[s], key)) {
+                return 1;
+            }
+        }
+    }
+    return 0;
+}
+
+/* Writer side of the sequence lock; the insert lock is held */
+static void sigcache_slot_write(sigcache_slot* slot, const uint64_t* key, uint32_t generation) {
+    uint32_t seq = slot->seq;
+    wrapper_atomic_store_u32(&slot->seq, seq + 1);
+    wrapper_atomic_fence();  // readers see the odd sequence before any key word changes
+    for (int w = 0; w < 4; w++) {
+        wrapper_atomic_store_u64(&slot->key[w], key[w]);
+    }
+    wrapper_atomic_store_u32(&slot->seq, seq + 2);
+    slot->generation = generation;
+}
+
+/* An empty slot, or one aged out, in the bucket */
+static sigcache_slot* sigcache_free_slot(const wrapper_sigcache* c, size_t bucket) {
+    sigcache_slot* slots = c->slots + bucket * SIGCACHE_BUCKET;
+    for (int s = 0; s < SIGCACHE_BUCKET; s++) {
+        if (slots[s].generation == 0 || slots[s].generation + 1 < c->generation) {
+            return &slots[s];
+        }
+    }
+    return NULL;
+}
+
+static void sigcache_insert(wrapper_sigcache* c, const uint64_t* digest) {
+    wrapper_mutex_lock(&c->lock);
+    if (sigcache_find(c, digest)) {
+        wrapper_mutex_unlock(&c->lock);  // another thread verified the same triple
+        return;
+    }
+
+    uint64_t key[4];
+    uint32_t generation = c->generation;
+    memcpy(key, digest, sizeof(key));
+
+    int placed = 0;
+    for (int kick = 0;; kick++) {
+        size_t b1, b2;
+        sigcache_buckets(c, key, &b1, &b2);
+        sigcache_slot* slot = sigcache_free_slot(c, b1);
+        if (slot == NULL) {
+            slot = sigcache_free_slot(c, b2);
+        }
+        if (slot != NULL) {
+            sigcache_slot_write(slot, key, generation);
+            placed = 1;
+            break;
+        }
+        if (kick == SIGCACHE_KICKS) {
+            break;
+        }
+
+        // Both buckets full of live entries: displace a random one
+        c->kick_state ^= c->kick_state << 13;
+        c->kick_state ^= c->kick_state >> 7;
+        c->kick_state ^= c->kick_state << 17;
+        size_t bucket = (c->kick_state & 1) ? b2 : b1;
+        sigcache_slot* victim = c->slots + bucket * SIGCACHE_BUCKET + (size_t)((c->kick_state >> 1) % SIGCACHE_BUCKET);
+
+        uint64_t displaced[4];
+        for (int w = 0; w < 4; w++) {
+            displaced[w] = victim->key[w];
+        }
+        uint32_t displaced_generation = victim->generation;
+        sigcache_slot_write(victim, key, generation);
+        memcpy(key, displaced, sizeof(key));
+        generation = displaced_generation;
+    }
+    if (!placed) {
+        wrapper_atomic_fetch_add_u64(&c->evictions, 1);
+    }
+
+    if (++c->inserts_this_generation >= c->buckets * SIGCACHE_BUCKET / 4) {
+        c->generation++;
+        c->inserts_this_generation = 0;
+    }
+    wrapper_mutex_unlock(&c->lock);
+    wrapper_atomic_fetch_add_u64(&c->inserts, 1);
+}
+
+/* ---------- Verification hooks ---------- */
+
+int wrapper_sigcache_lookup(const secp256k1_wrapper_verify_item* item, int format, unsigned char* digest) {
+    wrapper_sigcache* c = (wrapper_sigcache*)wrapper_atomic_load_ptr(&g_sigcache);
+    if (c == NULL || item->pubkey_len > PUBKEY_UNCOMPRESSION_SIZE || item->sig_len > SIGCACHE_MAX_SIG) {
+        return -1;
+    }
+
+    // salt || format || pubkey_len || pubkey || sig_len || sig || hash
+    unsigned char msg[32 + 3 + PUBKEY_UNCOMPRESSION_SIZE + SIGCACHE_MAX_SIG + 32];
+    size_t len = 0;
+    memcpy(msg, c->salt, sizeof(c->salt));
+    len += sizeof(c->salt);
+    msg[len++] = (unsigned char)format;
+    msg[len++] = (unsigned char)item->pubkey_len;
+    memcpy(msg + len, item->pubkey, item->pubkey_len);
+    len += item->pubkey_len;
+    msg[len++] = (unsigned char)item->sig_len;
+    memcpy(msg + len, item->sig, item->sig_len);
+    len += item->sig_len;
+    memcpy(msg + len, item->hash32, 32);
+    len += 32;
+
+    if (!secp256k1_tagged_sha256(secp256k1_context_static, digest, sigcache_tag, sizeof(sigcache_tag) - 1, msg, len)) {
+        return -1;
+    }
+    uint64_t key[4];
+    memcpy(key, digest, sizeof(key));
+    if (sigcache_find(c, key)) {
+        wrapper_atomic_fetch_add_u64(&c->hits, 1);
+        return 1;
+    }
+    wrapper_atomic_fetch_add_u64(&c->misses, 1);
+    return 0;
+}
+
+void wrapper_sigcache_insert(const unsigned char* digest) {
+    wrapper_sigcache* c = (wrapper_sigcache*)wrapper_atomic_load_ptr(&g_sigcache);
+    if (c == NULL || c->fork_generation != wrapper_fork_generation()) {
+        return;
+    }
+    uint64_t key[4];
+    memcpy(key, digest, sizeof(key));
+    sigcache_insert(c, key);
+}
+
+/* ---------- Public API ---------- */
+
+int secp256k1_wrapper_sigcache_init(size_t max_bytes) {
+    size_t buckets = max_bytes / (sizeof(sigcache_slot) * SIGCACHE_BUCKET);
+    if (buckets < 2 || wrapper_atomic_load_ptr(&g_sigcache) != NULL) {
+        return -1; // Invalid size or already initialized
+    }
+
+    wrapper_sigcache* c = (wrapper_sigcache*)calloc(1, sizeof(*c));
+    if (c == NULL) {
+        return -2;
+    }
+    c->slots = (sigcache_slot*)calloc(buckets * SIGCACHE_BUCKET, sizeof(sigcache_slot));
+    if (c->slots == NULL) {
+        free(c);
+        return -2;
+    }
+    if (!secp256k1_wrapper_fill_random(c->salt, sizeof(c->salt))) {
+        free(c->slots);
+        free(c);
+        return -3;
+    }
+    memcpy(&c->kick_state, c->salt, sizeof(c->kick_state));
+    c->kick_state |= 1;  // xorshift must not start at zero
+    c->buckets = buckets;
+    c->generation = 1;
+    wrapper_mutex_init(&c->lock);
+    wrapper_fork_guard();
+    c->fork_generation = wrapper_fork_generation();
+
+    wrapper_atomic_store_ptr(&g_sigcache, c);
+    return 0;
+}
+
+void secp256k1_wrapper_sigcache_shutdown(void) {
+    wrapper_sigcache* c = (wrapper_sigcache*)wrapper_atomic_load_ptr(&g_sigcache);
+    if (c == NULL) {
+        return;
+    }
+    wrapper_atomic_store_ptr(&g_sigcache, NULL);
+    if (c->fork_generation == wrapper_fork_generation()) {
+        wrapper_mutex_destroy(&c->lock);  // inherited across fork(), it may be held forever
+    }
+    free(c->slots);
+    secure_memzero(c->salt, sizeof(c->salt));
+    free(c);
+}
+
+void secp256k1_wrapper_get_sigcache_stats(secp256k1_wrapper_sigcache_stats* stats) {
+    if (stats == NULL) {
+        return;
+    }
+    memset(stats, 0, sizeof(*stats));
+
+    wrapper_sigcache* c = (wrapper_sigcache*)wrapper_atomic_load_ptr(&g_sigcache);
+    if (c == NULL) {
+        return;
+    }
+    stats->capacity = c->buckets * SIGCACHE_BUCKET;
+    stats->hits = wrapper_atomic_load_u64(&c->hits);
+    stats->misses = wrapper_atomic_load_u64(&c->misses);
+    stats->inserts = wrapper_atomic_load_u64(&c->inserts);
+    stats->evictions = wrapper_atomic_load_u64(&c->evictions);
+    if (c->fork_generation == wrapper_fork_generation()) {
+        wrapper_mutex_lock(&c->lock);
+        stats->generation = c->generation;
+        wrapper_mutex_unlock(&c->lock);
+    }
+}
@@ -0,0 +1,220 @@
+/*
+ * secp256k1_wrapper - convenience wrapper around libsecp256k1
+ *
+ * Copyright (c) 2025 xXLegionBinFrogXx
+ *
+ * This file is licensed under the MIT License.
+ * See the LICENSE file in the project root for details.
+ *
+ * This project incorporates code from libsecp256k1,
+ * copyright (c) 2013 Bitcoin Core Developers, MIT License.
+ */
+
+/*
+ * ECDSA signing.
+ *
+ * Nonces are RFC 6979 with 32 bytes of extra entropy from
+ * secp256k1_wrapper_fill_random(), so equal inputs give different signatures
+ * while a weak RNG still cannot repeat a nonce for different hashes. Batches
+ * draw that entropy for up to SIGN_STAGE_ITEMS signatures per RNG request and
+ * share one context, split over the worker pool in parallel mode.
+ */
+
+#include "secp256k1_wrapper_internal.h"
+
+#include <string.h>
+
+/* Signatures whose nonce entropy is drawn in one request (2 KiB) */
+#define SIGN_STAGE_ITEMS 64
+
+static size_t sign_slot_size(int format) {
+    return format == SECP256K1_WRAPPER_SIG_COMPACT ? SECP256K1_WRAPPER_SIG_COMPACT_SIZE
+                                                   : SECP256K1_WRAPPER_SIG_DER_MAX_SIZE;
+}
+
+/* Signs one hash and serializes the signature into a slot of
+ * sign_slot_size(format) bytes. Returns 0, -4 or -5. */
+static int sign_one(const secp256k1_context* ctx, const unsigned char* privkey, const unsigned char* hash32,
+                    const unsigned char* ndata, unsigned char* sig_out, size_t* sig_len, int format) {
+    if (!secp256k1_ec_seckey_verify(ctx, privkey)) {
+        return -5; // Private key verification failed
+    }
+
+    secp256k1_ecdsa_signature sig;
+    if (!secp256k1_ecdsa_sign(ctx, &sig, hash32, privkey, NULL, ndata)) {
+        return -4; // Signing failed
+    }
+
+    if (format == SECP256K1_WRAPPER_SIG_COMPACT) {
+        if (!secp256k1_ecdsa_signature_serialize_compact(ctx, sig_out, &sig)) {
+            return -4; // Signature serialization failed
+        }
+        *sig_len = SECP256K1_WRAPPER_SIG_COMPACT_SIZE;
+        return 0;
+    }
+    size_t len = SECP256K1_WRAPPER_SIG_DER_MAX_SIZE;
+    if (!secp256k1_ecdsa_signature_serialize_der(ctx, sig_out, &len, &sig)) {
+        return -4; // Signature serialization failed
+    }
+    *sig_len = len;
+    return 0;
+}
+
+int secp256k1_wrapper_sign_ctx(secp256k1_wrapper_ctx* ctx, const unsigned char* privkey, const unsigned char* hash32,
+                               unsigned char* sig_out, size_t* sig_len, int format) {
+
+    if (ctx == NULL || ctx->ctx == NULL || privkey == NULL || hash32 == NULL || sig_out == NULL || sig_len == NULL ||
+        (format != SECP256K1_WRAPPER_SIG_COMPACT && format != SECP256K1_WRAPPER_SIG_DER) ||
+        *sig_len < sign_slot_size(format)) {
+        return -1; // Invalid input
+    }
+
+    int res = wrapper_ctx_begin_op(ctx);
+    if (res != 0) {
+        return res;
+    }
+
+    unsigned char ndata[32];
+    if (!secp256k1_wrapper_fill_random(ndata, sizeof(ndata))) {
+        secure_memzero(ndata, sizeof(ndata));  // may be partly filled
+        return -3; // Random number generation failed
+    }
+    res = sign_one(ctx->ctx, privkey, hash32, ndata, sig_out, sig_len, format);
+    secure_memzero(ndata, sizeof(ndata));
+    return res;
+}
+
+int secp256k1_wrapper_sign(const unsigned char* privkey, const unsigned char* hash32, unsigned char* sig_out,
+                           size_t* sig_len, int format) {
+
+    if (privkey == NULL || hash32 == NULL || sig_out == NULL || sig_len == NULL ||
+        (format != SECP256K1_WRAPPER_SIG_COMPACT && format != SECP256K1_WRAPPER_SIG_DER) ||
+        *sig_len < sign_slot_size(format)) {
+        return -1; // Invalid input
+    }
+
+    wrapper_ctx_lease lease;
+    int res = wrapper_lease_acquire(&lease, 1);
+    if (res != 0) {
+        return res;
+    }
+
+    res = secp256k1_wrapper_sign_ctx(lease.ctx, privkey, hash32, sig_out, sig_len, format);
+    wrapper_lease_release(&lease);
+    return res;
+}
+
+/* ---------- Batches ---------- */
+
+/* Arguments of a sign batch, shared by every chunk of a parallel run */
+typedef struct sign_args {
+    const unsigned char* privkeys;
+    const unsigned char* hashes;
+    unsigned char* sigs_out;
+    size_t* sig_lens;
+    int format;
+    int* results;
+} sign_args;
+
+static void sign_fail(const sign_args* a, size_t i, int res) {
+    size_t slot = sign_slot_size(a->format);
+    memset(a->sigs_out + i * slot, 0, slot);
+    if (a->sig_lens != NULL) {
+        a->sig_lens[i] = 0;
+    }
+    a->results[i] = res;
+}
+
+/* Signs items [begin, end) with the nonce entropy at `ndata` (32 bytes per
+ * item), or fails each one with -3 if `ndata` is NULL. Returns 0 or the
+ * first error. */
+static int sign_stage(const sign_args* a, secp256k1_wrapper_ctx* wctx, size_t begin, size_t end,
+                      const unsigned char* ndata) {
+    size_t slot = sign_slot_size(a->format);
+    int first_error = 0;
+
+    for (size_t i = begin; i < end; i++) {
+        int res = ndata != NULL ? wrapper_ctx_begin_op(wctx) : -3;
+        size_t len = 0;
+        if (res == 0) {
+            res = sign_one(wctx->ctx, a->privkeys + i * PRIVKEY_SIZE, a->hashes + i * 32,
+                           ndata + (i - begin) * 32, a->sigs_out + i * slot, &len, a->format);
+        }
+        if (res != 0) {
+            sign_fail(a, i, res);
+            if (first_error == 0) {
+                first_error = res;
+            }
+            continue;
+        }
+        if (a->sig_lens != NULL) {
+            a->sig_lens[i] = len;
+        }
+        a->results[i] = 0;
+    }
+    return first_error;
+}
+
+/* Signs items [begin, end) on one context. Returns 0 or the first error. */
+static int sign_range(void* arg, secp256k1_wrapper_ctx* wctx, size_t begin, size_t end) {
+    const sign_args* a = (const sign_args*)arg;
+    unsigned char ndata[SIGN_STAGE_ITEMS * 32];
+    int first_error = 0;
+
+    for (size_t stage = begin; stage < end; stage += SIGN_STAGE_ITEMS) {
+        size_t count = end - stage < SIGN_STAGE_ITEMS ? end - stage : SIGN_STAGE_ITEMS;
+        int drawn = secp256k1_wrapper_fill_random(ndata, count * 32);
+        int res = sign_stage(a, wctx, stage, stage + count, drawn ? ndata : NULL);
+        if (first_error == 0) {
+            first_error = res;
+        }
+    }
+    secure_memzero(ndata, sizeof(ndata));
+    return first_error;
+}
+
+int wrapper_sign_batch(secp256k1_wrapper_ctx* wctx, const unsigned char* privkeys, const unsigned char* hashes,
+                       size_t n, unsigned char* sigs_out, size_t* sig_lens, int format, int* results) {
+    sign_args args = { privkeys, hashes, sigs_out, sig_lens, format, results };
+    return sign_range(&args, wctx, 0, n);
+}
+
+int wrapper_sign_batch_entropy(secp256k1_wrapper_ctx* wctx, const unsigned char* privkeys,
+                               const unsigned char* hashes, size_t n, unsigned char* sigs_out, size_t* sig_lens,
+                               int format, const unsigned char* ndata, int* results) {
+    sign_args args = { privkeys, hashes, sigs_out, sig_lens, format, results };
+    return sign_stage(&args, wctx, 0, n, ndata);
+}
+
+int secp256k1_wrapper_sign_batch(const unsigned char* privkeys, const unsigned char* hashes, size_t n,
+                                 unsigned char* sigs_out, size_t* sig_lens, int format, int* results) {
+
+    if (privkeys == NULL || hashes == NULL || sigs_out == NULL || results == NULL ||
+        (format != SECP256K1_WRAPPER_SIG_COMPACT && format != SECP256K1_WRAPPER_SIG_DER) ||
+        (format == SECP256K1_WRAPPER_SIG_DER && sig_lens == NULL) ||
+        n > SIZE_MAX / SECP256K1_WRAPPER_SIG_DER_MAX_SIZE) {
+        return -1; // Invalid input
+    }
+    if (n == 0) {
+        return 0;
+    }
+
+    sign_args args = { privkeys, hashes, sigs_out, sig_lens, format, results };
+    int res;
+    if (wrapper_parallel_run(n, sign_range, &args, &res)) {
+        return res;
+    }
+
+    wrapper_ctx_lease lease;
+    res = wrapper_lease_acquire(&lease, 1);
+    if (res != 0) {
+        for (size_t i = 0; i < n; i++) {
+            sign_fail(&args, i, res);
+        }
+        return res;
+    }
+
+    res = sign_range(&args, lease.ctx, 0, n);
+    wrapper_lease_release(&lease);
+    return res;
+}
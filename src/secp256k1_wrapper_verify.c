@@ -0,0 +1,187 @@
+/*
+ * secp256k1_wrapper - convenience wrapper around libsecp256k1
+ *
+ * Copyright (c) 2025 xXLegionBinFrogXx
+ *
+ * This file is licensed under the MIT License.
+ * See the LICENSE file in the project root for details.
+ *
+ * This project incorporates code from libsecp256k1,
+ * copyright (c) 2013 Bitcoin Core Developers, MIT License.
+ */
+
+/*
+ * ECDSA verification.
+ *
+ * Verification handles only public data, so it needs no blinding and runs on
+ * secp256k1_context_static: no context is created or borrowed, and the
+ * worker pool's contexts go unused. Batches record one bit per item; ranges
+ * run by different workers may share a bitmap byte at their edges, so bits
+ * are merged in with an atomic OR. With the signature cache enabled, every
+ * item is looked up there first and valid ones are recorded; with the public
+ * key cache enabled, keys are parsed through it.
+ */
+
+#include "secp256k1_wrapper_internal.h"
+
+#include <string.h>
+
+/* Returns 0 if the item's signature is valid, -4 for an invalid or
+ * unparsable signature, -5 for an unparsable public key. `key` is the item's
+ * public key already parsed, or NULL. */
+static int verify_one(const secp256k1_wrapper_verify_item* item, const secp256k1_pubkey* key, int format) {
+    const secp256k1_context* ctx = secp256k1_context_static;
+
+    if (item->pubkey == NULL || item->hash32 == NULL || item->sig == NULL) {
+        return -4; // Nothing to verify
+    }
+    unsigned char digest[32];
+    int cached = wrapper_sigcache_lookup(item, format, digest);
+    if (cached == 1) {
+        return 0;
+    }
+
+    secp256k1_pubkey pubkey;
+    if (key == NULL) {
+        int res = wrapper_pubkey_cache_parse(item->pubkey, item->pubkey_len, &pubkey);
+        if (res < 0) {
+            res = secp256k1_ec_pubkey_parse(ctx, &pubkey, item->pubkey, item->pubkey_len);
+        }
+        if (!res) {
+            return -5; // Public key parsing failed
+        }
+        key = &pubkey;
+    }
+
+    secp256k1_ecdsa_signature sig;
+    int parsed = format == SECP256K1_WRAPPER_SIG_COMPACT
+                     ? item->sig_len == SECP256K1_WRAPPER_SIG_COMPACT_SIZE &&
+                           secp256k1_ecdsa_signature_parse_compact(ctx, &sig, item->sig)
+                     : secp256k1_ecdsa_signature_parse_der(ctx, &sig, item->sig, item->sig_len);
+    if (!parsed || !secp256k1_ecdsa_verify(ctx, &sig, item->hash32, key)) {
+        return -4; // Signature invalid
+    }
+    if (cached == 0) {
+        wrapper_sigcache_insert(digest);
+    }
+    return 0;
+}
+
+int secp256k1_wrapper_verify(const unsigned char* pubkey, size_t pubkey_len, const unsigned char* hash32,
+                             const unsigned char* sig, size_t sig_len, int format) {
+
+    if (pubkey == NULL || hash32 == NULL || sig == NULL ||
+        (format != SECP256K1_WRAPPER_SIG_COMPACT && format != SECP256K1_WRAPPER_SIG_DER)) {
+        return -1; // Invalid input
+    }
+    secp256k1_wrapper_verify_item item = { pubkey, pubkey_len, hash32, sig, sig_len };
+    return verify_one(&item, NULL, format);
+}
+
+int secp256k1_wrapper_verify_pubkey(const secp256k1_wrapper_pubkey* pubkey, const unsigned char* hash32,
+                                    const unsigned char* sig, size_t sig_len, int format) {
+
+    if (pubkey == NULL || hash32 == NULL || sig == NULL ||
+        (format != SECP256K1_WRAPPER_SIG_COMPACT && format != SECP256K1_WRAPPER_SIG_DER)) {
+        return -1; // Invalid input
+    }
+    secp256k1_wrapper_verify_item item = { pubkey->encoding, pubkey->encoding_len, hash32, sig, sig_len };
+    return verify_one(&item, &pubkey->pubkey, format);
+}
+
+/* ---------- Batches ---------- */
+
+/* Arguments of a verify batch, shared by every chunk of a parallel run */
+typedef struct verify_args {
+    wrapper_verify_fn check;
+    const void* items;
+    int early_exit;
+    unsigned char* bitmap;
+    volatile int failed;        // early exit: some item failed, stop
+} verify_args;
+
+static void verify_flush(verify_args* a, size_t byte, unsigned char bits) {
+    if (a->bitmap != NULL && bits != 0) {
+        wrapper_atomic_or_u8(a->bitmap + byte, bits);
+    }
+}
+
+/* Verifies items [begin, end). Returns 0, or -4 if any item failed. */
+static int verify_range(void* arg, secp256k1_wrapper_ctx* wctx, size_t begin, size_t end) {
+    verify_args* a = (verify_args*)arg;
+    unsigned char bits = 0;
+    int failed = 0;
+    size_t i;
+    (void)wctx;
+
+    for (i = begin; i < end; i++) {
+        if (a->early_exit && wrapper_atomic_load_int(&a->failed)) {
+            failed = 1;  // another range failed; unchecked items stay clear
+            break;
+        }
+        if (a->check(a->items, i) == 0) {
+            bits |= (unsigned char)(1u << (i & 7));
+        } else {
+            failed = 1;
+            if (a->early_exit) {
+                wrapper_atomic_store_int(&a->failed, 1);
+                break;
+            }
+        }
+        if ((i & 7) == 7) {
+            verify_flush(a, i >> 3, bits);
+            bits = 0;
+        }
+    }
+    if (bits != 0) {
+        verify_flush(a, (i - 1) >> 3, bits);  // bits of the partial byte holding item i - 1
+    }
+    return failed ? -4 : 0;
+}
+
+int wrapper_verify_run(size_t n, wrapper_verify_fn check, const void* items, int early_exit,
+                       unsigned char* valid_bitmap) {
+    if (n == 0) {
+        return 0;
+    }
+    if (valid_bitmap != NULL) {
+        memset(valid_bitmap, 0, n / 8 + (n % 8 != 0));
+    }
+
+    verify_args args;
+    args.check = check;
+    args.items = items;
+    args.early_exit = early_exit;
+    args.bitmap = valid_bitmap;
+    args.failed = 0;
+
+    int res;
+    if (wrapper_parallel_run(n, verify_range, &args, &res)) {
+        return res;
+    }
+    return verify_range(&args, NULL, 0, n);
+}
+
+static int verify_compact_item(const void* items, size_t i) {
+    return verify_one((const secp256k1_wrapper_verify_item*)items + i, NULL, SECP256K1_WRAPPER_SIG_COMPACT);
+}
+
+static int verify_der_item(const void* items, size_t i) {
+    return verify_one((const secp256k1_wrapper_verify_item*)items + i, NULL, SECP256K1_WRAPPER_SIG_DER);
+}
+
+wrapper_verify_fn wrapper_verify_check(int format) {
+    return format == SECP256K1_WRAPPER_SIG_COMPACT ? verify_compact_item : verify_der_item;
+}
+
+int secp256k1_wrapper_verify_batch(const secp256k1_wrapper_verify_item* items, size_t n, int format, int mode,
+                                   unsigned char* valid_bitmap) {
+
+    if (items == NULL || (format != SECP256K1_WRAPPER_SIG_COMPACT && format != SECP256K1_WRAPPER_SIG_DER) ||
+        (mode != SECP256K1_WRAPPER_VERIFY_ALL && mode != SECP256K1_WRAPPER_VERIFY_EARLY_EXIT) ||
+        (mode == SECP256K1_WRAPPER_VERIFY_ALL && valid_bitmap == NULL)) {
+        return -1; // Invalid input
+    }
+    return wrapper_verify_run(n, wrapper_verify_check(format), items, mode == SECP256K1_WRAPPER_VERIFY_EARLY_EXIT,
+                              valid_bitmap);
+}
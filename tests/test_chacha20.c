@@ -0,0 +1,128 @@
+/*
+ * Known-answer tests for the ChaCha20 block function behind the DRBG,
+ * using the vectors from RFC 8439 sections 2.3.2 and A.1. The AVX2 kernel
+ * is checked against the same vectors and against the scalar kernel.
+ */
+#include <unity.h>
+#include <stdio.h>
+#include <string.h>
+#include "secp256k1_wrapper_internal.h"
+
+void setUp(void) {
+}
+
+void tearDown(void) {
+}
+
+static void hex_decode(const char* hex, unsigned char* out, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        unsigned int byte;
+        TEST_ASSERT_EQUAL_INT(1, sscanf(hex + 2 * i, "%2x", &byte));
+        out[i] = (unsigned char)byte;
+    }
+}
+
+typedef struct {
+    const char* key;
+    const char* nonce;
+    uint32_t counter;
+    const char* block;
+} chacha20_vector;
+
+static const chacha20_vector vectors[] = {
+    /* RFC 8439, 2.3.2 */
+    { "000102030405060708090a0b0c0d0e0f101112131415161718191a1b1c1d1e1f",
+      "000000090000004a00000000", 1,
+      "10f1e7e4d13b5915500fdd1fa32071c4c7d1f4c733c068030422aa9ac3d46c4e"
+      "d2826446079faa0914c2d705d98b02a2b5129cd1de164eb9cbd083e8a2503c4e" },
+    /* RFC 8439, A.1 test vector #1 */
+    { "0000000000000000000000000000000000000000000000000000000000000000",
+      "000000000000000000000000", 0,
+      "76b8e0ada0f13d90405d6ae55386bd28bdd219b8a08ded1aa836efcc8b770dc7"
+      "da41597c5157488d7724e03fb8d84a376a43b8f41518a11cc387b669b2ee6586" },
+    /* RFC 8439, A.1 test vector #2 */
+    { "0000000000000000000000000000000000000000000000000000000000000000",
+      "000000000000000000000000", 1,
+      "9f07e7be5551387a98ba977c732d080dcb0f29a048e3656912c6533e32ee7aed"
+      "29b721769ce64e43d57133b074d839d531ed1f28510afb45ace10a1f4b794d6f" },
+    /* RFC 8439, A.1 test vector #3 */
+    { "0000000000000000000000000000000000000000000000000000000000000001",
+      "000000000000000000000000", 1,
+      "3aeb5224ecf849929b9d828db1ced4dd832025e8018b8160b82284f3c949aa5a"
+      "8eca00bbb4a73bdad192b5c42f73f2fd4e273644c8b36125a64addeb006c13a0" },
+    /* RFC 8439, A.1 test vector #4 */
+    { "00ff000000000000000000000000000000000000000000000000000000000000",
+      "000000000000000000000000", 2,
+      "72d54dfbf12ec44b362692df94137f328fea8da73990265ec1bbbea1ae9af0ca"
+      "13b25aa26cb4a648cb9b9d1be65b2c0924a66c54d545ec1b7374f4872e99f096" },
+};
+
+#define NUM_VECTORS (sizeof(vectors) / sizeof(vectors[0]))
+
+void test_scalar_known_answers(void) {
+    unsigned char key[32], nonce[12], expected[64], out[64];
+
+    for (size_t i = 0; i < NUM_VECTORS; i++) {
+        hex_decode(vectors[i].key, key, sizeof(key));
+        hex_decode(vectors[i].nonce, nonce, sizeof(nonce));
+        hex_decode(vectors[i].block, expected, sizeof(expected));
+
+        wrapper_chacha20_blocks_scalar(key, nonce, vectors[i].counter, out, 1);
+        TEST_ASSERT_EQUAL_HEX8_ARRAY(expected, out, sizeof(out));
+    }
+}
+
+/* Each vector lands in a different lane of an 8-block AVX2 batch */
+void test_avx2_known_answers(void) {
+    unsigned char key[32], nonce[12], expected[64], out[8 * 64];
+
+    for (size_t i = 0; i < NUM_VECTORS; i++) {
+        hex_decode(vectors[i].key, key, sizeof(key));
+        hex_decode(vectors[i].nonce, nonce, sizeof(nonce));
+        hex_decode(vectors[i].block, expected, sizeof(expected));
+
+        uint32_t lane = (uint32_t)(i % 8);
+        if (vectors[i].counter < lane) {
+            lane = vectors[i].counter;
+        }
+        if (!wrapper_chacha20_blocks_avx2(key, nonce, vectors[i].counter - lane, out, 8)) {
+            TEST_IGNORE_MESSAGE("AVX2 not available");
+        }
+        TEST_ASSERT_EQUAL_HEX8_ARRAY(expected, out + 64 * lane, sizeof(expected));
+    }
+}
+
+/* Odd block counts exercise the scalar tail, the last counter crosses 2^32 */
+void test_avx2_matches_scalar(void) {
+    static const size_t counts[] = { 1, 7, 8, 9, 16, 23 };
+    static const uint32_t counters[] = { 0, 1, 1000, 0xFFFFFFF0u };
+    unsigned char key[32], nonce[12];
+    unsigned char scalar[23 * 64], avx2[23 * 64], dispatched[23 * 64];
+
+    for (size_t i = 0; i < sizeof(key); i++) key[i] = (unsigned char)(i * 7 + 3);
+    for (size_t i = 0; i < sizeof(nonce); i++) nonce[i] = (unsigned char)(0xA0 + i);
+
+    for (size_t c = 0; c < sizeof(counters) / sizeof(counters[0]); c++) {
+        for (size_t n = 0; n < sizeof(counts) / sizeof(counts[0]); n++) {
+            size_t len = counts[n] * 64;
+            wrapper_chacha20_blocks_scalar(key, nonce, counters[c], scalar, counts[n]);
+            wrapper_chacha20_blocks(key, nonce, counters[c], dispatched, counts[n]);
+            TEST_ASSERT_EQUAL_HEX8_ARRAY(scalar, dispatched, len);
+
+            if (!wrapper_chacha20_blocks_avx2(key, nonce, counters[c], avx2, counts[n])) {
+                TEST_IGNORE_MESSAGE("AVX2 not available");
+            }
+            TEST_ASSERT_EQUAL_HEX8_ARRAY(scalar, avx2, len);
+        }
+    }
+}
+
+int main(void) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_scalar_known_answers);
+    RUN_TEST(test_avx2_known_answers);
+    RUN_TEST(test_avx2_matches_scalar);
+
+    return UNITY_END();
+}
@@ -0,0 +1,210 @@
+/*
+ * Checks that the preallocated context pool keeps the one-shot API off the
+ * heap. Linked with -Wl,--wrap=malloc,--wrap=calloc,--wrap=realloc so every
+ * allocation made by the wrapper and the embedded libsecp256k1 is counted,
+ * and with --wrap=getrandom so system calls the vDSO should save show up.
+ */
+#include <unity.h>
+#include <pthread.h>
+#include <string.h>
+#include <sys/types.h>
+#include "secp256k1_wrapper.h"
+
+void* __real_malloc(size_t size);
+void* __real_calloc(size_t nmemb, size_t size);
+void* __real_realloc(void* ptr, size_t size);
+ssize_t __real_getrandom(void* buf, size_t buflen, unsigned int flags);
+
+static int counting = 0;
+static size_t alloc_count = 0;
+static size_t getrandom_count = 0;
+
+void* __wrap_malloc(size_t size) {
+    if (counting) alloc_count++;
+    return __real_malloc(size);
+}
+
+void* __wrap_calloc(size_t nmemb, size_t size) {
+    if (counting) alloc_count++;
+    return __real_calloc(nmemb, size);
+}
+
+void* __wrap_realloc(void* ptr, size_t size) {
+    if (counting) alloc_count++;
+    return __real_realloc(ptr, size);
+}
+
+ssize_t __wrap_getrandom(void* buf, size_t buflen, unsigned int flags) {
+    if (counting) getrandom_count++;
+    return __real_getrandom(buf, buflen, flags);
+}
+
+static void start_counting(void) {
+    alloc_count = 0;
+    getrandom_count = 0;
+    counting = 1;
+}
+
+static size_t stop_counting(void) {
+    counting = 0;
+    return alloc_count;
+}
+
+void setUp(void) {
+}
+
+void tearDown(void) {
+    secp256k1_wrapper_ctx_pool_shutdown();
+}
+
+/* Sanity check that the interposition is active at all */
+void test_counter_sees_heap_contexts(void) {
+    unsigned char privkey[PRIVKEY_SIZE];
+    unsigned char pubkey[PUBKEY_COMPRESSION_SIZE];
+
+    start_counting();
+    TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_generate_keys(privkey, pubkey, 1));
+    TEST_ASSERT_GREATER_THAN(0, stop_counting());
+}
+
+void test_caller_memory_no_allocations(void) {
+    static unsigned char arena[8192];
+    unsigned char privkey[PRIVKEY_SIZE];
+    unsigned char pubkey[PUBKEY_UNCOMPRESSION_SIZE];
+    unsigned char derived[PUBKEY_UNCOMPRESSION_SIZE];
+
+    size_t needed = secp256k1_wrapper_ctx_pool_preallocated_size(2);
+    TEST_ASSERT_GREATER_THAN(0, needed);
+    TEST_ASSERT_TRUE(needed <= sizeof(arena));
+    TEST_ASSERT_EQUAL_INT(-1, secp256k1_wrapper_ctx_pool_init_preallocated(arena, needed - 1, 2));
+
+    // Misaligned on purpose, the pool aligns internally
+    TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_ctx_pool_init_preallocated(arena + 1, sizeof(arena) - 1, 2));
+
+    start_counting();
+    for (int i = 0; i < 50; i++) {
+        TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_generate_keys(privkey, pubkey, 0));
+        TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_derive_pubkey(privkey, derived, 0));
+        TEST_ASSERT_EQUAL_MEMORY(pubkey, derived, PUBKEY_UNCOMPRESSION_SIZE);
+    }
+    TEST_ASSERT_EQUAL_size_t(0, stop_counting());
+
+    memset(privkey, 0, sizeof(privkey));
+}
+
+void test_static_arena_no_allocations(void) {
+    unsigned char privkey[PRIVKEY_SIZE];
+    unsigned char pubkey[PUBKEY_COMPRESSION_SIZE];
+
+    TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_ctx_pool_init_preallocated(NULL, 0, 1));
+
+    start_counting();
+    for (int i = 0; i < 50; i++) {
+        TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_generate_keys(privkey, pubkey, 1));
+    }
+    TEST_ASSERT_EQUAL_size_t(0, stop_counting());
+
+    secp256k1_wrapper_pool_stats stats;
+    secp256k1_wrapper_ctx_pool_stats(&stats);
+    TEST_ASSERT_EQUAL_UINT64(50, stats.hits);
+    TEST_ASSERT_EQUAL_UINT64(0, stats.misses);
+
+    memset(privkey, 0, sizeof(privkey));
+}
+
+/* Runs on a thread that has never called into the wrapper, so its first
+ * call falls inside the counting window */
+static void* fresh_thread_keys(void* arg) {
+    size_t* allocations = (size_t*)arg;
+    unsigned char privkey[PRIVKEY_SIZE];
+    unsigned char pubkey[PUBKEY_COMPRESSION_SIZE];
+    unsigned char derived[PUBKEY_COMPRESSION_SIZE];
+    int ok = 1;
+
+    start_counting();
+    for (int i = 0; i < 10; i++) {
+        ok &= secp256k1_wrapper_generate_keys(privkey, pubkey, 1) == 0;
+        ok &= secp256k1_wrapper_derive_pubkey(privkey, derived, 1) == 0;
+        ok &= memcmp(pubkey, derived, sizeof(pubkey)) == 0;
+    }
+    *allocations = stop_counting();
+
+    memset(privkey, 0, sizeof(privkey));
+    return ok ? arg : NULL;
+}
+
+void test_fresh_thread_no_allocations(void) {
+    pthread_t thread;
+    size_t allocations = (size_t)-1;
+    void* ret = NULL;
+
+    TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_ctx_pool_init_preallocated(NULL, 0, 2));
+    TEST_ASSERT_EQUAL_INT(0, pthread_create(&thread, NULL, fresh_thread_keys, &allocations));
+    TEST_ASSERT_EQUAL_INT(0, pthread_join(thread, &ret));
+    TEST_ASSERT_NOT_NULL(ret);
+    TEST_ASSERT_EQUAL_size_t(0, allocations);
+}
+
+typedef struct random_thread_args {
+    int warm;               // make a wrapper call before counting
+    size_t getrandom_calls;
+} random_thread_args;
+
+static void* random_thread(void* arg) {
+    random_thread_args* args = (random_thread_args*)arg;
+    unsigned char privkey[PRIVKEY_SIZE];
+    unsigned char pubkey[PUBKEY_COMPRESSION_SIZE];
+    unsigned char buf[32];
+    int ok = 1;
+
+    if (args->warm) {
+        ok &= secp256k1_wrapper_generate_keys(privkey, pubkey, 1) == 0;
+    }
+    start_counting();
+    for (int i = 0; i < 10; i++) {
+        ok &= secp256k1_wrapper_fill_random(buf, sizeof(buf));
+    }
+    stop_counting();
+    args->getrandom_calls = getrandom_count;
+
+    memset(privkey, 0, sizeof(privkey));
+    return ok ? arg : NULL;
+}
+
+static size_t getrandom_calls_on_new_thread(int warm) {
+    pthread_t thread;
+    random_thread_args args = { warm, (size_t)-1 };
+    void* ret = NULL;
+
+    TEST_ASSERT_EQUAL_INT(0, pthread_create(&thread, NULL, random_thread, &args));
+    TEST_ASSERT_EQUAL_INT(0, pthread_join(thread, &ret));
+    TEST_ASSERT_NOT_NULL(ret);
+    return args.getrandom_calls;
+}
+
+/* In the default configuration a thread's first requests already go through
+ * the vDSO, not only once the thread cache or a buffered RNG has set up
+ * per-thread state */
+void test_fresh_thread_uses_vdso(void) {
+    // A thread with cached state tells whether this kernel exports vgetrandom
+    secp256k1_wrapper_thread_cache_enable(1);
+    size_t probe = getrandom_calls_on_new_thread(1);
+    secp256k1_wrapper_thread_cache_enable(0);
+    if (probe != 0) {
+        TEST_IGNORE_MESSAGE("the kernel does not export vgetrandom");
+    }
+
+    TEST_ASSERT_EQUAL_size_t(0, getrandom_calls_on_new_thread(0));
+}
+
+int main(void) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_fresh_thread_no_allocations);  // before anything warms up this process
+    RUN_TEST(test_counter_sees_heap_contexts);
+    RUN_TEST(test_caller_memory_no_allocations);
+    RUN_TEST(test_static_arena_no_allocations);
+    RUN_TEST(test_fresh_thread_uses_vdso);
+
+    return UNITY_END();
+}
@@ -1,9 +1,18 @@
 #include <unity.h>
 #include <string.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
 #include "secp256k1_wrapper.h"  
 #include <secp256k1.h>
 
+#if !defined(_WIN32)
+#include <pthread.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#endif
+
 /* Secure memory zeroing */
 static void secure_memzero(void *p, size_t n) {
     volatile unsigned char *vp = (volatile unsigned char *)p;
@@ -299,51 +308,2491 @@ void test_known_private_key(void) {
     secure_memzero(privkey, sizeof(privkey));
 }
 
-/* ========== Version Test ========== */
+/* ========== Context Handle Tests ========== */
 
-void test_version_format(void) {
-    const char* version = secp256k1_wrapper_get_version();
-    TEST_ASSERT_NOT_NULL(version);
-    
-    // Check format: should be X.Y.Z
-    int major, minor, patch;
-    int parsed = sscanf(version, "%d.%d.%d", &major, &minor, &patch);
-    TEST_ASSERT_EQUAL_INT(3, parsed);
-    TEST_ASSERT_TRUE(major >= 0);
-    TEST_ASSERT_TRUE(minor >= 0);
-    TEST_ASSERT_TRUE(patch >= 0);
+void test_ctx_generate_and_derive(void) {
+    unsigned char privkey[PRIVKEY_SIZE];
+    unsigned char pubkey[PUBKEY_COMPRESSION_SIZE];
+    unsigned char derived[PUBKEY_COMPRESSION_SIZE];
+
+    secp256k1_wrapper_ctx* ctx = secp256k1_wrapper_ctx_create();
+    TEST_ASSERT_NOT_NULL(ctx);
+
+    for (int i = 0; i < 20; i++) {
+        TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_generate_keys_ctx(ctx, privkey, pubkey, 1));
+        TEST_ASSERT_EQUAL_INT(1, is_valid_privkey(privkey));
+
+        // The handle and the one-shot path must agree
+        TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_derive_pubkey_ctx(ctx, privkey, derived, 1));
+        TEST_ASSERT_EQUAL_MEMORY(pubkey, derived, PUBKEY_COMPRESSION_SIZE);
+        TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_derive_pubkey(privkey, derived, 1));
+        TEST_ASSERT_EQUAL_MEMORY(pubkey, derived, PUBKEY_COMPRESSION_SIZE);
+    }
+
+    secp256k1_wrapper_ctx_destroy(ctx);
+    secure_memzero(privkey, sizeof(privkey));
 }
 
-/* ========== Main Test Runner ========== */
+void test_ctx_rerandomize(void) {
+    unsigned char privkey[PRIVKEY_SIZE];
+    unsigned char pubkey[PUBKEY_UNCOMPRESSION_SIZE];
 
-int main(void) {
-    UNITY_BEGIN();
-    
-    // Basic functionality
-    RUN_TEST(test_generate_compressed_keys);
-    RUN_TEST(test_generate_uncompressed_keys);
-    
-    // derive_pubkey tests
-    RUN_TEST(test_derive_pubkey_compressed);
-    RUN_TEST(test_derive_pubkey_uncompressed);
-    RUN_TEST(test_same_privkey_different_formats);
-    
-    // Error handling
-    RUN_TEST(test_generate_keys_null_privkey);
-    RUN_TEST(test_generate_keys_null_pubkey);
-    RUN_TEST(test_generate_keys_invalid_compressed);
-    RUN_TEST(test_derive_pubkey_null_privkey);
-    RUN_TEST(test_derive_pubkey_null_pubkey);
-    RUN_TEST(test_derive_pubkey_invalid_compressed);
-    RUN_TEST(test_derive_pubkey_invalid_privkey);
-    
-    // Stress tests
-    RUN_TEST(test_stress_compressed_generation);
-    RUN_TEST(test_stress_uncompressed_generation);
-    RUN_TEST(test_key_uniqueness);
-    
-    // Known vectors
-    RUN_TEST(test_known_private_key);
+    secp256k1_wrapper_ctx* ctx = secp256k1_wrapper_ctx_create();
+    TEST_ASSERT_NOT_NULL(ctx);
+
+    TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_ctx_rerandomize(ctx));
+    TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_generate_keys_ctx(ctx, privkey, pubkey, 0));
+    TEST_ASSERT_EQUAL_HEX8(0x04, pubkey[0]);
+
+    secp256k1_wrapper_ctx_destroy(ctx);
+    secure_memzero(privkey, sizeof(privkey));
+}
+
+void test_ctx_invalid_input(void) {
+    unsigned char privkey[PRIVKEY_SIZE];
+    unsigned char pubkey[PUBKEY_COMPRESSION_SIZE];
+
+    TEST_ASSERT_EQUAL_INT(-1, secp256k1_wrapper_generate_keys_ctx(NULL, privkey, pubkey, 1));
+    TEST_ASSERT_EQUAL_INT(-1, secp256k1_wrapper_derive_pubkey_ctx(NULL, privkey, pubkey, 1));
+    TEST_ASSERT_EQUAL_INT(-1, secp256k1_wrapper_ctx_rerandomize(NULL));
+    secp256k1_wrapper_ctx_destroy(NULL);  // Must be a no-op
+
+    secp256k1_wrapper_ctx* ctx = secp256k1_wrapper_ctx_create();
+    TEST_ASSERT_NOT_NULL(ctx);
+    TEST_ASSERT_EQUAL_INT(-1, secp256k1_wrapper_generate_keys_ctx(ctx, privkey, pubkey, 2));
+
+    memset(privkey, 0x00, sizeof(privkey));
+    TEST_ASSERT_EQUAL_INT(-5, secp256k1_wrapper_derive_pubkey_ctx(ctx, privkey, pubkey, 1));
+    secp256k1_wrapper_ctx_destroy(ctx);
+}
+
+/* ========== Thread Cache Tests ========== */
+
+void test_thread_cache_generate_and_derive(void) {
+    unsigned char privkey[PRIVKEY_SIZE];
+    unsigned char pubkey[PUBKEY_COMPRESSION_SIZE];
+    unsigned char derived[PUBKEY_COMPRESSION_SIZE];
+
+    secp256k1_wrapper_thread_cache_enable(1);
+    TEST_ASSERT_EQUAL_INT(1, secp256k1_wrapper_thread_cache_enabled());
+
+    for (int i = 0; i < 20; i++) {
+        TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_generate_keys(privkey, pubkey, 1));
+        TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_derive_pubkey(privkey, derived, 1));
+        TEST_ASSERT_EQUAL_MEMORY(pubkey, derived, PUBKEY_COMPRESSION_SIZE);
+    }
+
+    // Dropping the cached context must not break the next call
+    secp256k1_wrapper_thread_cache_release();
+    TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_generate_keys(privkey, pubkey, 1));
+    TEST_ASSERT_EQUAL_INT(-1, secp256k1_wrapper_generate_keys(NULL, pubkey, 1));
+
+    secp256k1_wrapper_thread_cache_enable(0);
+    TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_thread_cache_enabled());
+    secp256k1_wrapper_thread_cache_release();
+    secure_memzero(privkey, sizeof(privkey));
+}
+
+#if !defined(_WIN32)
+static void* thread_cache_worker(void* arg) {
+    int* failures = (int*)arg;
+    unsigned char privkey[PRIVKEY_SIZE];
+    unsigned char pubkey[PUBKEY_COMPRESSION_SIZE];
+    unsigned char derived[PUBKEY_COMPRESSION_SIZE];
+
+    for (int i = 0; i < 50; i++) {
+        if (secp256k1_wrapper_generate_keys(privkey, pubkey, 1) != 0 ||
+            secp256k1_wrapper_derive_pubkey(privkey, derived, 1) != 0 ||
+            memcmp(pubkey, derived, sizeof(pubkey)) != 0) {
+            (*failures)++;
+        }
+    }
+    secure_memzero(privkey, sizeof(privkey));
+    return NULL;  // cached context is released by the thread-exit destructor
+}
+#endif
+
+void test_thread_cache_multithreaded(void) {
+#if defined(_WIN32)
+    TEST_IGNORE_MESSAGE("pthread-based test");
+#else
+    enum { NUM_THREADS = 4 };
+    pthread_t threads[NUM_THREADS];
+    int failures[NUM_THREADS] = {0};
+
+    secp256k1_wrapper_thread_cache_enable(1);
+    for (int i = 0; i < NUM_THREADS; i++) {
+        TEST_ASSERT_EQUAL_INT(0, pthread_create(&threads[i], NULL, thread_cache_worker, &failures[i]));
+    }
+    for (int i = 0; i < NUM_THREADS; i++) {
+        TEST_ASSERT_EQUAL_INT(0, pthread_join(threads[i], NULL));
+        TEST_ASSERT_EQUAL_INT(0, failures[i]);
+    }
+    secp256k1_wrapper_thread_cache_enable(0);
+#endif
+}
+
+/* ========== Context Pool Tests ========== */
+
+void test_ctx_pool_hits_and_misses(void) {
+    unsigned char privkey[PRIVKEY_SIZE];
+    unsigned char pubkey[PUBKEY_COMPRESSION_SIZE];
+    unsigned char derived[PUBKEY_COMPRESSION_SIZE];
+    secp256k1_wrapper_pool_stats stats;
+
+    TEST_ASSERT_EQUAL_INT(-1, secp256k1_wrapper_ctx_pool_init(0));
+    TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_ctx_pool_init(2));
+    TEST_ASSERT_EQUAL_INT(-1, secp256k1_wrapper_ctx_pool_init(2));  // Already initialized
+
+    for (int i = 0; i < 10; i++) {
+        TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_generate_keys(privkey, pubkey, 1));
+        TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_derive_pubkey(privkey, derived, 1));
+        TEST_ASSERT_EQUAL_MEMORY(pubkey, derived, PUBKEY_COMPRESSION_SIZE);
+    }
+
+    secp256k1_wrapper_ctx_pool_stats(&stats);
+    TEST_ASSERT_EQUAL_size_t(2, stats.size);
+    TEST_ASSERT_EQUAL_UINT64(20, stats.hits);
+    TEST_ASSERT_EQUAL_UINT64(0, stats.misses);
+
+    secp256k1_wrapper_ctx_pool_shutdown();
+    secp256k1_wrapper_ctx_pool_stats(&stats);
+    TEST_ASSERT_EQUAL_size_t(0, stats.size);
+
+    // Falls back to one-shot contexts once the pool is gone
+    TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_generate_keys(privkey, pubkey, 1));
+    secure_memzero(privkey, sizeof(privkey));
+}
+
+#if !defined(_WIN32)
+static void* ctx_pool_worker(void* arg) {
+    int* failures = (int*)arg;
+    unsigned char privkey[PRIVKEY_SIZE];
+    unsigned char pubkey[PUBKEY_COMPRESSION_SIZE];
+    unsigned char derived[PUBKEY_COMPRESSION_SIZE];
+
+    for (int i = 0; i < 100; i++) {
+        if (secp256k1_wrapper_generate_keys(privkey, pubkey, 1) != 0 ||
+            secp256k1_wrapper_derive_pubkey(privkey, derived, 1) != 0 ||
+            memcmp(pubkey, derived, sizeof(pubkey)) != 0) {
+            (*failures)++;
+        }
+    }
+    secure_memzero(privkey, sizeof(privkey));
+    return NULL;
+}
+#endif
+
+void test_ctx_pool_multithreaded(void) {
+#if defined(_WIN32)
+    TEST_IGNORE_MESSAGE("pthread-based test");
+#else
+    enum { NUM_THREADS = 8 };
+    pthread_t threads[NUM_THREADS];
+    int failures[NUM_THREADS] = {0};
+    secp256k1_wrapper_pool_stats stats;
+
+    // Fewer contexts than threads so both hits and misses happen
+    TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_ctx_pool_init(3));
+    for (int i = 0; i < NUM_THREADS; i++) {
+        TEST_ASSERT_EQUAL_INT(0, pthread_create(&threads[i], NULL, ctx_pool_worker, &failures[i]));
+    }
+    for (int i = 0; i < NUM_THREADS; i++) {
+        TEST_ASSERT_EQUAL_INT(0, pthread_join(threads[i], NULL));
+        TEST_ASSERT_EQUAL_INT(0, failures[i]);
+    }
+
+    secp256k1_wrapper_ctx_pool_stats(&stats);
+    TEST_ASSERT_EQUAL_UINT64(NUM_THREADS * 200, stats.hits + stats.misses);
+    secp256k1_wrapper_ctx_pool_shutdown();
+#endif
+}
+
+/* ========== Re-randomization Policy Tests ========== */
+
+void test_rerandomize_policy_invalid(void) {
+    TEST_ASSERT_EQUAL_INT(-1, secp256k1_wrapper_set_rerandomize_policy(42, 1));
+    TEST_ASSERT_EQUAL_INT(-1, secp256k1_wrapper_set_rerandomize_policy(SECP256K1_WRAPPER_RERANDOMIZE_EVERY_N_OPS, 0));
+    TEST_ASSERT_EQUAL_INT(-1, secp256k1_wrapper_set_rerandomize_policy(SECP256K1_WRAPPER_RERANDOMIZE_EVERY_T_MS, 0));
+    TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_set_rerandomize_policy(SECP256K1_WRAPPER_RERANDOMIZE_NEVER, 0));
+}
+
+void test_rerandomize_policy_interval_limit(void) {
+    TEST_ASSERT_EQUAL_INT(-1, secp256k1_wrapper_set_rerandomize_policy(SECP256K1_WRAPPER_RERANDOMIZE_EVERY_T_MS,
+                                                                       SECP256K1_WRAPPER_RERANDOMIZE_T_MS_MAX + 1));
+    TEST_ASSERT_EQUAL_INT(-1, secp256k1_wrapper_set_rerandomize_policy(SECP256K1_WRAPPER_RERANDOMIZE_EVERY_T_MS,
+                                                                       (uint64_t)1 << 62));
+    TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_set_rerandomize_policy(SECP256K1_WRAPPER_RERANDOMIZE_EVERY_T_MS,
+                                                                      SECP256K1_WRAPPER_RERANDOMIZE_T_MS_MAX));
+
+    // Counts of operations have no such limit
+    TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_set_rerandomize_policy(SECP256K1_WRAPPER_RERANDOMIZE_EVERY_N_OPS,
+                                                                      UINT64_MAX));
+    TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_set_rerandomize_policy(SECP256K1_WRAPPER_RERANDOMIZE_NEVER, 0));
+}
+
+void test_rerandomize_policy_operations(void) {
+    const int policies[] = {
+        SECP256K1_WRAPPER_RERANDOMIZE_EVERY_N_OPS,
+        SECP256K1_WRAPPER_RERANDOMIZE_EVERY_T_MS,
+        SECP256K1_WRAPPER_RERANDOMIZE_NEVER
+    };
+    unsigned char privkey[PRIVKEY_SIZE];
+    unsigned char pubkey[PUBKEY_COMPRESSION_SIZE];
+    unsigned char derived[PUBKEY_COMPRESSION_SIZE];
+
+    secp256k1_wrapper_ctx* ctx = secp256k1_wrapper_ctx_create();
+    TEST_ASSERT_NOT_NULL(ctx);
+
+    // Re-blinding must never change results, only the blinding state
+    for (size_t p = 0; p < sizeof(policies) / sizeof(policies[0]); p++) {
+        TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_set_rerandomize_policy(policies[p], 1));
+        for (int i = 0; i < 10; i++) {
+            TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_generate_keys_ctx(ctx, privkey, pubkey, 1));
+            TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_derive_pubkey_ctx(ctx, privkey, derived, 1));
+            TEST_ASSERT_EQUAL_MEMORY(pubkey, derived, PUBKEY_COMPRESSION_SIZE);
+        }
+    }
+
+    secp256k1_wrapper_ctx_destroy(ctx);
+    secure_memzero(privkey, sizeof(privkey));
+}
+
+/* ========== Fork Safety Tests ========== */
+
+#if !defined(_WIN32)
+/* Runs `fn` in a forked child and returns its exit status (0 on success) */
+static int run_in_child(int (*fn)(void)) {
+    fflush(stdout);
+    pid_t pid = fork();
+    if (pid < 0) {
+        return -1;
+    }
+    if (pid == 0) {
+        _exit(fn());
+    }
+    int status = 0;
+    if (waitpid(pid, &status, 0) != pid || !WIFEXITED(status)) {
+        return -1;
+    }
+    return WEXITSTATUS(status);
+}
+
+static int child_uses_cached_state(void) {
+    unsigned char privkey[PRIVKEY_SIZE];
+    unsigned char pubkey[PUBKEY_COMPRESSION_SIZE];
+    unsigned char derived[PUBKEY_COMPRESSION_SIZE];
+    secp256k1_wrapper_pool_stats stats;
+
+    for (int i = 0; i < 10; i++) {
+        if (secp256k1_wrapper_generate_keys(privkey, pubkey, 1) != 0) return 1;
+        if (secp256k1_wrapper_derive_pubkey(privkey, derived, 1) != 0) return 2;
+        if (memcmp(pubkey, derived, sizeof(pubkey)) != 0) return 3;
+    }
+    // Every pooled context is free again in the child
+    secp256k1_wrapper_ctx_pool_stats(&stats);
+    if (stats.misses != 0) return 4;
+    return 0;
+}
+#endif
+
+void test_fork_child_reseeds_cached_contexts(void) {
+#if defined(_WIN32)
+    TEST_IGNORE_MESSAGE("fork() is not available");
+#else
+    unsigned char privkey[PRIVKEY_SIZE];
+    unsigned char pubkey[PUBKEY_COMPRESSION_SIZE];
+
+    TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_ctx_pool_init(2));
+    secp256k1_wrapper_thread_cache_enable(1);
+    TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_generate_keys(privkey, pubkey, 1));
+
+    TEST_ASSERT_EQUAL_INT(0, run_in_child(child_uses_cached_state));
+
+    // The parent is unaffected
+    TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_generate_keys(privkey, pubkey, 1));
+
+    secp256k1_wrapper_thread_cache_enable(0);
+    secp256k1_wrapper_thread_cache_release();
+    secp256k1_wrapper_ctx_pool_shutdown();
+    secure_memzero(privkey, sizeof(privkey));
+#endif
+}
+
+/* ========== System RNG Tests ========== */
+
+#if !defined(_WIN32)
+/* Each thread gets its own vgetrandom state on Linux, unmapped at thread exit */
+static void* fill_random_worker(void* arg) {
+    int* failures = (int*)arg;
+    unsigned char a[32], b[32];
+
+    for (int i = 0; i < 200; i++) {
+        if (secp256k1_wrapper_fill_random(a, sizeof(a)) != 1 ||
+            secp256k1_wrapper_fill_random(b, sizeof(b)) != 1 ||
+            memcmp(a, b, sizeof(a)) == 0) {
+            (*failures)++;
+        }
+    }
+    return NULL;
+}
+#endif
+
+void test_fill_random_multithreaded(void) {
+#if defined(_WIN32)
+    TEST_IGNORE_MESSAGE("pthread-based test");
+#else
+    enum { NUM_THREADS = 4, ROUNDS = 3 };
+    pthread_t threads[NUM_THREADS];
+    int failures[NUM_THREADS] = {0};
+
+    // Several rounds so thread exit and state re-creation are exercised too
+    for (int round = 0; round < ROUNDS; round++) {
+        for (int i = 0; i < NUM_THREADS; i++) {
+            TEST_ASSERT_EQUAL_INT(0, pthread_create(&threads[i], NULL, fill_random_worker, &failures[i]));
+        }
+        for (int i = 0; i < NUM_THREADS; i++) {
+            TEST_ASSERT_EQUAL_INT(0, pthread_join(threads[i], NULL));
+        }
+    }
+    for (int i = 0; i < NUM_THREADS; i++) {
+        TEST_ASSERT_EQUAL_INT(0, failures[i]);
+    }
+#endif
+}
+
+/* Above getrandom's 32 MiB per-call limit, so short reads must be resumed */
+void test_fill_random_large_buffer(void) {
+    const size_t size = 40u * 1024u * 1024u;
+    unsigned char* big = (unsigned char*)malloc(size);
+    TEST_ASSERT_NOT_NULL(big);
+    memset(big, 0, size);
+
+    TEST_ASSERT_EQUAL_INT(1, secp256k1_wrapper_fill_random(big, size));
+    TEST_ASSERT_EQUAL_INT(0, is_all_zeros(big, 64));
+    TEST_ASSERT_EQUAL_INT(0, is_all_zeros(big + size - 64, 64));
+    free(big);
+}
+
+/* ========== Buffered RNG Tests ========== */
+
+void test_rng_buffered_invalid(void) {
+    TEST_ASSERT_EQUAL_INT(-1, secp256k1_wrapper_set_rng(42, 0));
+    TEST_ASSERT_EQUAL_INT(-1, secp256k1_wrapper_set_rng(SECP256K1_WRAPPER_RNG_BUFFERED, SECP256K1_WRAPPER_RNG_BUFFER_MIN - 1));
+    TEST_ASSERT_EQUAL_INT(-1, secp256k1_wrapper_set_rng(SECP256K1_WRAPPER_RNG_BUFFERED, SECP256K1_WRAPPER_RNG_BUFFER_MAX + 1));
+    TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_set_rng(SECP256K1_WRAPPER_RNG_SYSTEM, 0));
+}
+
+void test_rng_buffered_output(void) {
+    unsigned char a[32], b[32];
+    unsigned char big[8192];
+    unsigned char privkey[PRIVKEY_SIZE];
+    unsigned char pubkey[PUBKEY_COMPRESSION_SIZE];
+
+    TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_set_rng(SECP256K1_WRAPPER_RNG_BUFFERED, 4096));
+
+    // Enough draws to cross several refills
+    for (int i = 0; i < 500; i++) {
+        TEST_ASSERT_EQUAL_INT(1, secp256k1_wrapper_fill_random(a, sizeof(a)));
+        TEST_ASSERT_EQUAL_INT(1, secp256k1_wrapper_fill_random(b, sizeof(b)));
+        TEST_ASSERT_FALSE(memcmp(a, b, sizeof(a)) == 0);
+    }
+
+    // Larger than the buffer, served directly
+    TEST_ASSERT_EQUAL_INT(1, secp256k1_wrapper_fill_random(big, sizeof(big)));
+    TEST_ASSERT_EQUAL_INT(0, is_all_zeros(big, sizeof(big)));
+
+    TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_generate_keys(privkey, pubkey, 1));
+    TEST_ASSERT_EQUAL_INT(1, is_valid_privkey(privkey));
+
+    // Resizing replaces the buffer on the next call
+    TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_set_rng(SECP256K1_WRAPPER_RNG_BUFFERED, 0));
+    TEST_ASSERT_EQUAL_INT(1, secp256k1_wrapper_fill_random(a, sizeof(a)));
+
+    secp256k1_wrapper_rng_thread_release();
+    TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_set_rng(SECP256K1_WRAPPER_RNG_SYSTEM, 0));
+    secure_memzero(privkey, sizeof(privkey));
+}
+
+void test_rng_buffered_fork(void) {
+#if defined(_WIN32)
+    TEST_IGNORE_MESSAGE("fork() is not available");
+#else
+    unsigned char parent_bytes[32], child_bytes[32];
+    int fds[2];
+
+    TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_set_rng(SECP256K1_WRAPPER_RNG_BUFFERED, 4096));
+    TEST_ASSERT_EQUAL_INT(1, secp256k1_wrapper_fill_random(parent_bytes, sizeof(parent_bytes)));  // prime the buffer
+    TEST_ASSERT_EQUAL_INT(0, pipe(fds));
+
+    fflush(stdout);
+    pid_t pid = fork();
+    TEST_ASSERT_TRUE(pid >= 0);
+    if (pid == 0) {
+        int ok = secp256k1_wrapper_fill_random(child_bytes, sizeof(child_bytes));
+        ssize_t w = write(fds[1], child_bytes, sizeof(child_bytes));
+        _exit(ok == 1 && w == (ssize_t)sizeof(child_bytes) ? 0 : 1);
+    }
+
+    // Both sides draw right after the fork; without the fork check they would match
+    TEST_ASSERT_EQUAL_INT(1, secp256k1_wrapper_fill_random(parent_bytes, sizeof(parent_bytes)));
+    TEST_ASSERT_EQUAL_INT((int)sizeof(child_bytes), (int)read(fds[0], child_bytes, sizeof(child_bytes)));
+
+    int status = 0;
+    TEST_ASSERT_EQUAL_INT(pid, waitpid(pid, &status, 0));
+    TEST_ASSERT_TRUE(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+    TEST_ASSERT_FALSE(memcmp(parent_bytes, child_bytes, sizeof(parent_bytes)) == 0);
+
+    close(fds[0]);
+    close(fds[1]);
+    secp256k1_wrapper_rng_thread_release();
+    TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_set_rng(SECP256K1_WRAPPER_RNG_SYSTEM, 0));
+#endif
+}
+
+/* ========== ChaCha20 DRBG Tests ========== */
+
+void test_rng_chacha20_output(void) {
+    unsigned char a[32], b[32];
+    unsigned char big[100000];
+    unsigned char privkey[PRIVKEY_SIZE];
+    unsigned char pubkey[PUBKEY_COMPRESSION_SIZE];
+
+    TEST_ASSERT_EQUAL_INT(-1, secp256k1_wrapper_set_rng(SECP256K1_WRAPPER_RNG_CHACHA20, SECP256K1_WRAPPER_RNG_BUFFER_MIN - 1));
+    TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_set_rng(SECP256K1_WRAPPER_RNG_CHACHA20, 4096));
+
+    for (int i = 0; i < 500; i++) {
+        TEST_ASSERT_EQUAL_INT(1, secp256k1_wrapper_fill_random(a, sizeof(a)));
+        TEST_ASSERT_EQUAL_INT(1, secp256k1_wrapper_fill_random(b, sizeof(b)));
+        TEST_ASSERT_FALSE(memcmp(a, b, sizeof(a)) == 0);
+    }
+
+    // Bulk request spanning several DRBG steps, not block aligned
+    TEST_ASSERT_EQUAL_INT(1, secp256k1_wrapper_fill_random(big, sizeof(big)));
+    TEST_ASSERT_EQUAL_INT(0, is_all_zeros(big + sizeof(big) - 64, 64));
+    TEST_ASSERT_FALSE(memcmp(big, big + 65536, 64) == 0);
+
+    TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_generate_keys(privkey, pubkey, 1));
+    TEST_ASSERT_EQUAL_INT(1, is_valid_privkey(privkey));
+
+    secp256k1_wrapper_rng_thread_release();
+    TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_set_rng(SECP256K1_WRAPPER_RNG_SYSTEM, 0));
+    secure_memzero(privkey, sizeof(privkey));
+}
+
+void test_rng_chacha20_fork(void) {
+#if defined(_WIN32)
+    TEST_IGNORE_MESSAGE("fork() is not available");
+#else
+    unsigned char parent_bytes[4096], child_bytes[4096];
+    int fds[2];
+
+    // Requests above a quarter of the buffer come straight from the DRBG key
+    TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_set_rng(SECP256K1_WRAPPER_RNG_CHACHA20, 4096));
+    TEST_ASSERT_EQUAL_INT(1, secp256k1_wrapper_fill_random(parent_bytes, sizeof(parent_bytes)));  // seed the DRBG
+    TEST_ASSERT_EQUAL_INT(0, pipe(fds));
+
+    fflush(stdout);
+    pid_t pid = fork();
+    TEST_ASSERT_TRUE(pid >= 0);
+    if (pid == 0) {
+        int ok = secp256k1_wrapper_fill_random(child_bytes, sizeof(child_bytes));
+        ssize_t w = write(fds[1], child_bytes, sizeof(child_bytes));
+        _exit(ok == 1 && w == (ssize_t)sizeof(child_bytes) ? 0 : 1);
+    }
+
+    TEST_ASSERT_EQUAL_INT(1, secp256k1_wrapper_fill_random(parent_bytes, sizeof(parent_bytes)));
+    size_t got = 0;
+    while (got < sizeof(child_bytes)) {
+        ssize_t r = read(fds[0], child_bytes + got, sizeof(child_bytes) - got);
+        TEST_ASSERT_TRUE(r > 0);
+        got += (size_t)r;
+    }
+
+    int status = 0;
+    TEST_ASSERT_EQUAL_INT(pid, waitpid(pid, &status, 0));
+    TEST_ASSERT_TRUE(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+    TEST_ASSERT_FALSE(memcmp(parent_bytes, child_bytes, sizeof(parent_bytes)) == 0);
+
+    close(fds[0]);
+    close(fds[1]);
+    secp256k1_wrapper_rng_thread_release();
+    TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_set_rng(SECP256K1_WRAPPER_RNG_SYSTEM, 0));
+#endif
+}
+
+/* ========== Batch Generation Tests ========== */
+
+#define BATCH_SIZE 64
+
+static void check_generated_batch(const unsigned char* privkeys, const unsigned char* pubkeys, size_t n, int compressed) {
+    size_t pubkey_size = compressed ? PUBKEY_COMPRESSION_SIZE : PUBKEY_UNCOMPRESSION_SIZE;
+    unsigned char derived[PUBKEY_UNCOMPRESSION_SIZE];
+
+    for (size_t i = 0; i < n; i++) {
+        TEST_ASSERT_EQUAL_INT(1, is_valid_privkey(privkeys + i * PRIVKEY_SIZE));
+        TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_derive_pubkey(privkeys + i * PRIVKEY_SIZE, derived, compressed));
+        TEST_ASSERT_EQUAL_MEMORY(derived, pubkeys + i * pubkey_size, pubkey_size);
+        for (size_t j = 0; j < i; j++) {
+            TEST_ASSERT_FALSE(memcmp(privkeys + i * PRIVKEY_SIZE, privkeys + j * PRIVKEY_SIZE, PRIVKEY_SIZE) == 0);
+        }
+    }
+}
+
+void test_generate_keys_batch(void) {
+    unsigned char privkeys[BATCH_SIZE * PRIVKEY_SIZE];
+    unsigned char pubkeys[BATCH_SIZE * PUBKEY_UNCOMPRESSION_SIZE];
+    int results[BATCH_SIZE];
+
+    TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_generate_keys_batch(privkeys, pubkeys, BATCH_SIZE, 1,
+                                                                   SECP256K1_WRAPPER_BATCH_ALL_OR_NOTHING, NULL));
+    check_generated_batch(privkeys, pubkeys, BATCH_SIZE, 1);
+
+    memset(results, 0x7f, sizeof(results));
+    TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_generate_keys_batch(privkeys, pubkeys, BATCH_SIZE, 0,
+                                                                   SECP256K1_WRAPPER_BATCH_PER_ITEM, results));
+    check_generated_batch(privkeys, pubkeys, BATCH_SIZE, 0);
+    for (int i = 0; i < BATCH_SIZE; i++) {
+        TEST_ASSERT_EQUAL_INT(0, results[i]);
+    }
+
+    // Bulk draw through the ChaCha20 source, larger than its buffer
+    TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_set_rng(SECP256K1_WRAPPER_RNG_CHACHA20, 4096));
+    TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_generate_keys_batch(privkeys, pubkeys, BATCH_SIZE, 1,
+                                                                   SECP256K1_WRAPPER_BATCH_ALL_OR_NOTHING, NULL));
+    check_generated_batch(privkeys, pubkeys, BATCH_SIZE, 1);
+    secp256k1_wrapper_rng_thread_release();
+    TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_set_rng(SECP256K1_WRAPPER_RNG_SYSTEM, 0));
+
+    secure_memzero(privkeys, sizeof(privkeys));
+}
+
+void test_generate_keys_batch_invalid_input(void) {
+    unsigned char privkeys[2 * PRIVKEY_SIZE];
+    unsigned char pubkeys[2 * PUBKEY_COMPRESSION_SIZE];
+    int results[2];
+
+    TEST_ASSERT_EQUAL_INT(-1, secp256k1_wrapper_generate_keys_batch(NULL, pubkeys, 2, 1, SECP256K1_WRAPPER_BATCH_ALL_OR_NOTHING, NULL));
+    TEST_ASSERT_EQUAL_INT(-1, secp256k1_wrapper_generate_keys_batch(privkeys, NULL, 2, 1, SECP256K1_WRAPPER_BATCH_ALL_OR_NOTHING, NULL));
+    TEST_ASSERT_EQUAL_INT(-1, secp256k1_wrapper_generate_keys_batch(privkeys, pubkeys, 2, 2, SECP256K1_WRAPPER_BATCH_ALL_OR_NOTHING, NULL));
+    TEST_ASSERT_EQUAL_INT(-1, secp256k1_wrapper_generate_keys_batch(privkeys, pubkeys, 2, 1, 7, results));
+    TEST_ASSERT_EQUAL_INT(-1, secp256k1_wrapper_generate_keys_batch(privkeys, pubkeys, 2, 1, SECP256K1_WRAPPER_BATCH_PER_ITEM, NULL));
+    TEST_ASSERT_EQUAL_INT(-1, secp256k1_wrapper_generate_keys_batch(privkeys, pubkeys, SIZE_MAX, 1, SECP256K1_WRAPPER_BATCH_ALL_OR_NOTHING, NULL));
+
+    // Empty batch is a no-op
+    TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_generate_keys_batch(privkeys, pubkeys, 0, 1, SECP256K1_WRAPPER_BATCH_ALL_OR_NOTHING, NULL));
+}
+
+/* ========== Batch Derivation Tests ========== */
+
+void test_derive_pubkey_batch(void) {
+    unsigned char privkeys[BATCH_SIZE * PRIVKEY_SIZE];
+    unsigned char pubkeys[BATCH_SIZE * PUBKEY_UNCOMPRESSION_SIZE];
+    unsigned char expected[PUBKEY_UNCOMPRESSION_SIZE];
+    int results[BATCH_SIZE];
+
+    for (int compressed = 0; compressed <= 1; compressed++) {
+        size_t pubkey_size = compressed ? PUBKEY_COMPRESSION_SIZE : PUBKEY_UNCOMPRESSION_SIZE;
+        for (int i = 0; i < BATCH_SIZE; i++) {
+            TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_generate_keys(privkeys + i * PRIVKEY_SIZE, expected, compressed));
+        }
+
+        TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_derive_pubkey_batch(privkeys, pubkeys, BATCH_SIZE, compressed, results));
+        for (int i = 0; i < BATCH_SIZE; i++) {
+            TEST_ASSERT_EQUAL_INT(0, results[i]);
+            TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_derive_pubkey(privkeys + i * PRIVKEY_SIZE, expected, compressed));
+            TEST_ASSERT_EQUAL_MEMORY(expected, pubkeys + i * pubkey_size, pubkey_size);
+        }
+    }
+    secure_memzero(privkeys, sizeof(privkeys));
+}
+
+void test_derive_pubkey_batch_bad_keys(void) {
+    unsigned char privkeys[4 * PRIVKEY_SIZE];
+    unsigned char pubkeys[4 * PUBKEY_COMPRESSION_SIZE];
+    unsigned char expected[PUBKEY_COMPRESSION_SIZE];
+    int results[4];
+
+    TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_generate_keys(privkeys, expected, 1));
+    memset(privkeys + 1 * PRIVKEY_SIZE, 0, PRIVKEY_SIZE);     // zero key
+    memset(privkeys + 2 * PRIVKEY_SIZE, 0xFF, PRIVKEY_SIZE);  // above the group order
+    TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_generate_keys(privkeys + 3 * PRIVKEY_SIZE, expected, 1));
+
+    // Bad keys are reported, the batch keeps going
+    TEST_ASSERT_EQUAL_INT(-5, secp256k1_wrapper_derive_pubkey_batch(privkeys, pubkeys, 4, 1, results));
+    TEST_ASSERT_EQUAL_INT(0, results[0]);
+    TEST_ASSERT_EQUAL_INT(-5, results[1]);
+    TEST_ASSERT_EQUAL_INT(-5, results[2]);
+    TEST_ASSERT_EQUAL_INT(0, results[3]);
+    TEST_ASSERT_EQUAL_INT(1, is_all_zeros(pubkeys + 1 * PUBKEY_COMPRESSION_SIZE, PUBKEY_COMPRESSION_SIZE));
+    TEST_ASSERT_EQUAL_MEMORY(expected, pubkeys + 3 * PUBKEY_COMPRESSION_SIZE, PUBKEY_COMPRESSION_SIZE);
+
+    TEST_ASSERT_EQUAL_INT(-1, secp256k1_wrapper_derive_pubkey_batch(NULL, pubkeys, 4, 1, results));
+    TEST_ASSERT_EQUAL_INT(-1, secp256k1_wrapper_derive_pubkey_batch(privkeys, NULL, 4, 1, results));
+    TEST_ASSERT_EQUAL_INT(-1, secp256k1_wrapper_derive_pubkey_batch(privkeys, pubkeys, 4, 1, NULL));
+    TEST_ASSERT_EQUAL_INT(-1, secp256k1_wrapper_derive_pubkey_batch(privkeys, pubkeys, 4, -1, results));
+    TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_derive_pubkey_batch(privkeys, pubkeys, 0, 1, results));
+    secure_memzero(privkeys, sizeof(privkeys));
+}
+
+/* ========== Strided Batch Tests ========== */
+
+#define RECORD_COUNT 150  // crosses the 64-key entropy stage twice
+
+typedef struct test_record {
+    uint32_t id;
+    unsigned char privkey[PRIVKEY_SIZE];
+    unsigned char pubkey[PUBKEY_UNCOMPRESSION_SIZE];
+    unsigned char tag;
+} test_record;
+
+static void check_records(const test_record* records, size_t n, int compressed) {
+    size_t pubkey_size = compressed ? PUBKEY_COMPRESSION_SIZE : PUBKEY_UNCOMPRESSION_SIZE;
+    unsigned char derived[PUBKEY_UNCOMPRESSION_SIZE];
+
+    for (size_t i = 0; i < n; i++) {
+        TEST_ASSERT_EQUAL_UINT32((uint32_t)i, records[i].id);  // neighbouring fields untouched
+        TEST_ASSERT_EQUAL_UINT8(0xA5, records[i].tag);
+        TEST_ASSERT_EQUAL_INT(1, is_valid_privkey(records[i].privkey));
+        TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_derive_pubkey(records[i].privkey, derived, compressed));
+        TEST_ASSERT_EQUAL_MEMORY(derived, records[i].pubkey, pubkey_size);
+        if (i > 0) {
+            TEST_ASSERT_FALSE(memcmp(records[i].privkey, records[i - 1].privkey, PRIVKEY_SIZE) == 0);
+        }
+    }
+}
+
+static void init_records(test_record* records, size_t n) {
+    memset(records, 0, n * sizeof(*records));
+    for (size_t i = 0; i < n; i++) {
+        records[i].id = (uint32_t)i;
+        records[i].tag = 0xA5;
+    }
+}
+
+void test_generate_keys_strided(void) {
+    static test_record records[RECORD_COUNT];
+    int results[RECORD_COUNT];
+
+    init_records(records, RECORD_COUNT);
+    TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_generate_keys_strided(records[0].privkey, sizeof(test_record),
+                                                                     records[0].pubkey, sizeof(test_record),
+                                                                     RECORD_COUNT, 1,
+                                                                     SECP256K1_WRAPPER_BATCH_ALL_OR_NOTHING, NULL));
+    check_records(records, RECORD_COUNT, 1);
+
+    // Parallel chunks start mid-array
+    init_records(records, RECORD_COUNT);
+    TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_set_parallel(4, 16));
+    TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_generate_keys_strided(records[0].privkey, sizeof(test_record),
+                                                                     records[0].pubkey, sizeof(test_record),
+                                                                     RECORD_COUNT, 0,
+                                                                     SECP256K1_WRAPPER_BATCH_PER_ITEM, results));
+    TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_set_parallel(0, 0));
+    check_records(records, RECORD_COUNT, 0);
+    for (int i = 0; i < RECORD_COUNT; i++) {
+        TEST_ASSERT_EQUAL_INT(0, results[i]);
+    }
+
+    // Stride 0 is packed, same as the contiguous call
+    unsigned char privkeys[BATCH_SIZE * PRIVKEY_SIZE];
+    unsigned char pubkeys[BATCH_SIZE * PUBKEY_COMPRESSION_SIZE];
+    TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_generate_keys_strided(privkeys, 0, pubkeys, 0, BATCH_SIZE, 1,
+                                                                     SECP256K1_WRAPPER_BATCH_ALL_OR_NOTHING, NULL));
+    check_generated_batch(privkeys, pubkeys, BATCH_SIZE, 1);
+
+    secure_memzero(records, sizeof(records));
+    secure_memzero(privkeys, sizeof(privkeys));
+}
+
+void test_scatter_batches(void) {
+    static test_record records[RECORD_COUNT];
+    unsigned char* privs[RECORD_COUNT];
+    unsigned char* pubs[RECORD_COUNT];
+    unsigned char pubkeys[RECORD_COUNT * PUBKEY_COMPRESSION_SIZE];
+    int results[RECORD_COUNT];
+
+    // Pointers in reverse order, as a heap of objects would be in any order
+    init_records(records, RECORD_COUNT);
+    for (int i = 0; i < RECORD_COUNT; i++) {
+        privs[i] = records[RECORD_COUNT - 1 - i].privkey;
+        pubs[i] = records[RECORD_COUNT - 1 - i].pubkey;
+    }
+    TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_generate_keys_scatter(privs, pubs, RECORD_COUNT, 1,
+                                                                     SECP256K1_WRAPPER_BATCH_PER_ITEM, results));
+    check_records(records, RECORD_COUNT, 1);
+
+    // Gathering the keys back gives the same public keys as the strided form
+    TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_derive_pubkey_scatter((const unsigned char* const*)privs, pubs,
+                                                                     RECORD_COUNT, 0, results));
+    TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_derive_pubkey_strided(records[0].privkey, sizeof(test_record),
+                                                                     pubkeys, 0, RECORD_COUNT, 1, results));
+    check_records(records, RECORD_COUNT, 0);
+    for (int i = 0; i < RECORD_COUNT; i++) {
+        unsigned char expected[PUBKEY_COMPRESSION_SIZE];
+        TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_derive_pubkey(records[i].privkey, expected, 1));
+        TEST_ASSERT_EQUAL_MEMORY(expected, pubkeys + i * PUBKEY_COMPRESSION_SIZE, PUBKEY_COMPRESSION_SIZE);
+    }
+
+    // A bad key only fails its own slot
+    memset(records[3].privkey, 0, PRIVKEY_SIZE);
+    TEST_ASSERT_EQUAL_INT(-5, secp256k1_wrapper_derive_pubkey_strided(records[0].privkey, sizeof(test_record),
+                                                                      records[0].pubkey, sizeof(test_record),
+                                                                      RECORD_COUNT, 1, results));
+    TEST_ASSERT_EQUAL_INT(-5, results[3]);
+    TEST_ASSERT_EQUAL_INT(0, results[4]);
+    TEST_ASSERT_EQUAL_INT(1, is_all_zeros(records[3].pubkey, PUBKEY_COMPRESSION_SIZE));
+
+    secure_memzero(records, sizeof(records));
+}
+
+void test_strided_invalid_input(void) {
+    unsigned char privkeys[2 * PRIVKEY_SIZE];
+    unsigned char pubkeys[2 * PUBKEY_UNCOMPRESSION_SIZE];
+    unsigned char* privs[2] = { privkeys, NULL };
+    unsigned char* pubs[2] = { pubkeys, pubkeys + PUBKEY_UNCOMPRESSION_SIZE };
+    int results[2];
+
+    // Strides shorter than a key would overlap neighbours
+    TEST_ASSERT_EQUAL_INT(-1, secp256k1_wrapper_generate_keys_strided(privkeys, 31, pubkeys, 0, 2, 1,
+                                                                      SECP256K1_WRAPPER_BATCH_ALL_OR_NOTHING, NULL));
+    TEST_ASSERT_EQUAL_INT(-1, secp256k1_wrapper_generate_keys_strided(privkeys, 0, pubkeys, 33, 2, 0,
+                                                                      SECP256K1_WRAPPER_BATCH_ALL_OR_NOTHING, NULL));
+    TEST_ASSERT_EQUAL_INT(-1, secp256k1_wrapper_derive_pubkey_strided(privkeys, 16, pubkeys, 0, 2, 1, results));
+    // ... and ones that run off the address space
+    TEST_ASSERT_EQUAL_INT(-1, secp256k1_wrapper_generate_keys_strided(privkeys, SIZE_MAX / 2, pubkeys, 0, 3, 1,
+                                                                      SECP256K1_WRAPPER_BATCH_ALL_OR_NOTHING, NULL));
+    TEST_ASSERT_EQUAL_INT(-1, secp256k1_wrapper_generate_keys_strided(NULL, 0, pubkeys, 0, 2, 1,
+                                                                      SECP256K1_WRAPPER_BATCH_ALL_OR_NOTHING, NULL));
+    TEST_ASSERT_EQUAL_INT(-1, secp256k1_wrapper_generate_keys_strided(privkeys, 0, pubkeys, 0, 2, 1,
+                                                                      SECP256K1_WRAPPER_BATCH_PER_ITEM, NULL));
+
+    // Every pointer must be set
+    TEST_ASSERT_EQUAL_INT(-1, secp256k1_wrapper_generate_keys_scatter(privs, pubs, 2, 1,
+                                                                      SECP256K1_WRAPPER_BATCH_ALL_OR_NOTHING, NULL));
+    TEST_ASSERT_EQUAL_INT(-1, secp256k1_wrapper_generate_keys_scatter(NULL, pubs, 2, 1,
+                                                                      SECP256K1_WRAPPER_BATCH_ALL_OR_NOTHING, NULL));
+    TEST_ASSERT_EQUAL_INT(-1, secp256k1_wrapper_derive_pubkey_scatter((const unsigned char* const*)privs, pubs,
+                                                                      2, 1, results));
+    TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_generate_keys_scatter(privs, pubs, 1, 1,
+                                                                     SECP256K1_WRAPPER_BATCH_ALL_OR_NOTHING, NULL));
+    TEST_ASSERT_EQUAL_INT(-1, secp256k1_wrapper_derive_pubkey_scatter(NULL, pubs, 0, 1, results));
+    secure_memzero(privkeys, sizeof(privkeys));
+}
+
+/* ========== Key Range Tests ========== */
+
+#define RANGE_SIZE 100
+
+/* key += add, big-endian */
+static void add_to_key(unsigned char* key, unsigned int add) {
+    for (int i = PRIVKEY_SIZE - 1; i >= 0 && add != 0; i--) {
+        add += key[i];
+        key[i] = (unsigned char)add;
+        add >>= 8;
+    }
+}
+
+static void check_range(const unsigned char* start, const unsigned char* pubkeys, size_t n, int compressed) {
+    size_t pubkey_size = compressed ? PUBKEY_COMPRESSION_SIZE : PUBKEY_UNCOMPRESSION_SIZE;
+    unsigned char key[PRIVKEY_SIZE];
+    unsigned char expected[PUBKEY_UNCOMPRESSION_SIZE];
+
+    memcpy(key, start, PRIVKEY_SIZE);
+    for (size_t i = 0; i < n; i++) {
+        TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_derive_pubkey(key, expected, compressed));
+        TEST_ASSERT_EQUAL_MEMORY(expected, pubkeys + i * pubkey_size, pubkey_size);
+        add_to_key(key, 1);
+    }
+    secure_memzero(key, sizeof(key));
+}
+
+void test_derive_pubkey_range(void) {
+    unsigned char start[PRIVKEY_SIZE];
+    unsigned char pubkey[PUBKEY_UNCOMPRESSION_SIZE];
+    static unsigned char pubkeys[RANGE_SIZE * PUBKEY_UNCOMPRESSION_SIZE];
+
+    TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_generate_keys(start, pubkey, 1));
+    start[PRIVKEY_SIZE - 1] = 0xF0;  // the range carries across bytes
+
+    for (int compressed = 0; compressed <= 1; compressed++) {
+        TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_derive_pubkey_range(start, RANGE_SIZE, pubkeys, compressed));
+        check_range(start, pubkeys, RANGE_SIZE, compressed);
+    }
+
+    // Parallel chunks each start from their own offset
+    memset(pubkeys, 0, sizeof(pubkeys));
+    TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_set_parallel(4, 16));
+    TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_derive_pubkey_range(start, RANGE_SIZE, pubkeys, 1));
+    TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_set_parallel(0, 0));
+    check_range(start, pubkeys, RANGE_SIZE, 1);
+
+    secure_memzero(start, sizeof(start));
+}
+
+void test_derive_pubkey_range_limits(void) {
+    // n - 1, the largest valid private key
+    unsigned char last[PRIVKEY_SIZE] = {
+        0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFE,
+        0xBA, 0xAE, 0xDC, 0xE6, 0xAF, 0x48, 0xA0, 0x3B, 0xBF, 0xD2, 0x5E, 0x8C, 0xD0, 0x36, 0x41, 0x40
+    };
+    unsigned char zero[PRIVKEY_SIZE] = {0};
+    unsigned char pubkeys[2 * PUBKEY_COMPRESSION_SIZE];
+
+    TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_derive_pubkey_range(last, 1, pubkeys, 1));
+    check_range(last, pubkeys, 1, 1);
+
+    // Ranges may not wrap past the group order
+    last[PRIVKEY_SIZE - 1] = 0x3F;
+    TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_derive_pubkey_range(last, 2, pubkeys, 1));
+    TEST_ASSERT_EQUAL_INT(-1, secp256k1_wrapper_derive_pubkey_range(last, 3, pubkeys, 1));
+
+    TEST_ASSERT_EQUAL_INT(-5, secp256k1_wrapper_derive_pubkey_range(zero, 2, pubkeys, 1));
+    TEST_ASSERT_EQUAL_INT(-1, secp256k1_wrapper_derive_pubkey_range(NULL, 2, pubkeys, 1));
+    TEST_ASSERT_EQUAL_INT(-1, secp256k1_wrapper_derive_pubkey_range(last, 2, NULL, 1));
+    TEST_ASSERT_EQUAL_INT(-1, secp256k1_wrapper_derive_pubkey_range(last, 2, pubkeys, 2));
+    TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_derive_pubkey_range(last, 0, pubkeys, 1));
+}
+
+/* ========== Signing Tests ========== */
+
+#define SIGN_BATCH_SIZE 100
+
+/* Checks a signature against a compressed public key with libsecp256k1 */
+static int verify_sig(const unsigned char* pubkey33, const unsigned char* hash32, const unsigned char* sig,
+                      size_t sig_len, int format) {
+    secp256k1_context* ctx = secp256k1_context_create(SECP256K1_CONTEXT_NONE);
+    secp256k1_pubkey pubkey;
+    secp256k1_ecdsa_signature parsed;
+    int ok = secp256k1_ec_pubkey_parse(ctx, &pubkey, pubkey33, PUBKEY_COMPRESSION_SIZE);
+    if (format == SECP256K1_WRAPPER_SIG_COMPACT) {
+        ok = ok && sig_len == SECP256K1_WRAPPER_SIG_COMPACT_SIZE &&
+             secp256k1_ecdsa_signature_parse_compact(ctx, &parsed, sig);
+    } else {
+        ok = ok && secp256k1_ecdsa_signature_parse_der(ctx, &parsed, sig, sig_len);
+    }
+    ok = ok && secp256k1_ecdsa_verify(ctx, &parsed, hash32, &pubkey);
+    secp256k1_context_destroy(ctx);
+    return ok;
+}
+
+void test_sign(void) {
+    unsigned char privkey[PRIVKEY_SIZE];
+    unsigned char pubkey[PUBKEY_COMPRESSION_SIZE];
+    unsigned char hash[32];
+    unsigned char sig[SECP256K1_WRAPPER_SIG_DER_MAX_SIZE];
+    size_t sig_len;
+
+    TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_generate_keys(privkey, pubkey, 1));
+    TEST_ASSERT_EQUAL_INT(1, secp256k1_wrapper_fill_random(hash, sizeof(hash)));
+
+    sig_len = sizeof(sig);
+    TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_sign(privkey, hash, sig, &sig_len, SECP256K1_WRAPPER_SIG_COMPACT));
+    TEST_ASSERT_EQUAL_INT(SECP256K1_WRAPPER_SIG_COMPACT_SIZE, (int)sig_len);
+    TEST_ASSERT_EQUAL_INT(1, verify_sig(pubkey, hash, sig, sig_len, SECP256K1_WRAPPER_SIG_COMPACT));
+
+    sig_len = sizeof(sig);
+    TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_sign(privkey, hash, sig, &sig_len, SECP256K1_WRAPPER_SIG_DER));
+    TEST_ASSERT_TRUE(sig_len <= SECP256K1_WRAPPER_SIG_DER_MAX_SIZE);
+    TEST_ASSERT_EQUAL_INT(1, verify_sig(pubkey, hash, sig, sig_len, SECP256K1_WRAPPER_SIG_DER));
+
+    // Persistent handle
+    secp256k1_wrapper_ctx* ctx = secp256k1_wrapper_ctx_create();
+    TEST_ASSERT_NOT_NULL(ctx);
+    sig_len = SECP256K1_WRAPPER_SIG_COMPACT_SIZE;
+    TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_sign_ctx(ctx, privkey, hash, sig, &sig_len, SECP256K1_WRAPPER_SIG_COMPACT));
+    TEST_ASSERT_EQUAL_INT(1, verify_sig(pubkey, hash, sig, sig_len, SECP256K1_WRAPPER_SIG_COMPACT));
+    hash[0] ^= 1;
+    TEST_ASSERT_EQUAL_INT(0, verify_sig(pubkey, hash, sig, sig_len, SECP256K1_WRAPPER_SIG_COMPACT));
+    TEST_ASSERT_EQUAL_INT(-1, secp256k1_wrapper_sign_ctx(NULL, privkey, hash, sig, &sig_len, SECP256K1_WRAPPER_SIG_COMPACT));
+    secp256k1_wrapper_ctx_destroy(ctx);
+
+    secure_memzero(privkey, sizeof(privkey));
+}
+
+void test_sign_invalid_input(void) {
+    unsigned char privkey[PRIVKEY_SIZE];
+    unsigned char pubkey[PUBKEY_COMPRESSION_SIZE];
+    unsigned char zero[PRIVKEY_SIZE] = {0};
+    unsigned char hash[32] = {1};
+    unsigned char sig[SECP256K1_WRAPPER_SIG_DER_MAX_SIZE];
+    size_t sig_len = sizeof(sig);
+
+    TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_generate_keys(privkey, pubkey, 1));
+    TEST_ASSERT_EQUAL_INT(-5, secp256k1_wrapper_sign(zero, hash, sig, &sig_len, SECP256K1_WRAPPER_SIG_COMPACT));
+    TEST_ASSERT_EQUAL_INT(-1, secp256k1_wrapper_sign(NULL, hash, sig, &sig_len, SECP256K1_WRAPPER_SIG_COMPACT));
+    TEST_ASSERT_EQUAL_INT(-1, secp256k1_wrapper_sign(privkey, NULL, sig, &sig_len, SECP256K1_WRAPPER_SIG_COMPACT));
+    TEST_ASSERT_EQUAL_INT(-1, secp256k1_wrapper_sign(privkey, hash, NULL, &sig_len, SECP256K1_WRAPPER_SIG_COMPACT));
+    TEST_ASSERT_EQUAL_INT(-1, secp256k1_wrapper_sign(privkey, hash, sig, NULL, SECP256K1_WRAPPER_SIG_COMPACT));
+    TEST_ASSERT_EQUAL_INT(-1, secp256k1_wrapper_sign(privkey, hash, sig, &sig_len, 2));
+
+    // The buffer must fit the largest signature of the format
+    sig_len = SECP256K1_WRAPPER_SIG_COMPACT_SIZE - 1;
+    TEST_ASSERT_EQUAL_INT(-1, secp256k1_wrapper_sign(privkey, hash, sig, &sig_len, SECP256K1_WRAPPER_SIG_COMPACT));
+    sig_len = SECP256K1_WRAPPER_SIG_DER_MAX_SIZE - 1;
+    TEST_ASSERT_EQUAL_INT(-1, secp256k1_wrapper_sign(privkey, hash, sig, &sig_len, SECP256K1_WRAPPER_SIG_DER));
+
+    secure_memzero(privkey, sizeof(privkey));
+}
+
+void test_sign_batch(void) {
+    static unsigned char privkeys[SIGN_BATCH_SIZE * PRIVKEY_SIZE];
+    static unsigned char pubkeys[SIGN_BATCH_SIZE * PUBKEY_COMPRESSION_SIZE];
+    static unsigned char hashes[SIGN_BATCH_SIZE * 32];
+    static unsigned char sigs[SIGN_BATCH_SIZE * SECP256K1_WRAPPER_SIG_DER_MAX_SIZE];
+    size_t sig_lens[SIGN_BATCH_SIZE];
+    int results[SIGN_BATCH_SIZE];
+
+    TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_generate_keys_batch(privkeys, pubkeys, SIGN_BATCH_SIZE, 1,
+                                                                   SECP256K1_WRAPPER_BATCH_ALL_OR_NOTHING, NULL));
+    TEST_ASSERT_EQUAL_INT(1, secp256k1_wrapper_fill_random(hashes, sizeof(hashes)));
+
+    TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_sign_batch(privkeys, hashes, SIGN_BATCH_SIZE, sigs, NULL,
+                                                          SECP256K1_WRAPPER_SIG_COMPACT, results));
+    for (int i = 0; i < SIGN_BATCH_SIZE; i++) {
+        TEST_ASSERT_EQUAL_INT(0, results[i]);
+        TEST_ASSERT_EQUAL_INT(1, verify_sig(pubkeys + i * PUBKEY_COMPRESSION_SIZE, hashes + i * 32,
+                                            sigs + i * SECP256K1_WRAPPER_SIG_COMPACT_SIZE,
+                                            SECP256K1_WRAPPER_SIG_COMPACT_SIZE, SECP256K1_WRAPPER_SIG_COMPACT));
+    }
+
+    // DER in parallel, with one bad key in the middle
+    memset(privkeys + 5 * PRIVKEY_SIZE, 0, PRIVKEY_SIZE);
+    TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_set_parallel(4, 16));
+    TEST_ASSERT_EQUAL_INT(-5, secp256k1_wrapper_sign_batch(privkeys, hashes, SIGN_BATCH_SIZE, sigs, sig_lens,
+                                                           SECP256K1_WRAPPER_SIG_DER, results));
+    TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_set_parallel(0, 0));
+    for (int i = 0; i < SIGN_BATCH_SIZE; i++) {
+        const unsigned char* sig = sigs + i * SECP256K1_WRAPPER_SIG_DER_MAX_SIZE;
+        if (i == 5) {
+            TEST_ASSERT_EQUAL_INT(-5, results[i]);
+            TEST_ASSERT_EQUAL_INT(0, (int)sig_lens[i]);
+            TEST_ASSERT_EQUAL_INT(1, is_all_zeros(sig, SECP256K1_WRAPPER_SIG_DER_MAX_SIZE));
+            continue;
+        }
+        TEST_ASSERT_EQUAL_INT(0, results[i]);
+        TEST_ASSERT_EQUAL_INT(1, verify_sig(pubkeys + i * PUBKEY_COMPRESSION_SIZE, hashes + i * 32, sig,
+                                            sig_lens[i], SECP256K1_WRAPPER_SIG_DER));
+    }
+
+    TEST_ASSERT_EQUAL_INT(-1, secp256k1_wrapper_sign_batch(privkeys, hashes, 2, sigs, NULL,
+                                                           SECP256K1_WRAPPER_SIG_DER, results));
+    TEST_ASSERT_EQUAL_INT(-1, secp256k1_wrapper_sign_batch(privkeys, hashes, 2, sigs, NULL,
+                                                           SECP256K1_WRAPPER_SIG_COMPACT, NULL));
+    TEST_ASSERT_EQUAL_INT(-1, secp256k1_wrapper_sign_batch(NULL, hashes, 2, sigs, NULL,
+                                                           SECP256K1_WRAPPER_SIG_COMPACT, results));
+    TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_sign_batch(privkeys, hashes, 0, sigs, NULL,
+                                                          SECP256K1_WRAPPER_SIG_COMPACT, results));
+    secure_memzero(privkeys, sizeof(privkeys));
+}
+
+/* ========== Verification Tests ========== */
+
+#define VERIFY_BATCH_SIZE 203  // not a multiple of 8
+
+void test_verify(void) {
+    unsigned char privkey[PRIVKEY_SIZE];
+    unsigned char pubkey[PUBKEY_UNCOMPRESSION_SIZE];
+    unsigned char hash[32];
+    unsigned char sig[SECP256K1_WRAPPER_SIG_DER_MAX_SIZE];
+    unsigned char bad_pubkey[PUBKEY_COMPRESSION_SIZE] = {0x02};
+    size_t sig_len = sizeof(sig);
+
+    TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_generate_keys(privkey, pubkey, 0));
+    TEST_ASSERT_EQUAL_INT(1, secp256k1_wrapper_fill_random(hash, sizeof(hash)));
+
+    TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_sign(privkey, hash, sig, &sig_len, SECP256K1_WRAPPER_SIG_DER));
+    TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_verify(pubkey, PUBKEY_UNCOMPRESSION_SIZE, hash, sig, sig_len,
+                                                      SECP256K1_WRAPPER_SIG_DER));
+    hash[31] ^= 1;
+    TEST_ASSERT_EQUAL_INT(-4, secp256k1_wrapper_verify(pubkey, PUBKEY_UNCOMPRESSION_SIZE, hash, sig, sig_len,
+                                                       SECP256K1_WRAPPER_SIG_DER));
+    hash[31] ^= 1;
+    TEST_ASSERT_EQUAL_INT(-4, secp256k1_wrapper_verify(pubkey, PUBKEY_UNCOMPRESSION_SIZE, hash, sig, sig_len - 1,
+                                                       SECP256K1_WRAPPER_SIG_DER));
+    TEST_ASSERT_EQUAL_INT(-5, secp256k1_wrapper_verify(bad_pubkey, sizeof(bad_pubkey), hash, sig, sig_len,
+                                                       SECP256K1_WRAPPER_SIG_DER));
+
+    sig_len = SECP256K1_WRAPPER_SIG_COMPACT_SIZE;
+    TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_sign(privkey, hash, sig, &sig_len, SECP256K1_WRAPPER_SIG_COMPACT));
+    TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_verify(pubkey, PUBKEY_UNCOMPRESSION_SIZE, hash, sig, sig_len,
+                                                      SECP256K1_WRAPPER_SIG_COMPACT));
+    TEST_ASSERT_EQUAL_INT(-4, secp256k1_wrapper_verify(pubkey, PUBKEY_UNCOMPRESSION_SIZE, hash, sig, 63,
+                                                       SECP256K1_WRAPPER_SIG_COMPACT));
+
+    TEST_ASSERT_EQUAL_INT(-1, secp256k1_wrapper_verify(NULL, 33, hash, sig, sig_len, SECP256K1_WRAPPER_SIG_COMPACT));
+    TEST_ASSERT_EQUAL_INT(-1, secp256k1_wrapper_verify(pubkey, 65, NULL, sig, sig_len, SECP256K1_WRAPPER_SIG_COMPACT));
+    TEST_ASSERT_EQUAL_INT(-1, secp256k1_wrapper_verify(pubkey, 65, hash, NULL, sig_len, SECP256K1_WRAPPER_SIG_COMPACT));
+    TEST_ASSERT_EQUAL_INT(-1, secp256k1_wrapper_verify(pubkey, 65, hash, sig, sig_len, 2));
+    secure_memzero(privkey, sizeof(privkey));
+}
+
+static int bitmap_bit(const unsigned char* bitmap, size_t i) {
+    return (bitmap[i / 8] >> (i % 8)) & 1;
+}
+
+void test_verify_batch(void) {
+    static unsigned char privkeys[VERIFY_BATCH_SIZE * PRIVKEY_SIZE];
+    static unsigned char pubkeys[VERIFY_BATCH_SIZE * PUBKEY_COMPRESSION_SIZE];
+    static unsigned char hashes[VERIFY_BATCH_SIZE * 32];
+    static unsigned char sigs[VERIFY_BATCH_SIZE * SECP256K1_WRAPPER_SIG_DER_MAX_SIZE];
+    static secp256k1_wrapper_verify_item items[VERIFY_BATCH_SIZE];
+    size_t sig_lens[VERIFY_BATCH_SIZE];
+    int results[VERIFY_BATCH_SIZE];
+    unsigned char valid[(VERIFY_BATCH_SIZE + 7) / 8];
+
+    TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_generate_keys_batch(privkeys, pubkeys, VERIFY_BATCH_SIZE, 1,
+                                                                   SECP256K1_WRAPPER_BATCH_ALL_OR_NOTHING, NULL));
+    TEST_ASSERT_EQUAL_INT(1, secp256k1_wrapper_fill_random(hashes, sizeof(hashes)));
+    TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_sign_batch(privkeys, hashes, VERIFY_BATCH_SIZE, sigs, sig_lens,
+                                                          SECP256K1_WRAPPER_SIG_DER, results));
+    for (int i = 0; i < VERIFY_BATCH_SIZE; i++) {
+        items[i].pubkey = pubkeys + i * PUBKEY_COMPRESSION_SIZE;
+        items[i].pubkey_len = PUBKEY_COMPRESSION_SIZE;
+        items[i].hash32 = hashes + i * 32;
+        items[i].sig = sigs + i * SECP256K1_WRAPPER_SIG_DER_MAX_SIZE;
+        items[i].sig_len = sig_lens[i];
+    }
+
+    TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_verify_batch(items, VERIFY_BATCH_SIZE, SECP256K1_WRAPPER_SIG_DER,
+                                                            SECP256K1_WRAPPER_VERIFY_EARLY_EXIT, NULL));
+
+    // Two bad items, on different bitmap bytes
+    hashes[3 * 32] ^= 1;
+    items[150].sig = NULL;
+    for (int parallel = 0; parallel <= 1; parallel++) {
+        TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_set_parallel(parallel ? 4 : 0, 16));
+        memset(valid, 0xFF, sizeof(valid));
+        TEST_ASSERT_EQUAL_INT(-4, secp256k1_wrapper_verify_batch(items, VERIFY_BATCH_SIZE, SECP256K1_WRAPPER_SIG_DER,
+                                                                 SECP256K1_WRAPPER_VERIFY_ALL, valid));
+        for (int i = 0; i < VERIFY_BATCH_SIZE; i++) {
+            TEST_ASSERT_EQUAL_INT(i != 3 && i != 150, bitmap_bit(valid, (size_t)i));
+        }
+        TEST_ASSERT_EQUAL_INT(0, valid[sizeof(valid) - 1] >> (VERIFY_BATCH_SIZE % 8));  // padding bits clear
+
+        // Early exit: confirmed items only, never a bad one
+        TEST_ASSERT_EQUAL_INT(-4, secp256k1_wrapper_verify_batch(items, VERIFY_BATCH_SIZE, SECP256K1_WRAPPER_SIG_DER,
+                                                                 SECP256K1_WRAPPER_VERIFY_EARLY_EXIT, valid));
+        TEST_ASSERT_EQUAL_INT(0, bitmap_bit(valid, 3));
+        TEST_ASSERT_EQUAL_INT(0, bitmap_bit(valid, 150));
+    }
+    TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_set_parallel(0, 0));
+
+    TEST_ASSERT_EQUAL_INT(-1, secp256k1_wrapper_verify_batch(NULL, 2, SECP256K1_WRAPPER_SIG_DER,
+                                                             SECP256K1_WRAPPER_VERIFY_ALL, valid));
+    TEST_ASSERT_EQUAL_INT(-1, secp256k1_wrapper_verify_batch(items, 2, SECP256K1_WRAPPER_SIG_DER,
+                                                             SECP256K1_WRAPPER_VERIFY_ALL, NULL));
+    TEST_ASSERT_EQUAL_INT(-1, secp256k1_wrapper_verify_batch(items, 2, 5, SECP256K1_WRAPPER_VERIFY_ALL, valid));
+    TEST_ASSERT_EQUAL_INT(-1, secp256k1_wrapper_verify_batch(items, 2, SECP256K1_WRAPPER_SIG_DER, 5, valid));
+    TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_verify_batch(items, 0, SECP256K1_WRAPPER_SIG_DER,
+                                                            SECP256K1_WRAPPER_VERIFY_ALL, valid));
+    secure_memzero(privkeys, sizeof(privkeys));
+}
+
+/* ========== Signature Cache Tests ========== */
+
+#define SIGCACHE_ITEMS 200
+
+/* Compact signatures by fresh keys, and the verify items pointing at them */
+typedef struct sigcache_fixture {
+    unsigned char privkeys[SIGCACHE_ITEMS * PRIVKEY_SIZE];
+    unsigned char pubkeys[SIGCACHE_ITEMS * PUBKEY_COMPRESSION_SIZE];
+    unsigned char hashes[SIGCACHE_ITEMS * 32];
+    unsigned char sigs[SIGCACHE_ITEMS * SECP256K1_WRAPPER_SIG_COMPACT_SIZE];
+    secp256k1_wrapper_verify_item items[SIGCACHE_ITEMS];
+} sigcache_fixture;
+
+static void init_sigcache_fixture(sigcache_fixture* f) {
+    int results[SIGCACHE_ITEMS];
+    TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_generate_keys_batch(f->privkeys, f->pubkeys, SIGCACHE_ITEMS, 1,
+                                                                   SECP256K1_WRAPPER_BATCH_ALL_OR_NOTHING, NULL));
+    TEST_ASSERT_EQUAL_INT(1, secp256k1_wrapper_fill_random(f->hashes, sizeof(f->hashes)));
+    TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_sign_batch(f->privkeys, f->hashes, SIGCACHE_ITEMS, f->sigs, NULL,
+                                                          SECP256K1_WRAPPER_SIG_COMPACT, results));
+    for (int i = 0; i < SIGCACHE_ITEMS; i++) {
+        f->items[i].pubkey = f->pubkeys + i * PUBKEY_COMPRESSION_SIZE;
+        f->items[i].pubkey_len = PUBKEY_COMPRESSION_SIZE;
+        f->items[i].hash32 = f->hashes + i * 32;
+        f->items[i].sig = f->sigs + i * SECP256K1_WRAPPER_SIG_COMPACT_SIZE;
+        f->items[i].sig_len = SECP256K1_WRAPPER_SIG_COMPACT_SIZE;
+    }
+    secure_memzero(f->privkeys, sizeof(f->privkeys));
+}
+
+void test_sigcache_hits(void) {
+    static sigcache_fixture f;
+    secp256k1_wrapper_sigcache_stats stats;
+    unsigned char valid[(SIGCACHE_ITEMS + 7) / 8];
+
+    init_sigcache_fixture(&f);
+    TEST_ASSERT_EQUAL_INT(-1, secp256k1_wrapper_sigcache_init(16));
+    TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_sigcache_init(1 << 20));
+    TEST_ASSERT_EQUAL_INT(-1, secp256k1_wrapper_sigcache_init(1 << 20));  // already enabled
+
+    const secp256k1_wrapper_verify_item* it = &f.items[0];
+    TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_verify(it->pubkey, it->pubkey_len, it->hash32, it->sig, it->sig_len,
+                                                      SECP256K1_WRAPPER_SIG_COMPACT));
+    TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_verify(it->pubkey, it->pubkey_len, it->hash32, it->sig, it->sig_len,
+                                                      SECP256K1_WRAPPER_SIG_COMPACT));
+    secp256k1_wrapper_get_sigcache_stats(&stats);
+    TEST_ASSERT_TRUE(stats.capacity > 0);
+    TEST_ASSERT_EQUAL_UINT64(1, stats.hits);
+    TEST_ASSERT_EQUAL_UINT64(1, stats.misses);
+    TEST_ASSERT_EQUAL_UINT64(1, stats.inserts);
+
+    // The same bytes as a DER signature are a different triple; invalid ones are never cached
+    TEST_ASSERT_EQUAL_INT(-4, secp256k1_wrapper_verify(it->pubkey, it->pubkey_len, it->hash32, it->sig, it->sig_len,
+                                                       SECP256K1_WRAPPER_SIG_DER));
+    TEST_ASSERT_EQUAL_INT(-4, secp256k1_wrapper_verify(it->pubkey, it->pubkey_len, it->hash32, it->sig, it->sig_len,
+                                                       SECP256K1_WRAPPER_SIG_DER));
+    secp256k1_wrapper_get_sigcache_stats(&stats);
+    TEST_ASSERT_EQUAL_UINT64(1, stats.hits);
+    TEST_ASSERT_EQUAL_UINT64(1, stats.inserts);
+
+    // A batch twice, in parallel: the second run is all hits
+    TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_set_parallel(4, 16));
+    for (int round = 0; round < 2; round++) {
+        TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_verify_batch(f.items, SIGCACHE_ITEMS, SECP256K1_WRAPPER_SIG_COMPACT,
+                                                                SECP256K1_WRAPPER_VERIFY_ALL, valid));
+    }
+    TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_set_parallel(0, 0));
+    secp256k1_wrapper_get_sigcache_stats(&stats);
+    TEST_ASSERT_EQUAL_UINT64(1 + 1 + SIGCACHE_ITEMS, stats.hits);
+    TEST_ASSERT_EQUAL_UINT64(SIGCACHE_ITEMS, stats.inserts);
+
+    // A tampered hash still fails with the original cached
+    f.hashes[5 * 32] ^= 1;
+    TEST_ASSERT_EQUAL_INT(-4, secp256k1_wrapper_verify_batch(f.items, SIGCACHE_ITEMS, SECP256K1_WRAPPER_SIG_COMPACT,
+                                                             SECP256K1_WRAPPER_VERIFY_ALL, valid));
+    TEST_ASSERT_EQUAL_INT(0, (valid[0] >> 5) & 1);
+
+    secp256k1_wrapper_sigcache_shutdown();
+    secp256k1_wrapper_get_sigcache_stats(&stats);
+    TEST_ASSERT_EQUAL_UINT64(0, stats.capacity);
+}
+
+void test_sigcache_full(void) {
+    static sigcache_fixture f;
+    secp256k1_wrapper_sigcache_stats stats;
+    unsigned char valid[(SIGCACHE_ITEMS + 7) / 8];
+
+    // A cache far smaller than the working set: entries age out and get displaced
+    init_sigcache_fixture(&f);
+    TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_sigcache_init(2048));
+    for (int round = 0; round < 3; round++) {
+        TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_verify_batch(f.items, SIGCACHE_ITEMS, SECP256K1_WRAPPER_SIG_COMPACT,
+                                                                SECP256K1_WRAPPER_VERIFY_ALL, valid));
+        for (int i = 0; i < SIGCACHE_ITEMS; i++) {
+            TEST_ASSERT_TRUE(bitmap_bit(valid, i));
+        }
+    }
+    secp256k1_wrapper_get_sigcache_stats(&stats);
+    TEST_ASSERT_TRUE(stats.capacity > 0 && stats.capacity < SIGCACHE_ITEMS);
+    TEST_ASSERT_EQUAL_UINT64(3 * SIGCACHE_ITEMS, stats.hits + stats.misses);
+    TEST_ASSERT_EQUAL_UINT64(stats.misses, stats.inserts);
+    TEST_ASSERT_TRUE(stats.generation > 1);
+    secp256k1_wrapper_sigcache_shutdown();
+}
+
+/* ========== Public Key Handle Tests ========== */
+
+void test_pubkey_handles(void) {
+    static sigcache_fixture f;
+    secp256k1_wrapper_pubkey* key = NULL;
+    unsigned char bad[PUBKEY_COMPRESSION_SIZE] = { 0x05 };
+
+    init_sigcache_fixture(&f);
+    TEST_ASSERT_EQUAL_INT(-1, secp256k1_wrapper_pubkey_parse(f.pubkeys, PUBKEY_COMPRESSION_SIZE, NULL));
+    TEST_ASSERT_EQUAL_INT(-1, secp256k1_wrapper_pubkey_parse(NULL, PUBKEY_COMPRESSION_SIZE, &key));
+    TEST_ASSERT_EQUAL_INT(-1, secp256k1_wrapper_pubkey_parse(f.pubkeys, 32, &key));
+    TEST_ASSERT_NULL(key);
+    TEST_ASSERT_EQUAL_INT(-5, secp256k1_wrapper_pubkey_parse(bad, sizeof(bad), &key));
+    TEST_ASSERT_NULL(key);
+
+    TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_pubkey_parse(f.pubkeys, PUBKEY_COMPRESSION_SIZE, &key));
+    TEST_ASSERT_NOT_NULL(key);
+    TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_verify_pubkey(key, f.hashes, f.sigs, SECP256K1_WRAPPER_SIG_COMPACT_SIZE,
+                                                             SECP256K1_WRAPPER_SIG_COMPACT));
+    TEST_ASSERT_EQUAL_INT(-4, secp256k1_wrapper_verify_pubkey(key, f.hashes + 32, f.sigs,
+                                                              SECP256K1_WRAPPER_SIG_COMPACT_SIZE,
+                                                              SECP256K1_WRAPPER_SIG_COMPACT));
+    TEST_ASSERT_EQUAL_INT(-1, secp256k1_wrapper_verify_pubkey(NULL, f.hashes, f.sigs,
+                                                              SECP256K1_WRAPPER_SIG_COMPACT_SIZE,
+                                                              SECP256K1_WRAPPER_SIG_COMPACT));
+    TEST_ASSERT_EQUAL_INT(-1, secp256k1_wrapper_verify_pubkey(key, f.hashes, f.sigs,
+                                                              SECP256K1_WRAPPER_SIG_COMPACT_SIZE, 7));
+    secp256k1_wrapper_pubkey_release(key);
+    secp256k1_wrapper_pubkey_release(NULL);
+}
+
+void test_pubkey_cache(void) {
+    static sigcache_fixture f;
+    secp256k1_wrapper_pubkey_cache_stats stats;
+    secp256k1_wrapper_pubkey* first = NULL;
+    secp256k1_wrapper_pubkey* again = NULL;
+    unsigned char valid[(SIGCACHE_ITEMS + 7) / 8];
+
+    init_sigcache_fixture(&f);
+    TEST_ASSERT_EQUAL_INT(-1, secp256k1_wrapper_pubkey_cache_init(0));
+    TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_pubkey_cache_init(4));
+    TEST_ASSERT_EQUAL_INT(-1, secp256k1_wrapper_pubkey_cache_init(4));  // already enabled
+
+    // A key parsed twice is handed out once
+    TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_pubkey_parse(f.pubkeys, PUBKEY_COMPRESSION_SIZE, &first));
+    TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_pubkey_parse(f.pubkeys, PUBKEY_COMPRESSION_SIZE, &again));
+    TEST_ASSERT_TRUE(first == again);
+    secp256k1_wrapper_pubkey_release(again);
+    const secp256k1_wrapper_verify_item* it = &f.items[0];
+    TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_verify(it->pubkey, it->pubkey_len, it->hash32, it->sig, it->sig_len,
+                                                      SECP256K1_WRAPPER_SIG_COMPACT));
+    secp256k1_wrapper_get_pubkey_cache_stats(&stats);
+    TEST_ASSERT_EQUAL_UINT64(4, stats.capacity);
+    TEST_ASSERT_EQUAL_UINT64(1, stats.size);
+    TEST_ASSERT_EQUAL_UINT64(2, stats.hits);
+    TEST_ASSERT_EQUAL_UINT64(1, stats.misses);
+
+    // Unparsable keys are not cached
+    unsigned char bad[PUBKEY_COMPRESSION_SIZE] = { 0x05 };
+    TEST_ASSERT_EQUAL_INT(-5, secp256k1_wrapper_verify(bad, sizeof(bad), it->hash32, it->sig, it->sig_len,
+                                                       SECP256K1_WRAPPER_SIG_COMPACT));
+    secp256k1_wrapper_get_pubkey_cache_stats(&stats);
+    TEST_ASSERT_EQUAL_UINT64(1, stats.size);
+
+    // A batch through a cache far smaller than its key set, in parallel
+    TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_set_parallel(4, 16));
+    TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_verify_batch(f.items, SIGCACHE_ITEMS, SECP256K1_WRAPPER_SIG_COMPACT,
+                                                            SECP256K1_WRAPPER_VERIFY_ALL, valid));
+    TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_set_parallel(0, 0));
+    secp256k1_wrapper_get_pubkey_cache_stats(&stats);
+    TEST_ASSERT_EQUAL_UINT64(4, stats.size);
+    TEST_ASSERT_TRUE(stats.evictions >= SIGCACHE_ITEMS - 4);
+
+    // Evicted and shut-down handles stay valid until released
+    TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_pubkey_parse(f.pubkeys + PUBKEY_COMPRESSION_SIZE,
+                                                            PUBKEY_COMPRESSION_SIZE, &again));
+    secp256k1_wrapper_pubkey_cache_shutdown();
+    secp256k1_wrapper_get_pubkey_cache_stats(&stats);
+    TEST_ASSERT_EQUAL_UINT64(0, stats.capacity);
+    TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_verify_pubkey(first, f.hashes, f.sigs,
+                                                             SECP256K1_WRAPPER_SIG_COMPACT_SIZE,
+                                                             SECP256K1_WRAPPER_SIG_COMPACT));
+    TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_verify_pubkey(again, f.hashes + 32,
+                                                             f.sigs + SECP256K1_WRAPPER_SIG_COMPACT_SIZE,
+                                                             SECP256K1_WRAPPER_SIG_COMPACT_SIZE,
+                                                             SECP256K1_WRAPPER_SIG_COMPACT));
+    secp256k1_wrapper_pubkey_release(first);
+    secp256k1_wrapper_pubkey_release(again);
+
+    // Every worker hitting the cache at once: no lookup lost or double counted
+    TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_pubkey_cache_init(4096));
+    TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_set_parallel(4, 4));
+    for (int round = 0; round < 20; round++) {
+        TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_verify_batch(f.items, SIGCACHE_ITEMS,
+                                                                SECP256K1_WRAPPER_SIG_COMPACT,
+                                                                SECP256K1_WRAPPER_VERIFY_ALL, valid));
+    }
+    TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_set_parallel(0, 0));
+    secp256k1_wrapper_get_pubkey_cache_stats(&stats);
+    TEST_ASSERT_EQUAL_UINT64(SIGCACHE_ITEMS, stats.size);
+    TEST_ASSERT_EQUAL_UINT64(SIGCACHE_ITEMS, stats.misses);
+    TEST_ASSERT_EQUAL_UINT64(19 * SIGCACHE_ITEMS, stats.hits);
+    TEST_ASSERT_EQUAL_UINT64(0, stats.evictions);
+    secp256k1_wrapper_pubkey_cache_shutdown();
+}
+
+/* ========== Schnorr Signature Tests ========== */
+
+#define SCHNORR_BATCH_SIZE 200
+#define SCHNORR_KEYS 3
+
+void test_schnorr_keypair(void) {
+    unsigned char privkey[PRIVKEY_SIZE];
+    unsigned char zero[PRIVKEY_SIZE] = { 0 };
+    unsigned char xonly[SECP256K1_WRAPPER_XONLY_PUBKEY_SIZE];
+    secp256k1_wrapper_keypair* keypair = NULL;
+    int parity = -1;
+
+    TEST_ASSERT_EQUAL_INT(1, secp256k1_wrapper_fill_random(privkey, sizeof(privkey)));
+    TEST_ASSERT_EQUAL_INT(-1, secp256k1_wrapper_keypair_create(privkey, NULL));
+    TEST_ASSERT_EQUAL_INT(-1, secp256k1_wrapper_keypair_create(NULL, &keypair));
+    TEST_ASSERT_NULL(keypair);
+    TEST_ASSERT_EQUAL_INT(-5, secp256k1_wrapper_keypair_create(zero, &keypair));
+    TEST_ASSERT_NULL(keypair);
+
+    TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_keypair_create(privkey, &keypair));
+    TEST_ASSERT_NOT_NULL(keypair);
+    TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_keypair_xonly_pubkey(keypair, xonly, &parity));
+    TEST_ASSERT_TRUE(parity == 0 || parity == 1);
+    TEST_ASSERT_EQUAL_INT(0, is_all_zeros(xonly, sizeof(xonly)));
+    TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_keypair_xonly_pubkey(keypair, xonly, NULL));
+    TEST_ASSERT_EQUAL_INT(-1, secp256k1_wrapper_keypair_xonly_pubkey(NULL, xonly, NULL));
+    TEST_ASSERT_EQUAL_INT(-1, secp256k1_wrapper_keypair_xonly_pubkey(keypair, NULL, NULL));
+
+    secp256k1_wrapper_keypair_destroy(keypair);
+    secp256k1_wrapper_keypair_destroy(NULL);
+    secure_memzero(privkey, sizeof(privkey));
+}
+
+void test_schnorr_sign(void) {
+    unsigned char privkey[PRIVKEY_SIZE];
+    unsigned char xonly[SECP256K1_WRAPPER_XONLY_PUBKEY_SIZE];
+    unsigned char zero[SECP256K1_WRAPPER_XONLY_PUBKEY_SIZE] = { 0 };
+    unsigned char msg[32];
+    unsigned char sig[SECP256K1_WRAPPER_SCHNORR_SIG_SIZE];
+    unsigned char sig2[SECP256K1_WRAPPER_SCHNORR_SIG_SIZE];
+    secp256k1_wrapper_keypair* keypair = NULL;
+
+    TEST_ASSERT_EQUAL_INT(1, secp256k1_wrapper_fill_random(privkey, sizeof(privkey)));
+    TEST_ASSERT_EQUAL_INT(1, secp256k1_wrapper_fill_random(msg, sizeof(msg)));
+    TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_keypair_create(privkey, &keypair));
+    TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_keypair_xonly_pubkey(keypair, xonly, NULL));
+
+    TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_schnorr_sign(keypair, msg, sig));
+    TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_schnorr_verify(xonly, msg, sig));
+
+    // Fresh auxiliary randomness: the same message signs differently
+    TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_schnorr_sign(keypair, msg, sig2));
+    TEST_ASSERT_TRUE(memcmp(sig, sig2, sizeof(sig)) != 0);
+    TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_schnorr_verify(xonly, msg, sig2));
+
+    secp256k1_wrapper_ctx* ctx = secp256k1_wrapper_ctx_create();
+    TEST_ASSERT_NOT_NULL(ctx);
+    TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_schnorr_sign_ctx(ctx, keypair, msg, sig2));
+    TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_schnorr_verify(xonly, msg, sig2));
+    TEST_ASSERT_EQUAL_INT(-1, secp256k1_wrapper_schnorr_sign_ctx(NULL, keypair, msg, sig2));
+    secp256k1_wrapper_ctx_destroy(ctx);
+
+    msg[0] ^= 1;
+    TEST_ASSERT_EQUAL_INT(-4, secp256k1_wrapper_schnorr_verify(xonly, msg, sig));
+    TEST_ASSERT_EQUAL_INT(-5, secp256k1_wrapper_schnorr_verify(zero, msg, sig));
+
+    TEST_ASSERT_EQUAL_INT(-1, secp256k1_wrapper_schnorr_sign(NULL, msg, sig));
+    TEST_ASSERT_EQUAL_INT(-1, secp256k1_wrapper_schnorr_sign(keypair, NULL, sig));
+    TEST_ASSERT_EQUAL_INT(-1, secp256k1_wrapper_schnorr_sign(keypair, msg, NULL));
+    TEST_ASSERT_EQUAL_INT(-1, secp256k1_wrapper_schnorr_verify(NULL, msg, sig));
+    TEST_ASSERT_EQUAL_INT(-1, secp256k1_wrapper_schnorr_verify(xonly, msg, NULL));
+
+    secp256k1_wrapper_keypair_destroy(keypair);
+    secure_memzero(privkey, sizeof(privkey));
+}
+
+void test_schnorr_batches(void) {
+    static unsigned char msgs[SCHNORR_BATCH_SIZE * 32];
+    static unsigned char sigs[SCHNORR_BATCH_SIZE * SECP256K1_WRAPPER_SCHNORR_SIG_SIZE];
+    static unsigned char xonly[SCHNORR_KEYS][SECP256K1_WRAPPER_XONLY_PUBKEY_SIZE];
+    static const secp256k1_wrapper_keypair* signers[SCHNORR_BATCH_SIZE];
+    static secp256k1_wrapper_schnorr_item items[SCHNORR_BATCH_SIZE];
+    secp256k1_wrapper_keypair* keypairs[SCHNORR_KEYS];
+    unsigned char privkey[PRIVKEY_SIZE];
+    unsigned char valid[(SCHNORR_BATCH_SIZE + 7) / 8];
+    int results[SCHNORR_BATCH_SIZE];
+
+    for (int k = 0; k < SCHNORR_KEYS; k++) {
+        TEST_ASSERT_EQUAL_INT(1, secp256k1_wrapper_fill_random(privkey, sizeof(privkey)));
+        TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_keypair_create(privkey, &keypairs[k]));
+        TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_keypair_xonly_pubkey(keypairs[k], xonly[k], NULL));
+    }
+    TEST_ASSERT_EQUAL_INT(1, secp256k1_wrapper_fill_random(msgs, sizeof(msgs)));
+    for (int i = 0; i < SCHNORR_BATCH_SIZE; i++) {
+        signers[i] = keypairs[i % SCHNORR_KEYS];
+        items[i].xonly_pubkey = xonly[i % SCHNORR_KEYS];
+        items[i].msg32 = msgs + i * 32;
+        items[i].sig64 = sigs + i * SECP256K1_WRAPPER_SCHNORR_SIG_SIZE;
+    }
+
+    for (int parallel = 0; parallel < 2; parallel++) {
+        TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_set_parallel(parallel ? 4 : 0, 16));
+        TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_schnorr_sign_batch(signers, msgs, SCHNORR_BATCH_SIZE, sigs,
+                                                                      results));
+        TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_schnorr_verify_batch(items, SCHNORR_BATCH_SIZE,
+                                                                        SECP256K1_WRAPPER_VERIFY_ALL, valid));
+        for (int i = 0; i < SCHNORR_BATCH_SIZE; i++) {
+            TEST_ASSERT_EQUAL_INT(0, results[i]);
+            TEST_ASSERT_EQUAL_INT(1, bitmap_bit(valid, (size_t)i));
+            TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_schnorr_verify(items[i].xonly_pubkey, items[i].msg32,
+                                                                      items[i].sig64));
+        }
+        TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_schnorr_verify_batch(items, SCHNORR_BATCH_SIZE,
+                                                                        SECP256K1_WRAPPER_VERIFY_EARLY_EXIT, NULL));
+    }
+
+    // A missing signer fails its item alone; a tampered message fails verification
+    signers[7] = NULL;
+    TEST_ASSERT_EQUAL_INT(-1, secp256k1_wrapper_schnorr_sign_batch(signers, msgs, SCHNORR_BATCH_SIZE, sigs, results));
+    TEST_ASSERT_EQUAL_INT(-1, results[7]);
+    TEST_ASSERT_EQUAL_INT(1, is_all_zeros(sigs + 7 * SECP256K1_WRAPPER_SCHNORR_SIG_SIZE,
+                                          SECP256K1_WRAPPER_SCHNORR_SIG_SIZE));
+    TEST_ASSERT_EQUAL_INT(0, results[8]);
+    msgs[150 * 32] ^= 1;
+    TEST_ASSERT_EQUAL_INT(-4, secp256k1_wrapper_schnorr_verify_batch(items, SCHNORR_BATCH_SIZE,
+                                                                     SECP256K1_WRAPPER_VERIFY_ALL, valid));
+    for (int i = 0; i < SCHNORR_BATCH_SIZE; i++) {
+        TEST_ASSERT_EQUAL_INT(i != 7 && i != 150, bitmap_bit(valid, (size_t)i));
+    }
+    TEST_ASSERT_EQUAL_INT(-4, secp256k1_wrapper_schnorr_verify_batch(items, SCHNORR_BATCH_SIZE,
+                                                                     SECP256K1_WRAPPER_VERIFY_EARLY_EXIT, NULL));
+    TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_set_parallel(0, 0));
+
+    TEST_ASSERT_EQUAL_INT(-1, secp256k1_wrapper_schnorr_sign_batch(NULL, msgs, 1, sigs, results));
+    TEST_ASSERT_EQUAL_INT(-1, secp256k1_wrapper_schnorr_sign_batch(signers, msgs, 1, sigs, NULL));
+    TEST_ASSERT_EQUAL_INT(-1, secp256k1_wrapper_schnorr_verify_batch(items, 1, SECP256K1_WRAPPER_VERIFY_ALL, NULL));
+    TEST_ASSERT_EQUAL_INT(-1, secp256k1_wrapper_schnorr_verify_batch(items, 1, 9, valid));
+    TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_schnorr_sign_batch(signers, msgs, 0, sigs, results));
+
+    for (int k = 0; k < SCHNORR_KEYS; k++) {
+        secp256k1_wrapper_keypair_destroy(keypairs[k]);
+    }
+    secure_memzero(privkey, sizeof(privkey));
+}
+
+/* ========== Parallel Batch Tests ========== */
+
+#define PARALLEL_BATCH_SIZE 300
+
+void test_parallel_batches_match_serial(void) {
+    static unsigned char privkeys[PARALLEL_BATCH_SIZE * PRIVKEY_SIZE];
+    static unsigned char pubkeys[PARALLEL_BATCH_SIZE * PUBKEY_UNCOMPRESSION_SIZE];
+    static unsigned char serial[PARALLEL_BATCH_SIZE * PUBKEY_UNCOMPRESSION_SIZE];
+    int results[PARALLEL_BATCH_SIZE];
+    int serial_results[PARALLEL_BATCH_SIZE];
+
+    TEST_ASSERT_EQUAL_INT(-1, secp256k1_wrapper_set_parallel(100000, 0));
+    TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_set_parallel(4, 16));  // 19 chunks, uneven tail
+
+    TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_generate_keys_batch(privkeys, pubkeys, PARALLEL_BATCH_SIZE, 1,
+                                                                   SECP256K1_WRAPPER_BATCH_ALL_OR_NOTHING, NULL));
+    check_generated_batch(privkeys, pubkeys, PARALLEL_BATCH_SIZE, 1);
+
+    TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_generate_keys_batch(privkeys, pubkeys, PARALLEL_BATCH_SIZE, 0,
+                                                                   SECP256K1_WRAPPER_BATCH_PER_ITEM, results));
+    check_generated_batch(privkeys, pubkeys, PARALLEL_BATCH_SIZE, 0);
+
+    // Bad keys in different chunks: same output and codes as a serial run
+    memset(privkeys + 5 * PRIVKEY_SIZE, 0, PRIVKEY_SIZE);
+    memset(privkeys + 170 * PRIVKEY_SIZE, 0xFF, PRIVKEY_SIZE);
+    TEST_ASSERT_EQUAL_INT(-5, secp256k1_wrapper_derive_pubkey_batch(privkeys, pubkeys, PARALLEL_BATCH_SIZE, 1, results));
+
+    TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_set_parallel(0, 0));
+    TEST_ASSERT_EQUAL_INT(-5, secp256k1_wrapper_derive_pubkey_batch(privkeys, serial, PARALLEL_BATCH_SIZE, 1, serial_results));
+    TEST_ASSERT_EQUAL_MEMORY(serial, pubkeys, PARALLEL_BATCH_SIZE * PUBKEY_COMPRESSION_SIZE);
+    TEST_ASSERT_EQUAL_INT_ARRAY(serial_results, results, PARALLEL_BATCH_SIZE);
+    TEST_ASSERT_EQUAL_INT(-5, results[5]);
+    TEST_ASSERT_EQUAL_INT(-5, results[170]);
+
+    secure_memzero(privkeys, sizeof(privkeys));
+}
+
+void test_parallel_stats(void) {
+    static unsigned char privkeys[PARALLEL_BATCH_SIZE * PRIVKEY_SIZE];
+    static unsigned char pubkeys[PARALLEL_BATCH_SIZE * PUBKEY_COMPRESSION_SIZE];
+    secp256k1_wrapper_parallel_stats stats;
+    secp256k1_wrapper_worker_stats workers[4];
+
+    // Serial mode reports nothing
+    TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_set_parallel(0, 0));
+    TEST_ASSERT_EQUAL_size_t(0, secp256k1_wrapper_get_parallel_stats(&stats, workers, 4));
+    TEST_ASSERT_EQUAL_size_t(0, stats.threads);
+
+    TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_set_parallel(3, 16));
+    for (int i = 0; i < 2; i++) {
+        TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_generate_keys_batch(privkeys, pubkeys, PARALLEL_BATCH_SIZE, 1,
+                                                                       SECP256K1_WRAPPER_BATCH_ALL_OR_NOTHING, NULL));
+    }
+
+    // Only 3 workers exist, the fourth entry is left alone
+    memset(workers, 0xAB, sizeof(workers));
+    TEST_ASSERT_EQUAL_size_t(3, secp256k1_wrapper_get_parallel_stats(&stats, workers, 4));
+    TEST_ASSERT_EQUAL_size_t(3, stats.threads);
+    TEST_ASSERT_EQUAL_UINT64(2, stats.jobs);
+    TEST_ASSERT_EQUAL_UINT64(2 * PARALLEL_BATCH_SIZE, stats.items);
+    TEST_ASSERT_TRUE(stats.tasks >= 2 * ((PARALLEL_BATCH_SIZE + 15) / 16));  // halving never exceeds a chunk
+
+    uint64_t tasks = 0, items = 0, steals = 0;
+    for (int i = 0; i < 3; i++) {
+        tasks += workers[i].tasks;
+        items += workers[i].items;
+        steals += workers[i].steals;
+    }
+    TEST_ASSERT_EQUAL_UINT64(stats.tasks, tasks);
+    TEST_ASSERT_EQUAL_UINT64(stats.items, items);
+    TEST_ASSERT_EQUAL_UINT64(stats.steals, steals);
+    TEST_ASSERT_EQUAL_HEX8(0xAB, ((unsigned char*)&workers[3])[0]);
+
+    // A new pool starts from zero
+    TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_set_parallel(2, 16));
+    secp256k1_wrapper_get_parallel_stats(&stats, NULL, 0);
+    TEST_ASSERT_EQUAL_UINT64(0, stats.jobs);
+    TEST_ASSERT_EQUAL_UINT64(0, stats.items);
+    TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_set_parallel(0, 0));
+
+    secure_memzero(privkeys, sizeof(privkeys));
+}
+
+#if !defined(_WIN32)
+typedef struct {
+    unsigned char privkeys[PARALLEL_BATCH_SIZE * PRIVKEY_SIZE];
+    unsigned char pubkeys[PARALLEL_BATCH_SIZE * PUBKEY_COMPRESSION_SIZE];
+    unsigned char derived[PARALLEL_BATCH_SIZE * PUBKEY_COMPRESSION_SIZE];
+    int results[PARALLEL_BATCH_SIZE];
+    int failures;
+} parallel_submitter;
+
+static void* parallel_submit_worker(void* arg) {
+    parallel_submitter* s = (parallel_submitter*)arg;
+
+    for (int i = 0; i < 5; i++) {
+        if (secp256k1_wrapper_generate_keys_batch(s->privkeys, s->pubkeys, PARALLEL_BATCH_SIZE, 1,
+                                                  SECP256K1_WRAPPER_BATCH_ALL_OR_NOTHING, NULL) != 0 ||
+            secp256k1_wrapper_derive_pubkey_batch(s->privkeys, s->derived, PARALLEL_BATCH_SIZE, 1, s->results) != 0 ||
+            memcmp(s->pubkeys, s->derived, sizeof(s->pubkeys)) != 0) {
+            s->failures++;
+        }
+    }
+    secure_memzero(s->privkeys, sizeof(s->privkeys));
+    return NULL;
+}
+#endif
+
+#define IDLE_CHUNK 10000
+
+#if !defined(_WIN32)
+static double seconds_on(clockid_t clock) {
+    struct timespec ts;
+    clock_gettime(clock, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+#endif
+
+/* Two long chunks on eight workers: the six without work must park rather
+ * than spin for as long as the chunks run */
+void test_parallel_idle_workers_park(void) {
+#if defined(_WIN32)
+    TEST_IGNORE_MESSAGE("POSIX clocks");
+#else
+    static unsigned char privkeys[2 * IDLE_CHUNK * PRIVKEY_SIZE];
+    static unsigned char pubkeys[2 * IDLE_CHUNK * PUBKEY_COMPRESSION_SIZE];
+    static int results[2 * IDLE_CHUNK];
+
+    TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_set_parallel(8, IDLE_CHUNK));
+    TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_generate_keys_batch(privkeys, pubkeys, 2 * IDLE_CHUNK, 1,
+                                                                   SECP256K1_WRAPPER_BATCH_ALL_OR_NOTHING, NULL));
+
+    double wall = seconds_on(CLOCK_MONOTONIC);
+    double cpu = seconds_on(CLOCK_PROCESS_CPUTIME_ID);
+    for (int round = 0; round < 10; round++) {
+        TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_derive_pubkey_batch(privkeys, pubkeys, 2 * IDLE_CHUNK, 1, results));
+    }
+    wall = seconds_on(CLOCK_MONOTONIC) - wall;
+    cpu = seconds_on(CLOCK_PROCESS_CPUTIME_ID) - cpu;
+    TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_set_parallel(0, 0));
+
+    // Two busy workers, plus slack for splitting, stealing and parking
+    TEST_ASSERT_TRUE(cpu < 3.0 * wall + 0.05);
+    secure_memzero(privkeys, sizeof(privkeys));
+#endif
+}
+
+/* Batches from several threads share the workers */
+void test_parallel_concurrent_batches(void) {
+#if defined(_WIN32)
+    TEST_IGNORE_MESSAGE("pthread-based test");
+#else
+    enum { NUM_THREADS = 4 };
+    pthread_t threads[NUM_THREADS];
+    parallel_submitter* submitters = (parallel_submitter*)calloc(NUM_THREADS, sizeof(parallel_submitter));
+    TEST_ASSERT_NOT_NULL(submitters);
+
+    TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_set_parallel(4, 8));
+    for (int i = 0; i < NUM_THREADS; i++) {
+        TEST_ASSERT_EQUAL_INT(0, pthread_create(&threads[i], NULL, parallel_submit_worker, &submitters[i]));
+    }
+    for (int i = 0; i < NUM_THREADS; i++) {
+        TEST_ASSERT_EQUAL_INT(0, pthread_join(threads[i], NULL));
+    }
+
+    secp256k1_wrapper_parallel_stats stats;
+    secp256k1_wrapper_get_parallel_stats(&stats, NULL, 0);
+    TEST_ASSERT_EQUAL_UINT64(NUM_THREADS * 5 * 2, stats.jobs);
+    TEST_ASSERT_EQUAL_UINT64(NUM_THREADS * 5 * 2 * PARALLEL_BATCH_SIZE, stats.items);
+    TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_set_parallel(0, 0));
+
+    for (int i = 0; i < NUM_THREADS; i++) {
+        TEST_ASSERT_EQUAL_INT(0, submitters[i].failures);
+    }
+    free(submitters);
+#endif
+}
+
+#if !defined(_WIN32)
+/* The workers are gone in the child, batches must still complete */
+static int child_runs_parallel_batch(void) {
+    static unsigned char privkeys[PARALLEL_BATCH_SIZE * PRIVKEY_SIZE];
+    static unsigned char pubkeys[PARALLEL_BATCH_SIZE * PUBKEY_COMPRESSION_SIZE];
+
+    if (secp256k1_wrapper_generate_keys_batch(privkeys, pubkeys, PARALLEL_BATCH_SIZE, 1,
+                                              SECP256K1_WRAPPER_BATCH_ALL_OR_NOTHING, NULL) != 0) return 1;
+    if (secp256k1_wrapper_set_parallel(2, 32) != 0) return 2;
+    if (secp256k1_wrapper_generate_keys_batch(privkeys, pubkeys, PARALLEL_BATCH_SIZE, 1,
+                                              SECP256K1_WRAPPER_BATCH_ALL_OR_NOTHING, NULL) != 0) return 3;
+    return secp256k1_wrapper_set_parallel(0, 0) == 0 ? 0 : 4;
+}
+#endif
+
+void test_parallel_batches_after_fork(void) {
+#if defined(_WIN32)
+    TEST_IGNORE_MESSAGE("fork() is not available");
+#else
+    TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_set_parallel(4, 16));
+    TEST_ASSERT_EQUAL_INT(0, run_in_child(child_runs_parallel_batch));
+    TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_set_parallel(0, 0));
+#endif
+}
+
+/* ========== Key Pool Tests ========== */
+
+#define KEYPOOL_CAPACITY 16
+
+/* Waits (bounded) for the refill thread to fill the ring back up */
+static int wait_for_keypool_full(void) {
+    secp256k1_wrapper_keypool_stats stats;
+    time_t deadline = time(NULL) + 10;
+    do {
+        secp256k1_wrapper_get_keypool_stats(&stats);
+        if (stats.available == stats.capacity) {
+            return 1;
+        }
+    } while (time(NULL) < deadline);
+    return 0;
+}
+
+void test_keypool_take(void) {
+    unsigned char privkeys[3 * KEYPOOL_CAPACITY * PRIVKEY_SIZE];
+    unsigned char pubkeys[3 * KEYPOOL_CAPACITY * PUBKEY_COMPRESSION_SIZE];
+    secp256k1_wrapper_keypool_stats stats;
+
+    TEST_ASSERT_EQUAL_INT(-6, secp256k1_wrapper_keypool_take(privkeys, pubkeys));
+    TEST_ASSERT_EQUAL_INT(-1, secp256k1_wrapper_keypool_init(0, 0, 1));
+    TEST_ASSERT_EQUAL_INT(-1, secp256k1_wrapper_keypool_init(KEYPOOL_CAPACITY, KEYPOOL_CAPACITY, 1));
+    TEST_ASSERT_EQUAL_INT(-1, secp256k1_wrapper_keypool_init(KEYPOOL_CAPACITY, 4, 2));
+
+    TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_keypool_init(KEYPOOL_CAPACITY, 4, 1));
+    TEST_ASSERT_EQUAL_INT(-1, secp256k1_wrapper_keypool_init(KEYPOOL_CAPACITY, 4, 1));
+    TEST_ASSERT_EQUAL_INT(-1, secp256k1_wrapper_keypool_take(NULL, pubkeys));
+
+    // Filled before init returns
+    secp256k1_wrapper_get_keypool_stats(&stats);
+    TEST_ASSERT_EQUAL_size_t(KEYPOOL_CAPACITY, stats.capacity);
+    TEST_ASSERT_EQUAL_size_t(KEYPOOL_CAPACITY, stats.available);
+    TEST_ASSERT_EQUAL_UINT64(1, stats.refills);
+
+    // Drain past the low-water mark several times; every pair is valid and unique
+    for (int i = 0; i < 3 * KEYPOOL_CAPACITY; i++) {
+        TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_keypool_take(privkeys + i * PRIVKEY_SIZE,
+                                                                 pubkeys + i * PUBKEY_COMPRESSION_SIZE));
+    }
+    check_generated_batch(privkeys, pubkeys, 3 * KEYPOOL_CAPACITY, 1);
+
+    secp256k1_wrapper_get_keypool_stats(&stats);
+    TEST_ASSERT_EQUAL_UINT64(3 * KEYPOOL_CAPACITY, stats.hits + stats.misses);
+
+    TEST_ASSERT_TRUE(wait_for_keypool_full());
+    secp256k1_wrapper_get_keypool_stats(&stats);
+    TEST_ASSERT_TRUE(stats.refills >= 2);
+    TEST_ASSERT_EQUAL_UINT64(0, stats.refill_failures);
+
+    secp256k1_wrapper_keypool_shutdown();
+    secp256k1_wrapper_get_keypool_stats(&stats);
+    TEST_ASSERT_EQUAL_size_t(0, stats.capacity);
+    TEST_ASSERT_EQUAL_INT(-6, secp256k1_wrapper_keypool_take(privkeys, pubkeys));
+    secure_memzero(privkeys, sizeof(privkeys));
+}
+
+#if !defined(_WIN32)
+static void* keypool_take_worker(void* arg) {
+    unsigned char* privkeys = (unsigned char*)arg;
+    unsigned char pubkey[PUBKEY_UNCOMPRESSION_SIZE];
+
+    for (int i = 0; i < 4 * KEYPOOL_CAPACITY; i++) {
+        if (secp256k1_wrapper_keypool_take(privkeys + i * PRIVKEY_SIZE, pubkey) != 0) {
+            memset(privkeys + i * PRIVKEY_SIZE, 0, PRIVKEY_SIZE);  // fails the uniqueness check
+        }
+    }
+    return NULL;
+}
+#endif
+
+/* Concurrent takers never receive the same key */
+void test_keypool_multithreaded(void) {
+#if defined(_WIN32)
+    TEST_IGNORE_MESSAGE("pthread-based test");
+#else
+    enum { NUM_THREADS = 4, PER_THREAD = 4 * KEYPOOL_CAPACITY };
+    static unsigned char privkeys[NUM_THREADS * PER_THREAD * PRIVKEY_SIZE];
+    pthread_t threads[NUM_THREADS];
+
+    TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_keypool_init(KEYPOOL_CAPACITY, KEYPOOL_CAPACITY / 2, 0));
+    for (int i = 0; i < NUM_THREADS; i++) {
+        TEST_ASSERT_EQUAL_INT(0, pthread_create(&threads[i], NULL, keypool_take_worker,
+                                                privkeys + (size_t)i * PER_THREAD * PRIVKEY_SIZE));
+    }
+    for (int i = 0; i < NUM_THREADS; i++) {
+        TEST_ASSERT_EQUAL_INT(0, pthread_join(threads[i], NULL));
+    }
+    secp256k1_wrapper_keypool_shutdown();
+
+    for (size_t i = 0; i < NUM_THREADS * PER_THREAD; i++) {
+        TEST_ASSERT_EQUAL_INT(1, is_valid_privkey(privkeys + i * PRIVKEY_SIZE));
+        for (size_t j = 0; j < i; j++) {
+            TEST_ASSERT_FALSE(memcmp(privkeys + i * PRIVKEY_SIZE, privkeys + j * PRIVKEY_SIZE, PRIVKEY_SIZE) == 0);
+        }
+    }
+    secure_memzero(privkeys, sizeof(privkeys));
+#endif
+}
+
+#if !defined(_WIN32)
+/* The inherited ring is wiped, takes generate inline */
+static int child_takes_from_keypool(void) {
+    unsigned char privkey[PRIVKEY_SIZE], pubkey[PUBKEY_COMPRESSION_SIZE], derived[PUBKEY_COMPRESSION_SIZE];
+    secp256k1_wrapper_keypool_stats stats;
+
+    secp256k1_wrapper_get_keypool_stats(&stats);
+    if (stats.available != 0) return 1;
+    if (secp256k1_wrapper_keypool_take(privkey, pubkey) != 0) return 2;
+    if (secp256k1_wrapper_derive_pubkey(privkey, derived, 1) != 0 || memcmp(derived, pubkey, sizeof(pubkey)) != 0) return 3;
+    secp256k1_wrapper_get_keypool_stats(&stats);
+    if (stats.misses != 1 || stats.hits != 0) return 4;
+    secp256k1_wrapper_keypool_shutdown();
+    return 0;
+}
+#endif
+
+void test_keypool_after_fork(void) {
+#if defined(_WIN32)
+    TEST_IGNORE_MESSAGE("fork() is not available");
+#else
+    secp256k1_wrapper_keypool_stats stats;
+    unsigned char privkey[PRIVKEY_SIZE], pubkey[PUBKEY_COMPRESSION_SIZE];
+
+    TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_keypool_init(KEYPOOL_CAPACITY, 4, 1));
+    TEST_ASSERT_EQUAL_INT(0, run_in_child(child_takes_from_keypool));
+
+    // The parent's ring is untouched
+    secp256k1_wrapper_get_keypool_stats(&stats);
+    TEST_ASSERT_EQUAL_size_t(KEYPOOL_CAPACITY, stats.available);
+    TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_keypool_take(privkey, pubkey));
+    secp256k1_wrapper_get_keypool_stats(&stats);
+    TEST_ASSERT_EQUAL_UINT64(1, stats.hits);
+
+    secp256k1_wrapper_keypool_shutdown();
+    secure_memzero(privkey, sizeof(privkey));
+#endif
+}
+
+/* ========== Streaming Generator Tests ========== */
+
+/* Pieces below, at and above the generator's 256-key entropy buffer */
+static const size_t keygen_pieces[] = { 1, 7, 0, 300, 31, 255, 256, 2 };
+#define KEYGEN_TOTAL (1 + 7 + 0 + 300 + 31 + 255 + 256 + 2)
+
+void test_keygen_pieces(void) {
+    static unsigned char privkeys[KEYGEN_TOTAL * PRIVKEY_SIZE];
+    static unsigned char pubkeys[KEYGEN_TOTAL * PUBKEY_UNCOMPRESSION_SIZE];
+
+    for (int compressed = 0; compressed <= 1; compressed++) {
+        size_t pubkey_size = compressed ? PUBKEY_COMPRESSION_SIZE : PUBKEY_UNCOMPRESSION_SIZE;
+        secp256k1_wrapper_keygen* gen = secp256k1_wrapper_keygen_open(compressed);
+        TEST_ASSERT_NOT_NULL(gen);
+
+        size_t done = 0;
+        for (size_t i = 0; i < sizeof(keygen_pieces) / sizeof(keygen_pieces[0]); i++) {
+            TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_keygen_next(gen, privkeys + done * PRIVKEY_SIZE,
+                                                                    pubkeys + done * pubkey_size, keygen_pieces[i]));
+            done += keygen_pieces[i];
+        }
+        TEST_ASSERT_EQUAL_size_t(KEYGEN_TOTAL, done);
+        check_generated_batch(privkeys, pubkeys, KEYGEN_TOTAL, compressed);  // unique across pieces too
+
+        secp256k1_wrapper_keygen_close(gen);
+    }
+    secure_memzero(privkeys, sizeof(privkeys));
+}
+
+void test_keygen_invalid_input(void) {
+    unsigned char privkey[PRIVKEY_SIZE], pubkey[PUBKEY_COMPRESSION_SIZE];
+
+    TEST_ASSERT_NULL(secp256k1_wrapper_keygen_open(2));
+    TEST_ASSERT_NULL(secp256k1_wrapper_keygen_open(-1));
+
+    secp256k1_wrapper_keygen* gen = secp256k1_wrapper_keygen_open(1);
+    TEST_ASSERT_NOT_NULL(gen);
+    TEST_ASSERT_EQUAL_INT(-1, secp256k1_wrapper_keygen_next(NULL, privkey, pubkey, 1));
+    TEST_ASSERT_EQUAL_INT(-1, secp256k1_wrapper_keygen_next(gen, NULL, pubkey, 1));
+    TEST_ASSERT_EQUAL_INT(-1, secp256k1_wrapper_keygen_next(gen, privkey, NULL, 1));
+    TEST_ASSERT_EQUAL_INT(-1, secp256k1_wrapper_keygen_next(gen, privkey, pubkey, SIZE_MAX));
+    secp256k1_wrapper_keygen_close(gen);
+    secp256k1_wrapper_keygen_close(NULL);
+}
+
+#if !defined(_WIN32)
+static secp256k1_wrapper_keygen* g_fork_keygen;
+static int g_fork_pipe[2];
+
+/* Sends the child's next keys to the parent for comparison */
+static int child_runs_keygen(void) {
+    unsigned char privkeys[4 * PRIVKEY_SIZE], pubkeys[4 * PUBKEY_COMPRESSION_SIZE];
+    if (secp256k1_wrapper_keygen_next(g_fork_keygen, privkeys, pubkeys, 4) != 0) return 1;
+    return write(g_fork_pipe[1], privkeys, sizeof(privkeys)) == (ssize_t)sizeof(privkeys) ? 0 : 2;
+}
+#endif
+
+/* Buffered entropy is not reused by a fork()ed child */
+void test_keygen_after_fork(void) {
+#if defined(_WIN32)
+    TEST_IGNORE_MESSAGE("fork() is not available");
+#else
+    unsigned char privkeys[4 * PRIVKEY_SIZE], pubkeys[4 * PUBKEY_COMPRESSION_SIZE];
+    unsigned char child_privkeys[4 * PRIVKEY_SIZE];
+
+    g_fork_keygen = secp256k1_wrapper_keygen_open(1);
+    TEST_ASSERT_NOT_NULL(g_fork_keygen);
+    TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_keygen_next(g_fork_keygen, privkeys, pubkeys, 1));  // fills the buffer
+    TEST_ASSERT_EQUAL_INT(0, pipe(g_fork_pipe));
+
+    TEST_ASSERT_EQUAL_INT(0, run_in_child(child_runs_keygen));
+    TEST_ASSERT_EQUAL_INT((int)sizeof(child_privkeys), (int)read(g_fork_pipe[0], child_privkeys, sizeof(child_privkeys)));
+
+    TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_keygen_next(g_fork_keygen, privkeys, pubkeys, 4));
+    for (int i = 0; i < 4; i++) {
+        for (int j = 0; j < 4; j++) {
+            TEST_ASSERT_FALSE(memcmp(privkeys + i * PRIVKEY_SIZE, child_privkeys + j * PRIVKEY_SIZE, PRIVKEY_SIZE) == 0);
+        }
+    }
+
+    close(g_fork_pipe[0]);
+    close(g_fork_pipe[1]);
+    secp256k1_wrapper_keygen_close(g_fork_keygen);
+    secure_memzero(privkeys, sizeof(privkeys));
+    secure_memzero(child_privkeys, sizeof(child_privkeys));
+#endif
+}
+
+/* ========== Resumable Job Tests ========== */
+
+#define JOB_BATCH_SIZE 100
+
+void test_job_generate_steps(void) {
+    static unsigned char privkeys[JOB_BATCH_SIZE * PRIVKEY_SIZE];
+    static unsigned char pubkeys[JOB_BATCH_SIZE * PUBKEY_UNCOMPRESSION_SIZE];
+    int results[JOB_BATCH_SIZE];
+    size_t done = 0;
+
+    secp256k1_wrapper_job* job = secp256k1_wrapper_job_generate_keys(privkeys, pubkeys, JOB_BATCH_SIZE, 0,
+                                                                     SECP256K1_WRAPPER_BATCH_PER_ITEM, results);
+    TEST_ASSERT_NOT_NULL(job);
+
+    // 7 items per step, not a multiple of the internal slice size
+    int steps = 0;
+    while (!secp256k1_wrapper_job_step(job, 7, 0)) {
+        steps++;
+        TEST_ASSERT_EQUAL_INT(1, secp256k1_wrapper_job_result(job, &done));
+        TEST_ASSERT_EQUAL_size_t((size_t)steps * 7, done);
+    }
+    TEST_ASSERT_EQUAL_INT((JOB_BATCH_SIZE + 6) / 7 - 1, steps);
+    TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_job_result(job, &done));
+    TEST_ASSERT_EQUAL_size_t(JOB_BATCH_SIZE, done);
+    TEST_ASSERT_EQUAL_INT(1, secp256k1_wrapper_job_step(job, 7, 0));  // done stays done
+    secp256k1_wrapper_job_free(job);
+
+    check_generated_batch(privkeys, pubkeys, JOB_BATCH_SIZE, 0);
+    for (int i = 0; i < JOB_BATCH_SIZE; i++) {
+        TEST_ASSERT_EQUAL_INT(0, results[i]);
+    }
+    secure_memzero(privkeys, sizeof(privkeys));
+}
+
+/* Time-budgeted steps give the same output and codes as the batch call */
+void test_job_derive_time_budget(void) {
+    static unsigned char privkeys[JOB_BATCH_SIZE * PRIVKEY_SIZE];
+    static unsigned char pubkeys[JOB_BATCH_SIZE * PUBKEY_COMPRESSION_SIZE];
+    static unsigned char expected[JOB_BATCH_SIZE * PUBKEY_COMPRESSION_SIZE];
+    int results[JOB_BATCH_SIZE], expected_results[JOB_BATCH_SIZE];
+
+    TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_generate_keys_batch(privkeys, pubkeys, JOB_BATCH_SIZE, 1,
+                                                                   SECP256K1_WRAPPER_BATCH_ALL_OR_NOTHING, NULL));
+    memset(privkeys + 42 * PRIVKEY_SIZE, 0xFF, PRIVKEY_SIZE);
+    TEST_ASSERT_EQUAL_INT(-5, secp256k1_wrapper_derive_pubkey_batch(privkeys, expected, JOB_BATCH_SIZE, 1,
+                                                                    expected_results));
+
+    secp256k1_wrapper_job* job = secp256k1_wrapper_job_derive_pubkeys(privkeys, pubkeys, JOB_BATCH_SIZE, 1, results);
+    TEST_ASSERT_NOT_NULL(job);
+    size_t done = 0, last = 0;
+    while (!secp256k1_wrapper_job_step(job, 0, 1)) {  // 1 us: one slice per step
+        secp256k1_wrapper_job_result(job, &done);
+        TEST_ASSERT_TRUE(done > last);
+        last = done;
+    }
+    TEST_ASSERT_EQUAL_INT(-5, secp256k1_wrapper_job_result(job, NULL));
+    secp256k1_wrapper_job_free(job);
+
+    TEST_ASSERT_EQUAL_MEMORY(expected, pubkeys, sizeof(pubkeys));
+    TEST_ASSERT_EQUAL_INT_ARRAY(expected_results, results, JOB_BATCH_SIZE);
+
+    // No budget at all: one step finishes the job
+    job = secp256k1_wrapper_job_derive_pubkeys(privkeys, pubkeys, JOB_BATCH_SIZE, 1, results);
+    TEST_ASSERT_NOT_NULL(job);
+    TEST_ASSERT_EQUAL_INT(1, secp256k1_wrapper_job_step(job, 0, 0));
+    secp256k1_wrapper_job_free(job);
+    secure_memzero(privkeys, sizeof(privkeys));
+}
+
+void test_job_invalid_input(void) {
+    unsigned char privkey[PRIVKEY_SIZE], pubkey[PUBKEY_COMPRESSION_SIZE];
+    int result;
+
+    TEST_ASSERT_NULL(secp256k1_wrapper_job_generate_keys(NULL, pubkey, 1, 1, SECP256K1_WRAPPER_BATCH_ALL_OR_NOTHING, NULL));
+    TEST_ASSERT_NULL(secp256k1_wrapper_job_generate_keys(privkey, pubkey, 1, 1, SECP256K1_WRAPPER_BATCH_PER_ITEM, NULL));
+    TEST_ASSERT_NULL(secp256k1_wrapper_job_generate_keys(privkey, pubkey, 1, 2, SECP256K1_WRAPPER_BATCH_ALL_OR_NOTHING, NULL));
+    TEST_ASSERT_NULL(secp256k1_wrapper_job_derive_pubkeys(privkey, pubkey, 1, 1, NULL));
+    TEST_ASSERT_NULL(secp256k1_wrapper_job_derive_pubkeys(privkey, pubkey, SIZE_MAX, 1, &result));
+    TEST_ASSERT_EQUAL_INT(-1, secp256k1_wrapper_job_step(NULL, 1, 0));
+    TEST_ASSERT_EQUAL_INT(-1, secp256k1_wrapper_job_result(NULL, NULL));
+    secp256k1_wrapper_job_free(NULL);
+
+    // An empty job is done from the start
+    secp256k1_wrapper_job* job = secp256k1_wrapper_job_derive_pubkeys(privkey, pubkey, 0, 1, &result);
+    TEST_ASSERT_NOT_NULL(job);
+    TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_job_result(job, NULL));
+    TEST_ASSERT_EQUAL_INT(1, secp256k1_wrapper_job_step(job, 1, 0));
+    secp256k1_wrapper_job_free(job);
+}
+
+/* ========== Async Tests ========== */
+
+#define ASYNC_REQUESTS 100
+
+static void init_async_req(secp256k1_wrapper_async_req* req, int op, unsigned char* privkeys,
+                           unsigned char* pubkeys, size_t n) {
+    memset(req, 0, sizeof(*req));
+    req->op = op;
+    req->compressed = 1;
+    req->n = n;
+    req->privkeys = privkeys;
+    req->pubkeys_out = pubkeys;
+}
+
+void test_async_invalid_input(void) {
+    unsigned char privkey[PRIVKEY_SIZE], pubkey[PUBKEY_COMPRESSION_SIZE];
+    secp256k1_wrapper_async_req req;
+    secp256k1_wrapper_async_req* done[1];
+
+    init_async_req(&req, SECP256K1_WRAPPER_ASYNC_GENERATE, privkey, pubkey, 1);
+    TEST_ASSERT_EQUAL_INT(-6, secp256k1_wrapper_async_submit(&req));
+    TEST_ASSERT_EQUAL_INT(-1, secp256k1_wrapper_async_fd());
+    TEST_ASSERT_EQUAL_size_t(0, secp256k1_wrapper_async_reap(done, 1));
+
+    TEST_ASSERT_EQUAL_INT(-1, secp256k1_wrapper_async_init(0, 16));
+    TEST_ASSERT_EQUAL_INT(-1, secp256k1_wrapper_async_init(2, 0));
+    TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_async_init(2, 16));
+    TEST_ASSERT_EQUAL_INT(-1, secp256k1_wrapper_async_init(2, 16));
+#if !defined(_WIN32)
+    TEST_ASSERT_TRUE(secp256k1_wrapper_async_fd() >= 0);
+#endif
+
+    TEST_ASSERT_EQUAL_INT(-1, secp256k1_wrapper_async_submit(NULL));
+    req.op = 7;
+    TEST_ASSERT_EQUAL_INT(-1, secp256k1_wrapper_async_submit(&req));
+    init_async_req(&req, SECP256K1_WRAPPER_ASYNC_GENERATE, privkey, pubkey, 0);
+    TEST_ASSERT_EQUAL_INT(-1, secp256k1_wrapper_async_submit(&req));
+    init_async_req(&req, SECP256K1_WRAPPER_ASYNC_DERIVE, NULL, pubkey, 1);
+    TEST_ASSERT_EQUAL_INT(-1, secp256k1_wrapper_async_submit(&req));
+    init_async_req(&req, SECP256K1_WRAPPER_ASYNC_DERIVE, privkey, pubkey, 1);
+    req.compressed = 2;
+    TEST_ASSERT_EQUAL_INT(-1, secp256k1_wrapper_async_submit(&req));
+
+    unsigned char hash[32] = {0}, sig[SECP256K1_WRAPPER_SIG_DER_MAX_SIZE], bitmap[1];
+    secp256k1_wrapper_verify_item item = { pubkey, sizeof(pubkey), hash, sig, SECP256K1_WRAPPER_SIG_COMPACT_SIZE };
+    init_async_req(&req, SECP256K1_WRAPPER_ASYNC_SIGN, privkey, NULL, 1);
+    req.args.sign.hashes = hash;
+    TEST_ASSERT_EQUAL_INT(-1, secp256k1_wrapper_async_submit(&req));   // no sigs_out
+    req.args.sign.sigs_out = sig;
+    req.args.sign.format = SECP256K1_WRAPPER_SIG_DER;
+    TEST_ASSERT_EQUAL_INT(-1, secp256k1_wrapper_async_submit(&req));   // DER without sig_lens
+    req.args.sign.format = 5;
+    TEST_ASSERT_EQUAL_INT(-1, secp256k1_wrapper_async_submit(&req));
+    init_async_req(&req, SECP256K1_WRAPPER_ASYNC_VERIFY, NULL, NULL, 1);
+    TEST_ASSERT_EQUAL_INT(-1, secp256k1_wrapper_async_submit(&req));   // no items
+    req.args.verify.items = &item;
+    TEST_ASSERT_EQUAL_INT(-1, secp256k1_wrapper_async_submit(&req));   // VERIFY_ALL without bitmap
+    req.args.verify.valid_bitmap = bitmap;
+    req.args.verify.mode = 9;
+    TEST_ASSERT_EQUAL_INT(-1, secp256k1_wrapper_async_submit(&req));
+
+    secp256k1_wrapper_async_shutdown();
+    TEST_ASSERT_EQUAL_INT(-1, secp256k1_wrapper_async_fd());
+}
+
+static volatile int g_async_completed;
+
+static void count_async_completion(secp256k1_wrapper_async_req* req) {
+    if (req->result == 0) {
+        __atomic_fetch_add(&g_async_completed, 1, __ATOMIC_RELEASE);
+    }
+}
+
+/* Single-key requests are coalesced, every caller still gets its own key */
+void test_async_callbacks(void) {
+#if defined(_WIN32)
+    TEST_IGNORE_MESSAGE("test uses GCC atomics");
+#else
+    static unsigned char privkeys[ASYNC_REQUESTS * PRIVKEY_SIZE];
+    static unsigned char pubkeys[ASYNC_REQUESTS * PUBKEY_COMPRESSION_SIZE];
+    static secp256k1_wrapper_async_req reqs[ASYNC_REQUESTS];
+
+    g_async_completed = 0;
+    TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_async_init(2, ASYNC_REQUESTS));
+    for (int i = 0; i < ASYNC_REQUESTS; i++) {
+        init_async_req(&reqs[i], SECP256K1_WRAPPER_ASYNC_GENERATE, privkeys + i * PRIVKEY_SIZE,
+                       pubkeys + i * PUBKEY_COMPRESSION_SIZE, 1);
+        reqs[i].callback = count_async_completion;
+        TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_async_submit(&reqs[i]));
+    }
+
+    time_t deadline = time(NULL) + 10;
+    while (__atomic_load_n(&g_async_completed, __ATOMIC_ACQUIRE) < ASYNC_REQUESTS && time(NULL) < deadline) {
+    }
+    TEST_ASSERT_EQUAL_INT(ASYNC_REQUESTS, __atomic_load_n(&g_async_completed, __ATOMIC_ACQUIRE));
+    secp256k1_wrapper_async_shutdown();
+
+    check_generated_batch(privkeys, pubkeys, ASYNC_REQUESTS, 1);
+    secure_memzero(privkeys, sizeof(privkeys));
+#endif
+}
+
+/* Event-loop style: wait on the fd, then reap */
+void test_async_reap_fd(void) {
+#if defined(_WIN32)
+    TEST_IGNORE_MESSAGE("poll() is not available");
+#else
+    enum { NUM_REQS = 8, KEYS_PER_REQ = 20 };
+    static unsigned char privkeys[NUM_REQS * KEYS_PER_REQ * PRIVKEY_SIZE];
+    static unsigned char pubkeys[NUM_REQS * KEYS_PER_REQ * PUBKEY_COMPRESSION_SIZE];
+    static unsigned char expected[NUM_REQS * KEYS_PER_REQ * PUBKEY_COMPRESSION_SIZE];
+    int results[NUM_REQS * KEYS_PER_REQ], expected_results[NUM_REQS * KEYS_PER_REQ];
+    secp256k1_wrapper_async_req reqs[NUM_REQS + 1];
+    secp256k1_wrapper_async_req* done[3];
+
+    TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_generate_keys_batch(privkeys, expected, NUM_REQS * KEYS_PER_REQ, 1,
+                                                                   SECP256K1_WRAPPER_BATCH_ALL_OR_NOTHING, NULL));
+    memset(privkeys + 45 * PRIVKEY_SIZE, 0, PRIVKEY_SIZE);  // request 2, item 5
+    TEST_ASSERT_EQUAL_INT(-5, secp256k1_wrapper_derive_pubkey_batch(privkeys, expected, NUM_REQS * KEYS_PER_REQ, 1,
+                                                                    expected_results));
+
+    TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_async_init(1, NUM_REQS));
+    struct pollfd pfd = { secp256k1_wrapper_async_fd(), POLLIN, 0 };
+    TEST_ASSERT_TRUE(pfd.fd >= 0);
+
+    for (int i = 0; i < NUM_REQS; i++) {
+        init_async_req(&reqs[i], SECP256K1_WRAPPER_ASYNC_DERIVE, privkeys + i * KEYS_PER_REQ * PRIVKEY_SIZE,
+                       pubkeys + i * KEYS_PER_REQ * PUBKEY_COMPRESSION_SIZE, KEYS_PER_REQ);
+        reqs[i].results = (i % 2 == 0) ? results + i * KEYS_PER_REQ : NULL;
+        reqs[i].user_data = &reqs[i];
+        TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_async_submit(&reqs[i]));
+    }
+    // Unreaped requests still count against the limit
+    init_async_req(&reqs[NUM_REQS], SECP256K1_WRAPPER_ASYNC_DERIVE, privkeys, pubkeys, 1);
+    TEST_ASSERT_EQUAL_INT(-7, secp256k1_wrapper_async_submit(&reqs[NUM_REQS]));
+
+    int seen[NUM_REQS] = {0};
+    size_t reaped = 0;
+    while (reaped < NUM_REQS) {
+        TEST_ASSERT_EQUAL_INT(1, poll(&pfd, 1, 10000));
+        size_t count = secp256k1_wrapper_async_reap(done, 3);  // smaller than the backlog on purpose
+        for (size_t i = 0; i < count; i++) {
+            int index = (int)(done[i] - reqs);
+            TEST_ASSERT_TRUE(index >= 0 && index < NUM_REQS);
+            TEST_ASSERT_EQUAL_PTR(done[i], done[i]->user_data);
+            TEST_ASSERT_EQUAL_INT(index == 2 ? -5 : 0, done[i]->result);
+            seen[index]++;
+        }
+        reaped += count;
+    }
+    for (int i = 0; i < NUM_REQS; i++) {
+        TEST_ASSERT_EQUAL_INT(1, seen[i]);
+    }
+    TEST_ASSERT_EQUAL_MEMORY(expected, pubkeys, sizeof(pubkeys));
+    for (int i = 0; i < NUM_REQS; i += 2) {
+        TEST_ASSERT_EQUAL_INT_ARRAY(expected_results + i * KEYS_PER_REQ, results + i * KEYS_PER_REQ, KEYS_PER_REQ);
+    }
+
+    // Capacity is back once reaped; the fd may still carry a stale wakeup
+    TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_async_submit(&reqs[NUM_REQS]));
+    size_t count = 0;
+    while (count == 0) {
+        TEST_ASSERT_EQUAL_INT(1, poll(&pfd, 1, 10000));
+        count = secp256k1_wrapper_async_reap(done, 3);
+    }
+    TEST_ASSERT_EQUAL_size_t(1, count);
+    TEST_ASSERT_EQUAL_INT(0, done[0]->result);
+
+    secp256k1_wrapper_async_shutdown();
+    secure_memzero(privkeys, sizeof(privkeys));
+#endif
+}
+
+/* Reaps exactly `expected` requests, waiting at most ten seconds */
+static void reap_async_reqs(secp256k1_wrapper_async_req** done, size_t expected) {
+    size_t reaped = 0;
+    time_t deadline = time(NULL) + 10;
+    while (reaped < expected && time(NULL) < deadline) {
+        reaped += secp256k1_wrapper_async_reap(done + reaped, expected - reaped);
+    }
+    TEST_ASSERT_EQUAL_size_t(expected, reaped);
+}
+
+/* Signatures made by SIGN requests check out in VERIFY requests */
+void test_async_sign_verify(void) {
+    enum { N = 40 };
+    static unsigned char privkeys[N * PRIVKEY_SIZE], pubkeys[N * PUBKEY_COMPRESSION_SIZE], hashes[N * 32];
+    static unsigned char compact[N * SECP256K1_WRAPPER_SIG_COMPACT_SIZE], der[N * SECP256K1_WRAPPER_SIG_DER_MAX_SIZE];
+    size_t der_lens[N];
+    int results[N];
+    secp256k1_wrapper_verify_item compact_items[N], der_items[N];
+    unsigned char bitmap[(N + 7) / 8];
+    secp256k1_wrapper_async_req reqs[4];
+    secp256k1_wrapper_async_req* done[4];
+
+    TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_generate_keys_batch(privkeys, pubkeys, N, 1,
+                                                                   SECP256K1_WRAPPER_BATCH_ALL_OR_NOTHING, NULL));
+    for (int i = 0; i < N * 32; i++) {
+        hashes[i] = (unsigned char)(i * 7 + 1);
+    }
+    memset(privkeys + 3 * PRIVKEY_SIZE, 0, PRIVKEY_SIZE);  // item 3 cannot be signed
+    TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_async_init(2, 4));
+
+    init_async_req(&reqs[0], SECP256K1_WRAPPER_ASYNC_SIGN, privkeys, NULL, N);
+    reqs[0].args.sign.hashes = hashes;
+    reqs[0].args.sign.sigs_out = compact;
+    reqs[0].args.sign.format = SECP256K1_WRAPPER_SIG_COMPACT;
+    reqs[0].results = results;
+    init_async_req(&reqs[1], SECP256K1_WRAPPER_ASYNC_SIGN, privkeys, NULL, N);
+    reqs[1].args.sign.hashes = hashes;
+    reqs[1].args.sign.sigs_out = der;
+    reqs[1].args.sign.sig_lens = der_lens;
+    reqs[1].args.sign.format = SECP256K1_WRAPPER_SIG_DER;
+    TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_async_submit(&reqs[0]));
+    TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_async_submit(&reqs[1]));
+    reap_async_reqs(done, 2);
+    TEST_ASSERT_EQUAL_INT(-5, reqs[0].result);
+    TEST_ASSERT_EQUAL_INT(-5, reqs[1].result);
+    for (int i = 0; i < N; i++) {
+        TEST_ASSERT_EQUAL_INT(i == 3 ? -5 : 0, results[i]);
+        TEST_ASSERT_EQUAL_size_t(i == 3 ? 0 : 1, der_lens[i] != 0);
+    }
+
+    for (int i = 0; i < N; i++) {
+        secp256k1_wrapper_verify_item item = { pubkeys + i * PUBKEY_COMPRESSION_SIZE, PUBKEY_COMPRESSION_SIZE,
+                                               hashes + i * 32, NULL, 0 };
+        compact_items[i] = item;
+        compact_items[i].sig = compact + i * SECP256K1_WRAPPER_SIG_COMPACT_SIZE;
+        compact_items[i].sig_len = SECP256K1_WRAPPER_SIG_COMPACT_SIZE;
+        der_items[i] = item;
+        der_items[i].sig = der + i * SECP256K1_WRAPPER_SIG_DER_MAX_SIZE;
+        der_items[i].sig_len = der_lens[i];
+    }
+
+    // Every valid item is reported, the unsigned one is not
+    init_async_req(&reqs[2], SECP256K1_WRAPPER_ASYNC_VERIFY, NULL, NULL, N);
+    reqs[2].args.verify.items = compact_items;
+    reqs[2].args.verify.format = SECP256K1_WRAPPER_SIG_COMPACT;
+    reqs[2].args.verify.mode = SECP256K1_WRAPPER_VERIFY_ALL;
+    reqs[2].args.verify.valid_bitmap = bitmap;
+    // Without the unsigned item, every DER signature is valid
+    init_async_req(&reqs[3], SECP256K1_WRAPPER_ASYNC_VERIFY, NULL, NULL, N - 4);
+    reqs[3].args.verify.items = der_items + 4;
+    reqs[3].args.verify.format = SECP256K1_WRAPPER_SIG_DER;
+    reqs[3].args.verify.mode = SECP256K1_WRAPPER_VERIFY_EARLY_EXIT;
+    TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_async_submit(&reqs[2]));
+    TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_async_submit(&reqs[3]));
+    reap_async_reqs(done, 2);
+    TEST_ASSERT_EQUAL_INT(-4, reqs[2].result);
+    TEST_ASSERT_EQUAL_INT(0, reqs[3].result);
+    for (int i = 0; i < N; i++) {
+        TEST_ASSERT_EQUAL_INT(i != 3, (bitmap[i / 8] >> (i % 8)) & 1);
+    }
+
+    secp256k1_wrapper_async_shutdown();
+    secure_memzero(privkeys, sizeof(privkeys));
+}
+
+/* Single-hash sign requests popped together share one nonce entropy draw,
+ * yet each signature gets its own nonce */
+void test_async_small_signs(void) {
+    enum { N = 40 };
+    static unsigned char sigs[N * SECP256K1_WRAPPER_SIG_COMPACT_SIZE];
+    unsigned char privkey[PRIVKEY_SIZE], pubkey[PUBKEY_COMPRESSION_SIZE], hash[32];
+    int results[N];
+    secp256k1_wrapper_async_req reqs[N];
+    secp256k1_wrapper_async_req* done[N];
+
+    TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_generate_keys(privkey, pubkey, 1));
+    TEST_ASSERT_EQUAL_INT(1, secp256k1_wrapper_fill_random(hash, sizeof(hash)));
+    TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_async_init(1, N));
+    for (int i = 0; i < N; i++) {
+        init_async_req(&reqs[i], SECP256K1_WRAPPER_ASYNC_SIGN, privkey, NULL, 1);
+        reqs[i].args.sign.hashes = hash;
+        reqs[i].args.sign.sigs_out = sigs + i * SECP256K1_WRAPPER_SIG_COMPACT_SIZE;
+        reqs[i].args.sign.format = SECP256K1_WRAPPER_SIG_COMPACT;
+        reqs[i].results = (i % 2 == 0) ? results + i : NULL;
+        TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_async_submit(&reqs[i]));
+    }
+    reap_async_reqs(done, N);
+    secp256k1_wrapper_async_shutdown();
+
+    for (int i = 0; i < N; i++) {
+        const unsigned char* sig = sigs + i * SECP256K1_WRAPPER_SIG_COMPACT_SIZE;
+        TEST_ASSERT_EQUAL_INT(0, reqs[i].result);
+        if (i % 2 == 0) {
+            TEST_ASSERT_EQUAL_INT(0, results[i]);
+        }
+        TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_verify(pubkey, sizeof(pubkey), hash, sig,
+                                                          SECP256K1_WRAPPER_SIG_COMPACT_SIZE,
+                                                          SECP256K1_WRAPPER_SIG_COMPACT));
+        for (int j = 0; j < i; j++) {
+            TEST_ASSERT_TRUE(memcmp(sig, sigs + j * SECP256K1_WRAPPER_SIG_COMPACT_SIZE,
+                                    SECP256K1_WRAPPER_SIG_COMPACT_SIZE) != 0);
+        }
+    }
+    secure_memzero(privkey, sizeof(privkey));
+}
+
+#define ASYNC_STRESS_REQS   8   // a power of two, so the queue has no spare cell
+#define ASYNC_STRESS_ROUNDS 300
+
+static volatile int g_async_rounds[ASYNC_STRESS_REQS];
+static volatile int g_async_finished;
+static volatile int g_async_stress_failed;
+
+/* Counts a round of the request and submits it again until it has run
+ * ASYNC_STRESS_ROUNDS times */
+static void resubmit_async_req(secp256k1_wrapper_async_req* req) {
+    int index = (int)(intptr_t)req->user_data;
+    if (req->result != 0) {
+        __atomic_store_n(&g_async_stress_failed, 1, __ATOMIC_RELEASE);
+        return;
+    }
+    if (__atomic_add_fetch(&g_async_rounds[index], 1, __ATOMIC_ACQ_REL) == ASYNC_STRESS_ROUNDS) {
+        __atomic_fetch_add(&g_async_finished, 1, __ATOMIC_RELEASE);
+    } else if (secp256k1_wrapper_async_submit(req) != 0) {
+        __atomic_store_n(&g_async_stress_failed, 1, __ATOMIC_RELEASE);
+    }
+}
+
+static void* async_stress_reaper(void* arg) {
+    secp256k1_wrapper_async_req* done[2];
+    time_t deadline = time(NULL) + 20;
+    (void)arg;
+    while (__atomic_load_n(&g_async_finished, __ATOMIC_ACQUIRE) < ASYNC_STRESS_REQS &&
+           !__atomic_load_n(&g_async_stress_failed, __ATOMIC_ACQUIRE) && time(NULL) < deadline) {
+        size_t count = secp256k1_wrapper_async_reap(done, 2);
+        for (size_t i = 0; i < count; i++) {
+            resubmit_async_req(done[i]);
+        }
+    }
+    return NULL;
+}
+
+/* Keeps a queue with no spare cell full from several service threads, both
+ * resubmitting from callbacks and from concurrent reapers: a push that meets
+ * a cell still being popped must wait for it, not drop the request */
+void test_async_full_queue_stress(void) {
+#if defined(_WIN32)
+    TEST_IGNORE_MESSAGE("test uses GCC atomics");
+#else
+    static unsigned char privkeys[ASYNC_STRESS_REQS * PRIVKEY_SIZE];
+    static unsigned char pubkeys[ASYNC_STRESS_REQS * PUBKEY_COMPRESSION_SIZE];
+    static secp256k1_wrapper_async_req reqs[ASYNC_STRESS_REQS];
+    pthread_t reapers[2];
+
+    for (int use_callbacks = 1; use_callbacks >= 0; use_callbacks--) {
+        memset((void*)g_async_rounds, 0, sizeof(g_async_rounds));
+        g_async_finished = 0;
+        g_async_stress_failed = 0;
+        TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_async_init(4, ASYNC_STRESS_REQS));
+        if (!use_callbacks) {
+            for (int i = 0; i < 2; i++) {
+                TEST_ASSERT_EQUAL_INT(0, pthread_create(&reapers[i], NULL, async_stress_reaper, NULL));
+            }
+        }
+        for (int i = 0; i < ASYNC_STRESS_REQS; i++) {
+            init_async_req(&reqs[i], SECP256K1_WRAPPER_ASYNC_GENERATE, privkeys + i * PRIVKEY_SIZE,
+                           pubkeys + i * PUBKEY_COMPRESSION_SIZE, 1);
+            reqs[i].callback = use_callbacks ? resubmit_async_req : NULL;
+            reqs[i].user_data = (void*)(intptr_t)i;
+            TEST_ASSERT_EQUAL_INT(0, secp256k1_wrapper_async_submit(&reqs[i]));
+        }
+
+        time_t deadline = time(NULL) + 20;
+        while (__atomic_load_n(&g_async_finished, __ATOMIC_ACQUIRE) < ASYNC_STRESS_REQS &&
+               !__atomic_load_n(&g_async_stress_failed, __ATOMIC_ACQUIRE) && time(NULL) < deadline) {
+        }
+        if (!use_callbacks) {
+            for (int i = 0; i < 2; i++) {
+                pthread_join(reapers[i], NULL);
+            }
+        }
+        TEST_ASSERT_FALSE(g_async_stress_failed);
+        TEST_ASSERT_EQUAL_INT(ASYNC_STRESS_REQS, __atomic_load_n(&g_async_finished, __ATOMIC_ACQUIRE));
+        secp256k1_wrapper_async_shutdown();
+    }
+
+    check_generated_batch(privkeys, pubkeys, ASYNC_STRESS_REQS, 1);
+    secure_memzero(privkeys, sizeof(privkeys));
+#endif
+}
+
+/* ========== Version Test ========== */
+
+void test_version_format(void) {
+    const char* version = secp256k1_wrapper_get_version();
+    TEST_ASSERT_NOT_NULL(version);
+    
+    // Check format: should be X.Y.Z
+    int major, minor, patch;
+    int parsed = sscanf(version, "%d.%d.%d", &major, &minor, &patch);
+    TEST_ASSERT_EQUAL_INT(3, parsed);
+    TEST_ASSERT_TRUE(major >= 0);
+    TEST_ASSERT_TRUE(minor >= 0);
+    TEST_ASSERT_TRUE(patch >= 0);
+}
+
+/* ========== Main Test Runner ========== */
+
+int main(void) {
+    UNITY_BEGIN();
+    
+    // Basic functionality
+    RUN_TEST(test_generate_compressed_keys);
+    RUN_TEST(test_generate_uncompressed_keys);
+    
+    // derive_pubkey tests
+    RUN_TEST(test_derive_pubkey_compressed);
+    RUN_TEST(test_derive_pubkey_uncompressed);
+    RUN_TEST(test_same_privkey_different_formats);
+    
+    // Error handling
+    RUN_TEST(test_generate_keys_null_privkey);
+    RUN_TEST(test_generate_keys_null_pubkey);
+    RUN_TEST(test_generate_keys_invalid_compressed);
+    RUN_TEST(test_derive_pubkey_null_privkey);
+    RUN_TEST(test_derive_pubkey_null_pubkey);
+    RUN_TEST(test_derive_pubkey_invalid_compressed);
+    RUN_TEST(test_derive_pubkey_invalid_privkey);
+    
+    // Stress tests
+    RUN_TEST(test_stress_compressed_generation);
+    RUN_TEST(test_stress_uncompressed_generation);
+    RUN_TEST(test_key_uniqueness);
+    
+    // Known vectors
+    RUN_TEST(test_known_private_key);
+    
+    // Context handle
+    RUN_TEST(test_ctx_generate_and_derive);
+    RUN_TEST(test_ctx_rerandomize);
+    RUN_TEST(test_ctx_invalid_input);
+    
+    // Thread cache
+    RUN_TEST(test_thread_cache_generate_and_derive);
+    RUN_TEST(test_thread_cache_multithreaded);
+    
+    // Context pool
+    RUN_TEST(test_ctx_pool_hits_and_misses);
+    RUN_TEST(test_ctx_pool_multithreaded);
+    
+    // Re-randomization policy
+    RUN_TEST(test_rerandomize_policy_invalid);
+    RUN_TEST(test_rerandomize_policy_interval_limit);
+    RUN_TEST(test_rerandomize_policy_operations);
+    
+    // Fork safety
+    RUN_TEST(test_fork_child_reseeds_cached_contexts);
+    
+    // System RNG
+    RUN_TEST(test_fill_random_multithreaded);
+    RUN_TEST(test_fill_random_large_buffer);
+    
+    // Buffered RNG
+    RUN_TEST(test_rng_buffered_invalid);
+    RUN_TEST(test_rng_buffered_output);
+    RUN_TEST(test_rng_buffered_fork);
+    
+    // ChaCha20 DRBG
+    RUN_TEST(test_rng_chacha20_output);
+    RUN_TEST(test_rng_chacha20_fork);
+    
+    // Batch generation
+    RUN_TEST(test_generate_keys_batch);
+    RUN_TEST(test_generate_keys_batch_invalid_input);
+    
+    // Batch derivation
+    RUN_TEST(test_derive_pubkey_batch);
+    RUN_TEST(test_derive_pubkey_batch_bad_keys);
+    
+    // Strided and scatter-gather batches
+    RUN_TEST(test_generate_keys_strided);
+    RUN_TEST(test_scatter_batches);
+    RUN_TEST(test_strided_invalid_input);
+    
+    // Sequential key ranges
+    RUN_TEST(test_derive_pubkey_range);
+    RUN_TEST(test_derive_pubkey_range_limits);
+    
+    // Signing
+    RUN_TEST(test_sign);
+    RUN_TEST(test_sign_invalid_input);
+    RUN_TEST(test_sign_batch);
+    
+    // Verification
+    RUN_TEST(test_verify);
+    RUN_TEST(test_verify_batch);
+    RUN_TEST(test_sigcache_hits);
+    RUN_TEST(test_sigcache_full);
+    RUN_TEST(test_pubkey_handles);
+    RUN_TEST(test_pubkey_cache);
+    RUN_TEST(test_schnorr_keypair);
+    RUN_TEST(test_schnorr_sign);
+    RUN_TEST(test_schnorr_batches);
+    
+    // Parallel batches
+    RUN_TEST(test_parallel_batches_match_serial);
+    RUN_TEST(test_parallel_batches_after_fork);
+    RUN_TEST(test_parallel_stats);
+    RUN_TEST(test_parallel_concurrent_batches);
+    RUN_TEST(test_parallel_idle_workers_park);
+
+    // Key pool
+    RUN_TEST(test_keypool_take);
+    RUN_TEST(test_keypool_multithreaded);
+    RUN_TEST(test_keypool_after_fork);
+
+    // Streaming generator
+    RUN_TEST(test_keygen_pieces);
+    RUN_TEST(test_keygen_invalid_input);
+    RUN_TEST(test_keygen_after_fork);
+
+    // Resumable jobs
+    RUN_TEST(test_job_generate_steps);
+    RUN_TEST(test_job_derive_time_budget);
+    RUN_TEST(test_job_invalid_input);
+
+    // Asynchronous requests
+    RUN_TEST(test_async_invalid_input);
+    RUN_TEST(test_async_callbacks);
+    RUN_TEST(test_async_reap_fd);
+    RUN_TEST(test_async_sign_verify);
+    RUN_TEST(test_async_small_signs);
+    RUN_TEST(test_async_full_queue_stress);
     
     // Version test
     RUN_TEST(test_version_format);